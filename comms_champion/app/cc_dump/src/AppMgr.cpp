@@ -20,6 +20,7 @@
 #include <iostream>
 #include <type_traits>
 #include <string>
+#include <chrono>
 
 CC_DISABLE_WARNINGS()
 #include <QtCore/QDir>
@@ -27,6 +28,7 @@ CC_DISABLE_WARNINGS()
 CC_ENABLE_WARNINGS()
 
 #include "comms_champion/property/message.h"
+#include "comms_champion/DataInfoPool.h"
 
 namespace cc = comms_champion;
 
@@ -59,28 +61,52 @@ AppMgr::AppMgr()
                 return;
             }
 
-            dispatchMsg(*msg);
+            dispatchMsg(std::move(msg));
         });
 
-    m_msgSendMgr.setSendMsgsCallbackFunc(
-        [this](cc::MsgSendMgr::MessagesList&& msgs)
+    m_msgSendMgr.setSendFrameCallbackFunc(
+        [this](const cc::DataInfoPtr& frame, cc::MessagePtr msg)
         {
-            m_msgMgr.sendMsgs(std::move(msgs));
+            m_msgMgr.sendFrame(frame, std::move(msg));
         });
 
     m_msgSendMgr.setSendCompeteCallbackFunc(
         [this]()
         {
-            if (m_config.m_lastWait == 0U) {
-                return;
+            reportSendJitter();
+            sendComplete();
+        });
+
+    m_blastSender.setSendFrameCallbackFunc(
+        [this](const cc::DataInfoPtr& frame)
+        {
+            m_msgMgr.sendFrame(frame);
+        });
+
+    m_blastSender.setPendingBytesCallbackFunc(
+        [this]() -> std::size_t
+        {
+            auto socket = m_msgMgr.getSocket();
+            if (!socket) {
+                return 0U;
             }
 
-            QTimer::singleShot(m_config.m_lastWait, qApp, SLOT(quit()));
+            return socket->pendingBytes();
+        });
+
+    m_blastSender.setCompleteCallbackFunc(
+        [this]()
+        {
+            sendComplete();
         });
 
     connect(
         &m_flushTimer, SIGNAL(timeout()),
         this, SLOT(flushOutput()));
+
+    connect(
+        qApp, SIGNAL(aboutToQuit()),
+        this, SLOT(reportStats()));
 }
 
 AppMgr::~AppMgr() = default;
@@ -118,9 +144,20 @@ bool AppMgr::start(const Config& config)
     }
 
     if (!m_config.m_inMsgsFile.isEmpty()) {
-        m_record.reset(new RecordMessageHandler(m_config.m_inMsgsFile));
+        auto format = cc::MsgFileMgr::Format::Json;
+        if (m_config.m_recordBinary) {
+            format = cc::MsgFileMgr::Format::Binary;
+        }
+        m_record.reset(
+            new RecordMessageHandler(
+                m_config.m_inMsgsFile,
+                format,
+                m_config.m_recordFlushInterval,
+                m_config.m_recordSyncInterval));
     }
 
+    // Every message is dumped once on arrival, no need to keep it
+    m_msgMgr.setMsgsRetained(false);
     m_msgMgr.setRecvEnabled(true);
     m_msgMgr.start();
 
@@ -144,7 +181,16 @@ bool AppMgr::start(const Config& config)
                 config.m_outMsgsFile,
                 *protocol);
 
-        if (!msgsToSend.empty()) {
+        if (m_config.m_blast) {
+            m_blastSender.setRate(m_config.m_blastRate);
+            m_blastSender.setCount(m_config.m_blastCount);
+            m_blastSender.setDuration(m_config.m_blastDuration);
+            if (!m_blastSender.start(*protocol, msgsToSend)) {
+                return false;
+            }
+        }
+        else if (!msgsToSend.empty()) {
+            m_msgSendMgr.setSentMsgsRequired(m_config.m_recordOutgoing);
             m_msgSendMgr.start(protocol, msgsToSend);
         }
     }
@@ -161,10 +207,39 @@ void AppMgr::flushOutput()
     if (m_csvDump) {
         m_csvDump->flush();
     }
+}
 
-    if (m_record) {
-        m_record->flush();
+void AppMgr::reportStats()
+{
+    auto& stats = m_msgMgr.getStats();
+    std::cerr << "INFO: Received " << stats.m_recvMsgs << " messages (" <<
+        stats.m_recvBytes << " bytes), sent " << stats.m_sentMsgs << " messages (" <<
+        stats.m_sentBytes << " bytes), invalid messages: " << stats.m_invalidMsgs <<
+        ", errors: " << stats.m_errors << std::endl;
+
+    auto poolStats = cc::DataInfoPool::instanceRef().getStats();
+    std::cerr << "INFO: Data buffers allocated: " << poolStats.m_allocCount <<
+        ", reused: " << poolStats.m_hitCount << " (" <<
+        cc::DataInfoPool::hitRate(poolStats) * 100.0 << "%), outstanding: " <<
+        poolStats.m_outstandingCount << " (peak " << poolStats.m_peakOutstandingCount <<
+        "), cached: " << poolStats.m_cachedCount << std::endl;
+
+    auto socket = m_msgMgr.getSocket();
+    if (!socket) {
+        return;
+    }
+
+    auto socketStats = socket->stats();
+    if (socketStats.empty()) {
+        return;
     }
+
+    std::cerr << "INFO: Socket statistics:";
+    for (auto& elem : socketStats) {
+        std::cerr << ' ' << elem.first.toStdString() << '=' <<
+            elem.second.toString().toStdString();
+    }
+    std::cerr << std::endl;
 }
 
 bool AppMgr::applyPlugins(const ListOfPluginInfos& plugins)
@@ -219,15 +294,44 @@ bool AppMgr::applyPlugins(const ListOfPluginInfos& plugins)
     return true;
 }
 
-void AppMgr::dispatchMsg(comms_champion::Message& msg)
+void AppMgr::dispatchMsg(comms_champion::MessagePtr msg)
 {
     if (m_csvDump) {
-        msg.dispatch(*m_csvDump);
+        msg->dispatch(*m_csvDump);
     }
 
     if (m_record) {
-        msg.dispatch(*m_record);
+        m_record->record(std::move(msg));
+    }
+}
+
+void AppMgr::reportSendJitter()
+{
+    auto& jitter = m_msgSendMgr.getJitter();
+    if (jitter.count() == 0U) {
+        return;
     }
+
+    auto toUs =
+        [](cc::LatencyRecorder::Duration value) -> long long
+        {
+            return static_cast<long long>(
+                std::chrono::duration_cast<std::chrono::microseconds>(value).count());
+        };
+
+    std::cerr << "INFO: Sent " << jitter.totalCount() << " messages, jitter (us) p50=" <<
+        toUs(jitter.percentile(50.0)) << " p90=" << toUs(jitter.percentile(90.0)) <<
+        " p99=" << toUs(jitter.percentile(99.0)) << " p99.9=" << toUs(jitter.percentile(99.9)) <<
+        " max=" << toUs(jitter.max()) << std::endl;
+}
+
+void AppMgr::sendComplete()
+{
+    if (m_config.m_lastWait == 0U) {
+        return;
+    }
+
+    QTimer::singleShot(m_config.m_lastWait, qApp, SLOT(quit()));
 }
 
 } /* namespace comms_dump */
@@ -32,6 +32,7 @@ CC_ENABLE_WARNINGS()
 #include "comms_champion/MsgFileMgr.h"
 #include "comms_champion/MsgSendMgr.h"
 
+#include "BlastSender.h"
 #include "CsvDumpMessageHandler.h"
 #include "RecordMessageHandler.h"
 
@@ -50,7 +51,14 @@ public:
         QString m_inMsgsFile;
         unsigned m_lastWait = 0U;
         bool m_recordOutgoing = false;
+        bool m_recordBinary = false;
+        unsigned m_recordFlushInterval = comms_champion::MsgFileRecorder::DefaultFlushInterval;
+        unsigned m_recordSyncInterval = comms_champion::MsgFileRecorder::DefaultSyncInterval;
         bool m_quiet = false;
+        bool m_blast = false;
+        unsigned m_blastRate = 0U;
+        unsigned long long m_blastCount = 0U;
+        unsigned m_blastDuration = 0U;
     };
 
     AppMgr();
@@ -60,6 +68,7 @@ public:
 
 private slots:
     void flushOutput();
+    void reportStats();
 
 private:
     typedef comms_champion::PluginMgr::ListOfPluginInfos ListOfPluginInfos;
@@ -67,12 +76,15 @@ private:
     typedef std::unique_ptr<RecordMessageHandler> RecordMessageHandlerPtr;
 
     bool applyPlugins(const ListOfPluginInfos& plugins);
-    void dispatchMsg(comms_champion::Message& msg);
+    void dispatchMsg(comms_champion::MessagePtr msg);
+    void reportSendJitter();
+    void sendComplete();
 
     comms_champion::PluginMgr m_pluginMgr;
     comms_champion::MsgMgr m_msgMgr;
     comms_champion::MsgFileMgr m_msgFileMgr;
     comms_champion::MsgSendMgr m_msgSendMgr;
+    BlastSender m_blastSender;
     Config m_config;
     CsvDumpMessageHandlerPtr m_csvDump;
     RecordMessageHandlerPtr m_record;
@@ -0,0 +1,313 @@
+//
+// Copyright 2016 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "BlastSender.h"
+
+#include <cassert>
+#include <cmath>
+#include <algorithm>
+#include <iostream>
+
+CC_DISABLE_WARNINGS()
+#include <QtCore/QMetaObject>
+CC_ENABLE_WARNINGS()
+
+namespace cc = comms_champion;
+
+namespace comms_dump
+{
+
+namespace
+{
+
+const std::size_t MaxBurst = 256U;
+const auto MinTickInterval = std::chrono::microseconds(100);
+const auto MaxBucketPeriod = std::chrono::milliseconds(10);
+const int StatsInterval = 1000;
+const std::size_t MaxPendingBytes = 1024U * 1024U;
+const int BackoffInterval = 1;
+
+double toSeconds(std::chrono::steady_clock::duration value)
+{
+    return std::chrono::duration_cast<std::chrono::duration<double> >(value).count();
+}
+
+unsigned long long perSecond(unsigned long long value, double seconds)
+{
+    if (seconds <= 0.0) {
+        return 0U;
+    }
+
+    return static_cast<unsigned long long>(static_cast<double>(value) / seconds);
+}
+
+}  // namespace
+
+BlastSender::BlastSender()
+  : m_burstPending(false)
+{
+    connect(
+        &m_statsTimer, SIGNAL(timeout()),
+        this, SLOT(reportStats()));
+
+    m_backoffTimer.setSingleShot(true);
+    connect(
+        &m_backoffTimer, SIGNAL(timeout()),
+        this, SLOT(sendBurst()));
+}
+
+BlastSender::~BlastSender()
+{
+    stopTimingThread();
+}
+
+void BlastSender::setRate(unsigned value)
+{
+    m_rate = value;
+}
+
+void BlastSender::setCount(unsigned long long value)
+{
+    m_count = value;
+}
+
+void BlastSender::setDuration(unsigned value)
+{
+    m_duration = value;
+}
+
+bool BlastSender::start(
+    cc::Protocol& protocol,
+    const cc::Protocol::MessagesList& msgs)
+{
+    stop();
+
+    m_frames.clear();
+    for (auto& msg : msgs) {
+        if (!msg) {
+            continue;
+        }
+
+        auto frame = protocol.write(*msg);
+        if ((!frame) || frame->m_data.empty()) {
+            continue;
+        }
+
+        m_frames.push_back(std::move(frame));
+    }
+
+    if (m_frames.empty()) {
+        std::cerr << "ERROR: No messages to blast" << std::endl;
+        return false;
+    }
+
+    m_nextFrame = 0U;
+    m_sentCount = 0U;
+    m_sentBytes = 0U;
+    m_backoffsCount = 0U;
+    m_reportedCount = 0U;
+    m_reportedBytes = 0U;
+    m_startTime = Clock::now();
+    m_lastRefill = m_startTime;
+    m_lastReport = m_startTime;
+    m_running = true;
+
+    if (0U < m_rate) {
+        // Allow catching up after short stalls of the event loop,
+        // but never burst more than MaxBucketPeriod worth of messages
+        m_bucketSize =
+            std::max(1.0, static_cast<double>(m_rate) * toSeconds(MaxBucketPeriod));
+        m_tokens = 1.0;
+        m_timingStop = false;
+        m_timingThread = std::thread(&BlastSender::timingLoop, this);
+    }
+
+    m_statsTimer.start(StatsInterval);
+    scheduleBurst();
+    return true;
+}
+
+void BlastSender::stop()
+{
+    m_running = false;
+    m_statsTimer.stop();
+    m_backoffTimer.stop();
+    stopTimingThread();
+}
+
+void BlastSender::sendBurst()
+{
+    m_burstPending = false;
+    if (!m_running) {
+        return;
+    }
+
+    auto now = Clock::now();
+    if ((0U < m_duration) &&
+        (std::chrono::milliseconds(m_duration) <= (now - m_startTime))) {
+        complete();
+        return;
+    }
+
+    if (isBackpressured()) {
+        ++m_backoffsCount;
+        if (0U == m_rate) {
+            // Retry when the socket has written some of its backlog,
+            // the rate limited bursts are resumed by the timing thread
+            m_backoffTimer.start(BackoffInterval);
+        }
+        return;
+    }
+
+    auto toSend = MaxBurst;
+    if (0U < m_rate) {
+        m_tokens += toSeconds(now - m_lastRefill) * static_cast<double>(m_rate);
+        m_tokens = std::min(m_tokens, m_bucketSize);
+        m_lastRefill = now;
+        toSend = std::min(toSend, static_cast<std::size_t>(std::floor(m_tokens)));
+    }
+
+    if (0U < m_count) {
+        auto remaining = m_count - m_sentCount;
+        if (remaining < toSend) {
+            toSend = static_cast<std::size_t>(remaining);
+        }
+    }
+
+    for (std::size_t idx = 0U; idx < toSend; ++idx) {
+        auto& frame = m_frames[m_nextFrame];
+        if (m_sendFrameCallback) {
+            m_sendFrameCallback(frame);
+        }
+
+        m_sentBytes += frame->m_data.size();
+        ++m_nextFrame;
+        if (m_frames.size() <= m_nextFrame) {
+            m_nextFrame = 0U;
+        }
+    }
+
+    m_sentCount += toSend;
+
+    if ((0U < m_count) && (m_count <= m_sentCount)) {
+        complete();
+        return;
+    }
+
+    if (0U == m_rate) {
+        // Return to the event loop to let the socket do its job
+        scheduleBurst();
+        return;
+    }
+
+    m_tokens -= static_cast<double>(toSend);
+    if (1.0 <= m_tokens) {
+        scheduleBurst();
+    }
+}
+
+void BlastSender::reportStats()
+{
+    auto now = Clock::now();
+    auto seconds = toSeconds(now - m_lastReport);
+    std::cerr << "INFO: Blast " <<
+        perSecond(m_sentCount - m_reportedCount, seconds) << " msgs/s, " <<
+        perSecond(m_sentBytes - m_reportedBytes, seconds) << " bytes/s" << std::endl;
+
+    m_reportedCount = m_sentCount;
+    m_reportedBytes = m_sentBytes;
+    m_lastReport = now;
+}
+
+void BlastSender::scheduleBurst()
+{
+    if (m_burstPending.exchange(true)) {
+        return;
+    }
+
+    QMetaObject::invokeMethod(this, "sendBurst", Qt::QueuedConnection);
+}
+
+bool BlastSender::isBackpressured() const
+{
+    return
+        static_cast<bool>(m_pendingBytesCallback) &&
+        (MaxPendingBytes < m_pendingBytesCallback());
+}
+
+void BlastSender::timingLoop()
+{
+    assert(0U < m_rate);
+    auto interval =
+        std::max(
+            std::chrono::duration_cast<Clock::duration>(std::chrono::seconds(1)) / m_rate,
+            std::chrono::duration_cast<Clock::duration>(MinTickInterval));
+
+    auto next = Clock::now() + interval;
+    std::unique_lock<std::mutex> guard(m_timingLock);
+    while (!m_timingStop) {
+        if (m_timingCond.wait_until(guard, next) != std::cv_status::timeout) {
+            continue;
+        }
+
+        // Late ticks are compensated by the tokens accumulated in the bucket
+        next += interval;
+        auto now = Clock::now();
+        if (next < now) {
+            next = now + interval;
+        }
+
+        scheduleBurst();
+    }
+}
+
+void BlastSender::stopTimingThread()
+{
+    if (!m_timingThread.joinable()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(m_timingLock);
+        m_timingStop = true;
+    }
+    m_timingCond.notify_all();
+    m_timingThread.join();
+}
+
+void BlastSender::complete()
+{
+    stop();
+    reportTotals();
+
+    if (m_completeCallback) {
+        m_completeCallback();
+    }
+}
+
+void BlastSender::reportTotals()
+{
+    auto seconds = toSeconds(Clock::now() - m_startTime);
+    std::cerr << "INFO: Blast sent " << m_sentCount << " messages (" <<
+        m_sentBytes << " bytes) in " << seconds << " s: " <<
+        perSecond(m_sentCount, seconds) << " msgs/s, " <<
+        perSecond(m_sentBytes, seconds) << " bytes/s, " <<
+        m_backoffsCount << " backoffs" << std::endl;
+}
+
+} /* namespace comms_dump */
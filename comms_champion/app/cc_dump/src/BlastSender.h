@@ -0,0 +1,135 @@
+//
+// Copyright 2016 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <functional>
+
+#include "comms/CompileControl.h"
+
+CC_DISABLE_WARNINGS()
+#include <QtCore/QObject>
+#include <QtCore/QTimer>
+CC_ENABLE_WARNINGS()
+
+#include "comms_champion/Protocol.h"
+#include "comms_champion/DataInfo.h"
+
+namespace comms_dump
+{
+
+class BlastSender : public QObject
+{
+    Q_OBJECT
+public:
+    typedef std::function<void (const comms_champion::DataInfoPtr& frame)> SendFrameCallbackFunc;
+    typedef std::function<std::size_t ()> PendingBytesCallbackFunc;
+    typedef std::function<void ()> CompleteCallbackFunc;
+
+    BlastSender();
+    ~BlastSender();
+
+    template <typename TFunc>
+    void setSendFrameCallbackFunc(TFunc&& func)
+    {
+        m_sendFrameCallback = std::forward<TFunc>(func);
+    }
+
+    // Bytes not written by the socket yet, the bursts are paused while
+    // above the limit
+    template <typename TFunc>
+    void setPendingBytesCallbackFunc(TFunc&& func)
+    {
+        m_pendingBytesCallback = std::forward<TFunc>(func);
+    }
+
+    template <typename TFunc>
+    void setCompleteCallbackFunc(TFunc&& func)
+    {
+        m_completeCallback = std::forward<TFunc>(func);
+    }
+
+    // Messages per second, 0 means as fast as possible
+    void setRate(unsigned value);
+
+    // Total number of messages, 0 means unlimited
+    void setCount(unsigned long long value);
+
+    // Duration in milliseconds, 0 means unlimited
+    void setDuration(unsigned value);
+
+    bool start(
+        comms_champion::Protocol& protocol,
+        const comms_champion::Protocol::MessagesList& msgs);
+
+    void stop();
+
+private slots:
+    void sendBurst();
+    void reportStats();
+
+private:
+    typedef std::chrono::steady_clock Clock;
+    typedef Clock::time_point Timestamp;
+    typedef std::vector<comms_champion::DataInfoPtr> FramesList;
+
+    void scheduleBurst();
+    bool isBackpressured() const;
+    void timingLoop();
+    void stopTimingThread();
+    void complete();
+    void reportTotals();
+
+    SendFrameCallbackFunc m_sendFrameCallback;
+    PendingBytesCallbackFunc m_pendingBytesCallback;
+    CompleteCallbackFunc m_completeCallback;
+    unsigned m_rate = 0U;
+    unsigned long long m_count = 0U;
+    unsigned m_duration = 0U;
+
+    FramesList m_frames;
+    std::size_t m_nextFrame = 0U;
+    bool m_running = false;
+    double m_tokens = 0.0;
+    double m_bucketSize = 0.0;
+    Timestamp m_startTime;
+    Timestamp m_lastRefill;
+
+    unsigned long long m_sentCount = 0U;
+    unsigned long long m_sentBytes = 0U;
+    unsigned long long m_backoffsCount = 0U;
+    unsigned long long m_reportedCount = 0U;
+    unsigned long long m_reportedBytes = 0U;
+    Timestamp m_lastReport;
+    QTimer m_statsTimer;
+    QTimer m_backoffTimer;
+
+    std::thread m_timingThread;
+    std::mutex m_timingLock;
+    std::condition_variable m_timingCond;
+    bool m_timingStop = false;
+    std::atomic<bool> m_burstPending;
+};
+
+} /* namespace comms_dump */
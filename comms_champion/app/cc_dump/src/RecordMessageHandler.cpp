@@ -23,25 +23,27 @@ namespace cc = comms_champion;
 namespace comms_dump
 {
 
-RecordMessageHandler::RecordMessageHandler(const QString& filename)
+RecordMessageHandler::RecordMessageHandler(
+    const QString& filename,
+    cc::MsgFileMgr::Format format,
+    unsigned flushInterval,
+    unsigned syncInterval)
 {
-    m_saveHandler = cc::MsgFileMgr::startRecvSave(filename);
+    m_recorder.setFlushInterval(flushInterval);
+    m_recorder.setSyncInterval(syncInterval);
+    m_recorder.start(filename, format);
 }
 
 RecordMessageHandler::~RecordMessageHandler() = default;
 
-void RecordMessageHandler::flush()
+void RecordMessageHandler::record(cc::MessagePtr msg)
 {
-    if (m_saveHandler) {
-        cc::MsgFileMgr::flushRecvFile(m_saveHandler);
-    }
+    m_recorder.record(std::move(msg));
 }
 
-void RecordMessageHandler::beginMsgHandlingImpl(cc::Message& msg)
+void RecordMessageHandler::flush()
 {
-    if (m_saveHandler) {
-        cc::MsgFileMgr::addToRecvSave(m_saveHandler, msg);
-    }
+    m_recorder.flush();
 }
 
 }  // namespace comms_dump
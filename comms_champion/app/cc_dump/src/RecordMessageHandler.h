@@ -26,27 +26,29 @@ CC_DISABLE_WARNINGS()
 #include <QtCore/QString>
 CC_ENABLE_WARNINGS()
 
-#include "comms_champion/MessageHandler.h"
+#include "comms_champion/Message.h"
 #include "comms_champion/MsgFileMgr.h"
+#include "comms_champion/MsgFileRecorder.h"
 
 namespace comms_dump
 {
 
-class RecordMessageHandler : public comms_champion::MessageHandler
+class RecordMessageHandler
 {
 public:
-    RecordMessageHandler(const QString& filename);
+    RecordMessageHandler(
+        const QString& filename,
+        comms_champion::MsgFileMgr::Format format = comms_champion::MsgFileMgr::Format::Json,
+        unsigned flushInterval = comms_champion::MsgFileRecorder::DefaultFlushInterval,
+        unsigned syncInterval = comms_champion::MsgFileRecorder::DefaultSyncInterval);
 
-    virtual ~RecordMessageHandler();
+    ~RecordMessageHandler();
 
+    void record(comms_champion::MessagePtr msg);
     void flush();
 
-protected:
-    virtual void beginMsgHandlingImpl(comms_champion::Message& msg) override;
-
 private:
-    typedef comms_champion::MsgFileMgr::FileSaveHandler FileSaveHandler;
-    FileSaveHandler m_saveHandler;
+    comms_champion::MsgFileRecorder m_recorder;
 
 };
 
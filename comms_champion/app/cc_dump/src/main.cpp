@@ -44,7 +44,14 @@ const QString OutMsgsOptStr("msgs-to-send");
 const QString InMsgsOptStr("received-msgs");
 const QString LastWaitOptStr("last-wait");
 const QString RecordSentOptStr("record-sent");
+const QString BinaryOptStr("binary");
+const QString RecordFlushOptStr("record-flush");
+const QString RecordSyncOptStr("record-sync");
 const QString QuietOptStr("quiet");
+const QString BlastOptStr("blast");
+const QString BlastRateOptStr("blast-rate");
+const QString BlastCountOptStr("blast-count");
+const QString BlastDurationOptStr("blast-duration");
 
 void metaTypesRegisterAll()
 {
@@ -94,12 +101,69 @@ void prepareCommandLineOptions(QCommandLineParser& parser)
     );
     parser.addOption(recordSentOpt);
 
+    QCommandLineOption binaryOpt(
+        QStringList() << "b" << BinaryOptStr,
+        QCoreApplication::translate("main", "Store received messages in compact binary format "
+                                            "instead of JSON.")
+    );
+    parser.addOption(binaryOpt);
+
+    QCommandLineOption recordFlushOpt(
+        RecordFlushOptStr,
+        QCoreApplication::translate("main", "Interval (in milliseconds) of flushing recorded "
+                                            "messages to the file. Default is 1000 ms. "
+                                            "0 means flush after every written batch."),
+        QCoreApplication::translate("main", "ms")
+    );
+    parser.addOption(recordFlushOpt);
+
+    QCommandLineOption recordSyncOpt(
+        RecordSyncOptStr,
+        QCoreApplication::translate("main", "Interval (in milliseconds) of syncing the recorded "
+                                            "messages file to the storage device. "
+                                            "Default is 0, which means never."),
+        QCoreApplication::translate("main", "ms")
+    );
+    parser.addOption(recordSyncOpt);
+
     QCommandLineOption quietOpt(
         QStringList() << "q" << QuietOptStr,
         QCoreApplication::translate("main", "Quiet mode, don't dump CSV output to stdout.")
     );
     parser.addOption(quietOpt);
 
+    QCommandLineOption blastOpt(
+        BlastOptStr,
+        QCoreApplication::translate("main", "Blast mode, encode the messages to send once "
+                                            "and send them in a loop ignoring their delays "
+                                            "and repeats. Sent messages are not recorded.")
+    );
+    parser.addOption(blastOpt);
+
+    QCommandLineOption blastRateOpt(
+        BlastRateOptStr,
+        QCoreApplication::translate("main", "Target rate (in messages per second) of the "
+                                            "blast mode. Default is 0, which means "
+                                            "as fast as possible."),
+        QCoreApplication::translate("main", "msgs")
+    );
+    parser.addOption(blastRateOpt);
+
+    QCommandLineOption blastCountOpt(
+        BlastCountOptStr,
+        QCoreApplication::translate("main", "Total number of messages to send in the "
+                                            "blast mode. Default is 0, which means unlimited."),
+        QCoreApplication::translate("main", "count")
+    );
+    parser.addOption(blastCountOpt);
+
+    QCommandLineOption blastDurationOpt(
+        BlastDurationOptStr,
+        QCoreApplication::translate("main", "Duration (in milliseconds) of the blast mode. "
+                                            "Default is 0, which means unlimited."),
+        QCoreApplication::translate("main", "ms")
+    );
+    parser.addOption(blastDurationOpt);
 }
 
 }  // namespace
@@ -158,11 +222,59 @@ int main(int argc, char *argv[])
         config.m_recordOutgoing = true;
     }
 
+    if (parser.isSet(BinaryOptStr)) {
+        config.m_recordBinary = true;
+    }
+
+    if (parser.isSet(RecordFlushOptStr)) {
+        bool ok = false;
+        unsigned value = parser.value(RecordFlushOptStr).toUInt(&ok);
+        if (ok) {
+            config.m_recordFlushInterval = value;
+        }
+    }
+
+    if (parser.isSet(RecordSyncOptStr)) {
+        bool ok = false;
+        unsigned value = parser.value(RecordSyncOptStr).toUInt(&ok);
+        if (ok) {
+            config.m_recordSyncInterval = value;
+        }
+    }
+
     if (parser.isSet(QuietOptStr)) {
         config.m_quiet = true;
     }
 
-    comms_dump::AppMgr appMgr;
+    if (parser.isSet(BlastOptStr)) {
+        config.m_blast = true;
+    }
+
+    if (parser.isSet(BlastRateOptStr)) {
+        bool ok = false;
+        unsigned value = parser.value(BlastRateOptStr).toUInt(&ok);
+        if (ok) {
+            config.m_blastRate = value;
+        }
+    }
+
+    if (parser.isSet(BlastCountOptStr)) {
+        bool ok = false;
+        unsigned long long value = parser.value(BlastCountOptStr).toULongLong(&ok);
+        if (ok) {
+            config.m_blastCount = value;
+        }
+    }
+
+    if (parser.isSet(BlastDurationOptStr)) {
+        bool ok = false;
+        unsigned value = parser.value(BlastDurationOptStr).toUInt(&ok);
+        if (ok) {
+            config.m_blastDuration = value;
+        }
+    }
+
+        comms_dump::AppMgr appMgr;
     if (!appMgr.start(config)) {
         std::cerr << "Failed to start!" << std::endl;
         return -1;
@@ -618,10 +618,10 @@ GuiAppMgr::GuiAppMgr(QObject* parentObj)
         &m_pendingDisplayTimer, SIGNAL(timeout()),
         this, SLOT(pendingDisplayTimeout()));
 
-    m_sendMgr.setSendMsgsCallbackFunc(
-        [this](MessagesList&& msgsToSend)
+    m_sendMgr.setSendFrameCallbackFunc(
+        [](const DataInfoPtr& frame, MessagePtr msg)
         {
-            MsgMgrG::instanceRef().sendMsgs(std::move(msgsToSend));
+            MsgMgrG::instanceRef().sendFrame(frame, std::move(msg));
         });
 
     m_sendMgr.setSendCompeteCallbackFunc(
@@ -738,6 +738,10 @@ void GuiAppMgr::msgClicked(MessagePtr msg, SelectionType selType)
 void GuiAppMgr::displayMessage(MessagePtr msg)
 {
     m_pendingDisplayMsg.reset();
+    auto protocol = MsgMgrG::instanceRef().getProtocol();
+    if (msg && protocol) {
+        protocol->resolveEndpoints(*msg);
+    }
     emit sigDisplayMsg(msg);
 }
 
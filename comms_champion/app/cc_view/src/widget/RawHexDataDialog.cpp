@@ -28,6 +28,7 @@ CC_DISABLE_WARNINGS()
 #include <QtWidgets/QPushButton>
 CC_ENABLE_WARNINGS()
 
+#include "comms_champion/HexCodec.h"
 #include "comms_champion/property/message.h"
 
 namespace comms_champion
@@ -108,38 +109,7 @@ void RawHexDataDialog::accept()
     dataInfo.m_timestamp = DataInfo::TimestampClock::now();
     dataInfo.m_data.reserve(str.size() / 2);
 
-    QString numStr;
-    auto addValueFunc =
-        [&dataInfo, &numStr]()
-        {
-            bool ok = false;
-            auto byte = static_cast<DataInfo::DataSeq::value_type>(numStr.toUInt(&ok, 16));
-            static_cast<void>(ok);
-            assert(ok);
-            dataInfo.m_data.push_back(byte);
-            numStr.clear();
-        };
-
-    for (auto ch : str) {
-        if (ch.isSpace()) {
-           if (!numStr.isEmpty()) {
-               addValueFunc();
-           }
-
-           continue;
-        }
-
-        numStr.append(ch);
-        if (numStr.size() < 2) {
-            continue;
-        }
-
-        addValueFunc();
-    }
-
-    if (!numStr.isEmpty()) {
-        addValueFunc();
-    }
+    decodeHex(str, dataInfo.m_data, HexDecodeMode::Separated);
 
     if (!m_ui.m_convertCheckBox->isChecked()) {
         auto msg = m_protocol->createInvalidMessage(dataInfo.m_data);
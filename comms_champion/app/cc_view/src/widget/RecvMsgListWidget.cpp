@@ -30,6 +30,7 @@ CC_ENABLE_WARNINGS()
 #include "RecvAreaToolBar.h"
 #include "GuiAppMgr.h"
 #include "MsgFileMgrG.h"
+#include "MsgMgrG.h"
 
 namespace comms_champion
 {
@@ -113,6 +114,12 @@ QString RecvMsgListWidget::getTitleImpl() const
 
 void RecvMsgListWidget::saveMessagesImpl(const QString& filename)
 {
+    auto protocol = MsgMgrG::instanceRef().getProtocol();
+    if (filename.endsWith(".pcap", Qt::CaseInsensitive) && protocol) {
+        MsgFileMgrG::instanceRef().savePcap(filename, allMsgs(), *protocol);
+        return;
+    }
+
     MsgFileMgrG::instanceRef().save(MsgFileMgr::Type::Recv, filename, allMsgs());
 }
 
@@ -20,6 +20,7 @@
 #include <algorithm>
 #include <cassert>
 
+#include "comms_champion/HexCodec.h"
 #include "comms_champion/property/field.h"
 
 namespace comms_champion
@@ -207,15 +208,7 @@ void ArrayListFieldWidget::addDataField(FieldWidget* dataFieldWidget)
 
 void ArrayListFieldWidget::refreshInternal()
 {
-    QString serValueStr;
-    auto serValue = m_wrapper->getSerialisedValue();
-
-    for (auto byte : serValue) {
-        if (!serValueStr.isEmpty()) {
-            serValueStr.append(QChar(' '));
-        }
-        serValueStr.append(QString("%1").arg(byte, 2, 16, QChar('0')));
-    }
+    auto serValueStr = encodeHex(m_wrapper->getSerialisedValue(), ' ');
 
     assert(m_ui.m_serValuePlainTextEdit != nullptr);
     m_ui.m_serValuePlainTextEdit->setPlainText(serValueStr);
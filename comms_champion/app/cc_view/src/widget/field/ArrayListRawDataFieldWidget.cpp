@@ -21,6 +21,8 @@
 #include <cassert>
 #include <limits>
 
+#include "comms_champion/HexCodec.h"
+
 namespace comms_champion
 {
 
@@ -48,15 +50,7 @@ ArrayListRawDataFieldWidget::~ArrayListRawDataFieldWidget() = default;
 
 void ArrayListRawDataFieldWidget::refreshImpl()
 {
-    QString serValueStr;
-    auto serValue = m_wrapper->getSerialisedValue();
-
-    for (auto byte : serValue) {
-        if (!serValueStr.isEmpty()) {
-            serValueStr.append(QChar(' '));
-        }
-        serValueStr.append(QString("%1").arg(byte, 2, 16, QChar('0')));
-    }
+    auto serValueStr = encodeHex(m_wrapper->getSerialisedValue(), ' ');
 
     assert(m_ui.m_serValuePlainTextEdit != nullptr);
     m_ui.m_serValuePlainTextEdit->setPlainText(serValueStr);
@@ -41,10 +41,19 @@ struct DataInfo
     typedef std::chrono::time_point<TimestampClock> Timestamp;
     typedef std::vector<std::uint8_t> DataSeq;
     typedef QVariantMap PropertiesMap;
+    typedef unsigned StreamId;
+    typedef unsigned EndpointId;
+
+    static const StreamId DefaultStreamId = 0U;
+    static const EndpointId NoEndpoint = 0U;
 
     Timestamp m_timestamp;
     DataSeq m_data;
     PropertiesMap m_extraProperties;
+    StreamId m_streamId = DefaultStreamId;
+    EndpointId m_fromEndpoint = NoEndpoint;
+    EndpointId m_toEndpoint = NoEndpoint;
+    bool m_wholeFrame = false; // data contains complete frame(s), no accumulation required
 };
 
 using DataInfoPtr = std::shared_ptr<DataInfo>;
@@ -0,0 +1,68 @@
+//
+// Copyright 2016 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+#include "Api.h"
+#include "DataInfo.h"
+
+namespace comms_champion
+{
+
+class DataInfoPoolImpl;
+class CC_API DataInfoPool
+{
+public:
+    struct Stats
+    {
+        unsigned long long m_allocCount = 0U;
+        unsigned long long m_hitCount = 0U;
+        std::size_t m_outstandingCount = 0U;
+        std::size_t m_peakOutstandingCount = 0U;
+        std::size_t m_cachedCount = 0U;
+    };
+
+    static const std::size_t DefaultMaxCachedCount = 1024U;
+    static const std::size_t DefaultMaxRetainedCapacity = 64U * 1024U;
+
+    explicit DataInfoPool(
+        std::size_t maxCachedCount = DefaultMaxCachedCount,
+        std::size_t maxRetainedCapacity = DefaultMaxRetainedCapacity);
+    ~DataInfoPool();
+
+    DataInfoPool(const DataInfoPool&) = delete;
+    DataInfoPool& operator=(const DataInfoPool&) = delete;
+
+    DataInfoPtr alloc();
+
+    Stats getStats() const;
+
+    static double hitRate(const Stats& stats);
+
+    static DataInfoPool& instanceRef();
+
+private:
+    std::shared_ptr<DataInfoPoolImpl> m_impl;
+};
+
+}  // namespace comms_champion
+
@@ -0,0 +1,132 @@
+//
+// Copyright 2016 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <functional>
+#include <memory>
+#include <algorithm>
+#include <iterator>
+
+#include "comms/CompileControl.h"
+
+CC_DISABLE_WARNINGS()
+#include <QtCore/QString>
+CC_ENABLE_WARNINGS()
+
+#include "Api.h"
+#include "DataInfo.h"
+
+namespace comms_champion
+{
+
+class EndpointRegistryImpl;
+class CC_API EndpointRegistry
+{
+public:
+    typedef DataInfo::EndpointId EndpointId;
+    typedef unsigned TransportId;
+    typedef std::array<std::uint8_t, 16> AddressBytes;
+    typedef std::uint16_t PortType;
+    typedef std::function<QString ()> FormatFunc;
+
+    // Least recently used endpoints are evicted above the capacity,
+    // ids are never reused, so evicted ones resolve into empty names.
+    // Pinned endpoints are not evicted and not counted in the capacity.
+    static const std::size_t DefaultCapacity = 64U * 1024U;
+
+    EndpointRegistry();
+    ~EndpointRegistry();
+
+    EndpointRegistry(const EndpointRegistry&) = delete;
+    EndpointRegistry& operator=(const EndpointRegistry&) = delete;
+
+    void setCapacity(std::size_t value);
+
+    TransportId registerTransport(const QString& name);
+
+    EndpointId find(
+        TransportId transport,
+        const AddressBytes& address,
+        PortType port) const;
+
+    EndpointId insert(
+        TransportId transport,
+        const AddressBytes& address,
+        PortType port,
+        FormatFunc&& formatFunc);
+
+    template <typename TFunc>
+    EndpointId intern(
+        TransportId transport,
+        const AddressBytes& address,
+        PortType port,
+        TFunc&& formatFunc)
+    {
+        auto id = find(transport, address, port);
+        if (id != DataInfo::NoEndpoint) {
+            return id;
+        }
+
+        return insert(transport, address, port, FormatFunc(std::forward<TFunc>(formatFunc)));
+    }
+
+    template <typename THostAddress>
+    EndpointId internHost(
+        TransportId transport,
+        const THostAddress& address,
+        PortType port)
+    {
+        auto ipv6 = address.toIPv6Address();
+        AddressBytes bytes;
+        std::copy(std::begin(ipv6.c), std::end(ipv6.c), bytes.begin());
+        return
+            intern(
+                transport,
+                bytes,
+                port,
+                [address, port]() -> QString
+                {
+                    return address.toString() + ':' + QString("%1").arg(port);
+                });
+    }
+
+    QString endpointName(EndpointId id) const;
+
+    // Pins are counted, used for the endpoints of the retained messages
+    void pin(EndpointId fromEndpoint, EndpointId toEndpoint);
+    void unpin(EndpointId fromEndpoint, EndpointId toEndpoint);
+
+    void addToProperties(const DataInfo& info, DataInfo::PropertiesMap& props) const;
+    void addToProperties(
+        EndpointId fromEndpoint,
+        EndpointId toEndpoint,
+        DataInfo::PropertiesMap& props) const;
+
+    static EndpointRegistry& instanceRef();
+
+private:
+    std::unique_ptr<EndpointRegistryImpl> m_impl;
+};
+
+}  // namespace comms_champion
+
@@ -50,6 +50,12 @@ public:
 
     QList<DataInfoPtr> sendData(DataInfoPtr dataPtr);
 
+    typedef std::vector<DataInfoPtr> DataInfosList;
+
+    void recvDataBatch(const DataInfoPtr* data, std::size_t count, DataInfosList& out);
+
+    void sendDataBatch(const DataInfoPtr* data, std::size_t count, DataInfosList& out);
+
     typedef std::function<void (DataInfoPtr)> DataToSendCallback;
     template <typename TFunc>
     void setDataToSendCallback(TFunc&& func)
@@ -69,6 +75,8 @@ protected:
     virtual void stopImpl();
     virtual QList<DataInfoPtr> recvDataImpl(DataInfoPtr dataPtr) = 0;
     virtual QList<DataInfoPtr> sendDataImpl(DataInfoPtr dataPtr) = 0;
+    virtual void recvDataBatchImpl(const DataInfoPtr* data, std::size_t count, DataInfosList& out);
+    virtual void sendDataBatchImpl(const DataInfoPtr* data, std::size_t count, DataInfosList& out);
 
     void reportDataToSend(DataInfoPtr dataPtr);
 
@@ -0,0 +1,64 @@
+//
+// Copyright 2016 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "comms/CompileControl.h"
+
+CC_DISABLE_WARNINGS()
+#include <QtCore/QString>
+CC_ENABLE_WARNINGS()
+
+#include "Api.h"
+
+namespace comms_champion
+{
+
+typedef std::vector<std::uint8_t> HexDataSeq;
+
+enum class HexDecodeMode
+{
+    PadFront, // odd number of digits gets leading zero: "abc" -> 0a bc
+    PadBack, // odd number of digits gets trailing zero: "abc" -> ab c0
+    Separated // white space terminates the byte: "1 23 4" -> 01 23 04
+};
+
+// Lower case hex digits, optionally with separator character between the bytes
+CC_API QString encodeHex(const std::uint8_t* data, std::size_t len, char sep = '\0');
+
+inline QString encodeHex(const HexDataSeq& data, char sep = '\0')
+{
+    return encodeHex(data.data(), data.size(), sep);
+}
+
+// Characters other than hex digits (and white spaces in Separated mode)
+// are ignored.
+CC_API void decodeHex(const QString& str, HexDataSeq& data, HexDecodeMode mode);
+
+inline HexDataSeq decodeHex(const QString& str, HexDecodeMode mode)
+{
+    HexDataSeq data;
+    decodeHex(str, data, mode);
+    return data;
+}
+
+}  // namespace comms_champion
@@ -0,0 +1,131 @@
+//
+// Copyright 2016 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#pragma once
+
+#include <cstddef>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+
+namespace comms_champion
+{
+
+class LatencyRecorder
+{
+public:
+    typedef std::chrono::nanoseconds Duration;
+
+    enum class Mode
+    {
+        KeepFirst,
+        KeepLast
+    };
+
+    static const std::size_t DefaultCapacity = 1000U;
+
+    explicit LatencyRecorder(
+        Mode mode = Mode::KeepLast,
+        std::size_t capacity = DefaultCapacity)
+      : m_mode(mode),
+        m_capacity(capacity)
+    {
+        m_values.reserve(capacity);
+    }
+
+    void clear()
+    {
+        m_values.clear();
+        m_nextIdx = 0U;
+        m_totalCount = 0U;
+        m_max = Duration::zero();
+    }
+
+    bool isFull() const
+    {
+        return m_capacity <= m_values.size();
+    }
+
+    void record(Duration value)
+    {
+        if (value < Duration::zero()) {
+            value = Duration::zero();
+        }
+
+        ++m_totalCount;
+        if (m_capacity == 0U) {
+            return;
+        }
+
+        if (!isFull()) {
+            m_values.push_back(value);
+            m_max = std::max(m_max, value);
+            return;
+        }
+
+        if (m_mode == Mode::KeepFirst) {
+            return;
+        }
+
+        m_values[m_nextIdx] = value;
+        m_nextIdx = (m_nextIdx + 1U) % m_capacity;
+        m_max = std::max(m_max, value);
+    }
+
+    std::size_t count() const
+    {
+        return m_values.size();
+    }
+
+    unsigned long long totalCount() const
+    {
+        return m_totalCount;
+    }
+
+    Duration percentile(double pct) const
+    {
+        if (m_values.empty()) {
+            return Duration::zero();
+        }
+
+        pct = std::min(std::max(pct, 0.0), 100.0);
+        auto values = m_values;
+        auto idx =
+            static_cast<std::size_t>(
+                (pct / 100.0) * static_cast<double>(values.size() - 1U) + 0.5);
+        std::nth_element(values.begin(), values.begin() + idx, values.end());
+        return values[idx];
+    }
+
+    Duration max() const
+    {
+        return m_max;
+    }
+
+private:
+    Mode m_mode = Mode::KeepLast;
+    std::size_t m_capacity = DefaultCapacity;
+    std::vector<Duration> m_values;
+    std::size_t m_nextIdx = 0U;
+    unsigned long long m_totalCount = 0U;
+    Duration m_max = Duration::zero();
+};
+
+}  // namespace comms_champion
+
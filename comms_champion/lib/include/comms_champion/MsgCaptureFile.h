@@ -0,0 +1,98 @@
+//
+// Copyright 2016 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "comms/CompileControl.h"
+
+CC_DISABLE_WARNINGS()
+#include <QtCore/QString>
+#include <QtCore/QByteArray>
+CC_ENABLE_WARNINGS()
+
+#include "Api.h"
+#include "Message.h"
+
+namespace comms_champion
+{
+
+// Compact binary capture of received messages:
+//   header: "CCMSGCAP" magic, u32 version, u32 reserved
+//   record: u32 size of the rest of the record, u64 timestamp (ms),
+//           u8 message type, u8 reserved, u16 id length, u32 data length,
+//           u32 extra info length, id (UTF-8), data, extra info (compact JSON)
+// All the integral values are little endian.
+class MsgCaptureFileImpl;
+class CC_API MsgCaptureFile
+{
+public:
+    // Views into memory mapped file, valid until the file is closed
+    struct Record
+    {
+        unsigned long long m_timestamp = 0U;
+        Message::Type m_type = Message::Type::Invalid;
+        const char* m_id = nullptr;
+        std::size_t m_idLen = 0U;
+        const std::uint8_t* m_data = nullptr;
+        std::size_t m_dataLen = 0U;
+        const char* m_extraInfo = nullptr;
+        std::size_t m_extraInfoLen = 0U;
+    };
+
+    typedef unsigned long long Position;
+
+    static const std::size_t HeaderSize = 16U;
+
+    MsgCaptureFile();
+    ~MsgCaptureFile();
+
+    MsgCaptureFile(const MsgCaptureFile&) = delete;
+    MsgCaptureFile& operator=(const MsgCaptureFile&) = delete;
+
+    bool open(const QString& filename);
+    void close();
+    bool isOpen() const;
+
+    // Returns false when there are no more complete records
+    bool readNext(Record& record);
+    void rewind();
+
+    // Offset of the next record from the beginning of the file, seek()
+    // expects the value to be at the record boundary.
+    Position position() const;
+    bool seek(Position pos);
+
+    static bool isCaptureHeader(const QByteArray& data);
+    static QByteArray header();
+    static void appendRecord(
+        QByteArray& buf,
+        unsigned long long timestamp,
+        Message::Type type,
+        const QByteArray& id,
+        const Message::DataSeq& data,
+        const QByteArray& extraInfo);
+
+private:
+    std::unique_ptr<MsgCaptureFileImpl> m_impl;
+};
+
+}  // namespace comms_champion
@@ -0,0 +1,120 @@
+//
+// Copyright 2016 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <memory>
+
+#include "comms/CompileControl.h"
+
+CC_DISABLE_WARNINGS()
+#include <QtCore/QString>
+#include <QtCore/QByteArray>
+CC_ENABLE_WARNINGS()
+
+#include "Api.h"
+#include "MsgCaptureFile.h"
+
+namespace comms_champion
+{
+
+// Sidecar index of MsgCaptureFile, stored next to the capture with ".idx"
+// suffix appended to its name:
+//   header: "CCMSGIDX" magic, u32 version, u32 reserved, header of
+//           the capture, u32 checksum of the first capture record
+//           (FNV-1a of its size, timestamp and id), u32 reserved
+//   block: u32 size of the rest of the block, u64 begin offset,
+//          u64 end offset, u64 min timestamp, u64 max timestamp,
+//          u32 number of ids, then per id: u16 id length, id (UTF-8),
+//          u32 number of records, u32 length of positions, positions
+//          (LEB128 encoded deltas from the previous one, the first one
+//          is relative to the block begin)
+// The blocks cover consecutive records of the capture and are only
+// appended, i.e. the index is written while the capture is recorded.
+// Records not covered by the sidecar (interrupted recording) are indexed
+// when the index is opened. The sidecar of another capture is rebuilt.
+class MsgCaptureIndexImpl;
+class CC_API MsgCaptureIndex
+{
+public:
+    typedef MsgCaptureFile::Position Position;
+
+    struct Span
+    {
+        Position m_begin = 0U;
+        Position m_end = 0U;
+    };
+
+    typedef std::vector<Span> SpansList;
+    typedef std::vector<Position> PositionsList;
+
+    static const std::size_t DefaultBlockSize = 256U;
+
+    MsgCaptureIndex();
+    ~MsgCaptureIndex();
+
+    MsgCaptureIndex(const MsgCaptureIndex&) = delete;
+    MsgCaptureIndex& operator=(const MsgCaptureIndex&) = delete;
+
+    // Number of records per block, applied on next open() or create()
+    void setBlockSize(std::size_t value);
+    std::size_t getBlockSize() const;
+
+    // Loads the sidecar index of existing capture, creating or completing
+    // it when needed. Returns false when the capture cannot be read, the
+    // index is still usable when the sidecar file cannot be written.
+    bool open(const QString& captureFilename);
+
+    // Starts empty sidecar index of the capture being recorded, the
+    // records are reported via addRecord(). Only the current block is
+    // kept in memory, the lookups are available after open().
+    bool create(const QString& captureFilename);
+
+    // Writes the incomplete block into the sidecar and closes it
+    void close();
+    bool isOpen() const;
+
+    // Records must be reported in the file order, end is the position
+    // right after the record.
+    void addRecord(
+        Position pos,
+        Position end,
+        unsigned long long timestamp,
+        const char* id,
+        std::size_t idLen);
+
+    // End of the last indexed record
+    Position indexedEnd() const;
+    unsigned long long recordsCount() const;
+
+    // Spans of the file containing all the records with timestamps in
+    // the [from, to] range, may contain other records as well.
+    SpansList findTimeRange(unsigned long long from, unsigned long long to) const;
+
+    // Positions of all the records with the message id
+    PositionsList findId(const QByteArray& id) const;
+
+    static QString filenameFor(const QString& captureFilename);
+
+private:
+    std::unique_ptr<MsgCaptureIndexImpl> m_impl;
+};
+
+}  // namespace comms_champion
@@ -21,18 +21,22 @@
 #include <utility>
 #include <list>
 #include <memory>
+#include <functional>
+#include <cstddef>
 
 #include "comms/CompileControl.h"
 
 CC_DISABLE_WARNINGS()
 #include <QtCore/QString>
 #include <QtCore/QVariantList>
+#include <QtCore/QVariantMap>
 #include <QtCore/QFile>
 CC_ENABLE_WARNINGS()
 
 #include "Api.h"
 #include "Message.h"
 #include "Protocol.h"
+#include "MsgCaptureFile.h"
 
 namespace comms_champion
 {
@@ -49,6 +53,12 @@ public:
         Send
     };
 
+    enum class Format
+    {
+        Json,
+        Binary
+    };
+
     MsgFileMgr();
     ~MsgFileMgr();
     MsgFileMgr(const MsgFileMgr&);
@@ -62,13 +72,74 @@ public:
     static const QString& getFilesFilter();
 
     MessagesList load(Type type, const QString& filename, Protocol& protocol);
+
+    // Messages are reported in batches while the file is being read,
+    // false is returned on error after the successfully read messages
+    // have been reported.
+    typedef std::function<void (MessagesList&& msgs)> LoadBatchCallback;
+    static const std::size_t DefaultLoadBatchSize = 1024U;
+    bool loadStreamed(
+        Type type,
+        const QString& filename,
+        Protocol& protocol,
+        LoadBatchCallback callback,
+        std::size_t batchSize = DefaultLoadBatchSize);
+
+    // Binary captures are queried via their sidecar index (see
+    // MsgCaptureIndex), which is created on first use, only the matching
+    // records are read. Other files are read entirely and filtered.
+    // The timestamps are in the recorded (ms) units, inclusive range.
+    bool loadTimeRange(
+        Type type,
+        const QString& filename,
+        Protocol& protocol,
+        unsigned long long fromTimestamp,
+        unsigned long long toTimestamp,
+        LoadBatchCallback callback,
+        std::size_t batchSize = DefaultLoadBatchSize);
+    bool loadById(
+        Type type,
+        const QString& filename,
+        Protocol& protocol,
+        const QString& id,
+        LoadBatchCallback callback,
+        std::size_t batchSize = DefaultLoadBatchSize);
+
     bool save(Type type, const QString& filename, const MessagesList& msgs);
 
-    typedef std::shared_ptr<QFile> FileSaveHandler;
-    static FileSaveHandler startRecvSave(const QString& filename);
+    // Wire frames of the messages are stored as UDP datagrams, received
+    // messages are incoming and all the others are outgoing ones. pcap and
+    // pcapng files are recognised by load() and loadStreamed().
+    bool savePcap(const QString& filename, const MessagesList& msgs, Protocol& protocol);
+
+    // Copy of the received message data required to store it in
+    // recv-save file, can be formatted on any thread.
+    struct RecvSaveEntry
+    {
+        unsigned long long m_timestamp = 0U;
+        Message::Type m_type = Message::Type::Invalid;
+        QString m_id;
+        Message::DataSeq m_data;
+        QVariantMap m_extraInfo;
+    };
+
+    static bool snapshotRecvMsg(const Message& msg, RecvSaveEntry& entry);
+    static QByteArray recvSavePrefix(Format format);
+    static QByteArray recvSaveSuffix(Format format);
+    static QByteArray recvSaveSeparator(Format format);
+    static void appendRecvSaveEntry(QByteArray& buf, const RecvSaveEntry& entry, Format format);
+
+    // Open recv-save file, the format suffix is written when the last
+    // copy of the handler is released.
+    struct RecvSaveFile;
+    typedef std::shared_ptr<RecvSaveFile> FileSaveHandler;
+    static FileSaveHandler startRecvSave(const QString& filename, Format format = Format::Json);
     static void addToRecvSave(FileSaveHandler handler, const Message& msg, bool flush = false);
     static void flushRecvFile(FileSaveHandler handler);
 
+    static MessagePtr createRecvMsg(const QVariantMap& msgMap, Protocol& protocol);
+    static MessagePtr createRecvMsg(const MsgCaptureFile::Record& record, Protocol& protocol);
+
 private:
     QString m_lastFile;
 };
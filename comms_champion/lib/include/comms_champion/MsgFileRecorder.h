@@ -0,0 +1,84 @@
+//
+// Copyright 2016 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+
+#include "comms/CompileControl.h"
+
+CC_DISABLE_WARNINGS()
+#include <QtCore/QString>
+CC_ENABLE_WARNINGS()
+
+#include "Api.h"
+#include "Message.h"
+#include "MsgFileMgr.h"
+
+namespace comms_champion
+{
+
+// Records received messages into recv-save file on a background thread.
+// The calling thread only pushes the message pointer into a bounded queue,
+// the encoding, formatting and file writes are performed by the writer
+// thread in batches, so the recorded message must not be modified
+// afterwards. When the queue is full the caller blocks until there is space.
+// Binary captures get their sidecar index (see MsgCaptureIndex) written
+// along the way.
+class MsgFileRecorderImpl;
+class CC_API MsgFileRecorder
+{
+public:
+    typedef MsgFileMgr::Format Format;
+
+    static const std::size_t DefaultQueueCapacity = 64U * 1024U;
+    static const unsigned DefaultFlushInterval = 1000U;
+    static const unsigned DefaultSyncInterval = 0U;
+
+    MsgFileRecorder();
+    ~MsgFileRecorder();
+
+    MsgFileRecorder(const MsgFileRecorder&) = delete;
+    MsgFileRecorder& operator=(const MsgFileRecorder&) = delete;
+
+    // Configuration is applied on the next start()
+    void setQueueCapacity(std::size_t value);
+    std::size_t getQueueCapacity() const;
+
+    // Interval (ms) of flushing written data to the OS, 0 means after
+    // every written batch
+    void setFlushInterval(unsigned value);
+    unsigned getFlushInterval() const;
+
+    // Interval (ms) of syncing the file to the storage device, 0 disables
+    void setSyncInterval(unsigned value);
+    unsigned getSyncInterval() const;
+
+    bool start(const QString& filename, Format format = Format::Json);
+    void stop();
+    bool isRunning() const;
+
+    void record(MessagePtr msg);
+    void flush();
+
+private:
+    std::unique_ptr<MsgFileRecorderImpl> m_impl;
+};
+
+}  // namespace comms_champion
@@ -0,0 +1,62 @@
+//
+// Copyright 2016 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <memory>
+
+#include "comms/CompileControl.h"
+
+CC_DISABLE_WARNINGS()
+#include <QtCore/QString>
+#include <QtCore/QVariantMap>
+CC_ENABLE_WARNINGS()
+
+#include "Api.h"
+
+namespace comms_champion
+{
+
+// Reads JSON messages file (top level array of objects) one element at
+// a time, i.e. memory consumption doesn't depend on the file size.
+class MsgFileStreamReaderImpl;
+class CC_API MsgFileStreamReader
+{
+public:
+    MsgFileStreamReader();
+    ~MsgFileStreamReader();
+
+    MsgFileStreamReader(const MsgFileStreamReader&) = delete;
+    MsgFileStreamReader& operator=(const MsgFileStreamReader&) = delete;
+
+    bool open(const QString& filename);
+    void close();
+    bool isOpen() const;
+
+    // Returns false at the end of the array or on error. A file ending
+    // before the array is closed is reported as an error.
+    bool readNext(QVariantMap& msgMap);
+
+    bool hasError() const;
+    const QString& errorString() const;
+
+private:
+    std::unique_ptr<MsgFileStreamReaderImpl> m_impl;
+};
+
+}  // namespace comms_champion
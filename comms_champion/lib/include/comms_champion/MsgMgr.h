@@ -40,6 +40,16 @@ public:
 
     typedef Message::Type MsgType;
 
+    struct Stats
+    {
+        unsigned long long m_recvMsgs = 0U;
+        unsigned long long m_recvBytes = 0U;
+        unsigned long long m_sentMsgs = 0U;
+        unsigned long long m_sentBytes = 0U;
+        unsigned long long m_invalidMsgs = 0U;
+        unsigned long long m_errors = 0U;
+    };
+
     MsgMgr();
     ~MsgMgr();
 
@@ -51,11 +61,20 @@ public:
     ProtocolPtr getProtocol() const;
     void setRecvEnabled(bool enabled);
 
+    // When disabled, the messages are reported via the "message added"
+    // callback and dropped afterwards, getAllMsgs() stays empty.
+    void setMsgsRetained(bool retained);
+    const Stats& getStats() const;
+
     void deleteMsg(MessagePtr msg);
     void deleteAllMsgs();
 
     void sendMsgs(MessagesList&& msgs);
 
+    // Sends copy of the frame encoded earlier, the message (if provided)
+    // is recorded as the sent one.
+    void sendFrame(const DataInfoPtr& frame, MessagePtr msg = MessagePtr());
+
     const AllMessages& getAllMsgs() const;
     void addMsgs(const MessagesList& msgs, bool reportAdded = true);
 
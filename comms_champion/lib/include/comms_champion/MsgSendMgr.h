@@ -23,6 +23,7 @@
 #include "Api.h"
 #include "Message.h"
 #include "Protocol.h"
+#include "LatencyRecorder.h"
 
 namespace comms_champion
 {
@@ -33,6 +34,7 @@ class CC_API MsgSendMgr
 public:
     typedef Protocol::MessagesList MessagesList;
     typedef std::function<void (MessagesList&&)> SendMsgsCallbackFunc;
+    typedef std::function<void (const DataInfoPtr& frame, MessagePtr msg)> SendFrameCallbackFunc;
     typedef std::function<void ()> SendCompleteCallbackFunc;
 
     MsgSendMgr();
@@ -41,10 +43,20 @@ public:
     void setSendMsgsCallbackFunc(SendMsgsCallbackFunc&& func);
     void setSendCompeteCallbackFunc(SendCompleteCallbackFunc&& func);
 
+    // Used instead of the messages callback when set. The frames of the
+    // scheduled messages are encoded once on start() and reused by the
+    // repeats. The message objects of the sends are created only when
+    // required, empty pointer is reported otherwise.
+    void setSendFrameCallbackFunc(SendFrameCallbackFunc&& func);
+    void setSentMsgsRequired(bool value);
+
     void start(ProtocolPtr protocol, const MessagesList& msgs);
 
     void stop();
 
+    // Lateness of the recent sends relative to their scheduled time
+    const LatencyRecorder& getJitter() const;
+
 private:
     std::unique_ptr<MsgSendMgrImpl> m_impl;
 };
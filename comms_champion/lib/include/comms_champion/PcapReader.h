@@ -0,0 +1,109 @@
+//
+// Copyright 2016 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <memory>
+
+#include "comms/CompileControl.h"
+
+CC_DISABLE_WARNINGS()
+#include <QtCore/QString>
+#include <QtCore/QByteArray>
+CC_ENABLE_WARNINGS()
+
+#include "Api.h"
+
+namespace comms_champion
+{
+
+// Streams UDP datagrams and reassembled TCP data out of pcap and pcapng
+// captures. Supported link types are Ethernet (with VLAN tags), Linux
+// cooked capture (v1 and v2), BSD loopback and raw IP. Fragmented IP
+// packets are skipped. TCP data of every direction of every connection
+// is reported in sequence order as separate stream, retransmitted data
+// is dropped.
+class PcapReaderImpl;
+class CC_API PcapReader
+{
+public:
+    enum class Transport
+    {
+        Udp,
+        Tcp
+    };
+
+    typedef std::array<std::uint8_t, 16> AddressBytes;
+    typedef unsigned long long Position;
+
+    // The data points into memory mapped file or internal buffer, valid
+    // until the next read.
+    struct Record
+    {
+        unsigned long long m_timestampUs = 0U;
+        Transport m_transport = Transport::Udp;
+        AddressBytes m_srcAddress; // IPv4 addresses are IPv4-mapped IPv6 ones
+        AddressBytes m_dstAddress;
+        std::uint16_t m_srcPort = 0U;
+        std::uint16_t m_dstPort = 0U;
+        unsigned m_streamId = 0U; // unique per direction of TCP connection or UDP flow, starts from 1
+        const std::uint8_t* m_data = nullptr;
+        std::size_t m_dataLen = 0U;
+    };
+
+    static const std::size_t MagicSize = 4U;
+    static const std::size_t DefaultMaxPendingBytes = 4U * 1024U * 1024U;
+
+    PcapReader();
+    ~PcapReader();
+
+    PcapReader(const PcapReader&) = delete;
+    PcapReader& operator=(const PcapReader&) = delete;
+
+    bool open(const QString& filename);
+    void close();
+    bool isOpen() const;
+
+    // Report only packets with the given source or destination port,
+    // 0 means all.
+    void setPortFilter(std::uint16_t port);
+
+    // Out of order TCP data above the limit causes the gap to be skipped
+    void setMaxPendingBytes(std::size_t value);
+
+    // Returns false at the end of the capture or on error
+    bool readNext(Record& record);
+
+    // Position of the next packet, the TCP reassembly restarts after seek
+    Position position() const;
+    bool seek(Position pos);
+    void rewind();
+
+    bool hasError() const;
+    const QString& errorString() const;
+
+    static bool isPcapHeader(const QByteArray& data);
+
+private:
+    std::unique_ptr<PcapReaderImpl> m_impl;
+};
+
+}  // namespace comms_champion
@@ -0,0 +1,71 @@
+//
+// Copyright 2016 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "comms/CompileControl.h"
+
+CC_DISABLE_WARNINGS()
+#include <QtCore/QString>
+CC_ENABLE_WARNINGS()
+
+#include "Api.h"
+
+namespace comms_champion
+{
+
+// Writes data into classic pcap file (raw IP link type) as UDP datagrams
+// between two loopback ports, so it can be opened by the common packet
+// analysis tools as well as by PcapReader. Data exceeding maximal
+// datagram size is split.
+class PcapWriterImpl;
+class CC_API PcapWriter
+{
+public:
+    static const std::uint16_t DefaultLocalPort = 50000U;
+    static const std::uint16_t DefaultRemotePort = 20000U;
+
+    PcapWriter();
+    ~PcapWriter();
+
+    PcapWriter(const PcapWriter&) = delete;
+    PcapWriter& operator=(const PcapWriter&) = delete;
+
+    bool open(const QString& filename);
+    void close();
+    bool isOpen() const;
+
+    // Outgoing data is sent from local to remote port, incoming one
+    // in the opposite direction.
+    void setPorts(std::uint16_t localPort, std::uint16_t remotePort);
+
+    bool write(
+        unsigned long long timestampUs,
+        const std::uint8_t* data,
+        std::size_t len,
+        bool outgoing);
+
+private:
+    std::unique_ptr<PcapWriterImpl> m_impl;
+};
+
+}  // namespace comms_champion
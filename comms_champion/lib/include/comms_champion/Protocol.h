@@ -59,6 +59,8 @@ public:
 
     DataInfoPtr write(Message& msg);
 
+    void closeStream(DataInfo::StreamId streamId);
+
     MessagesList createAllMessages();
 
     MessagePtr createMessage(const QString& idAsString, unsigned idx = 0);
@@ -69,6 +71,12 @@ public:
 
     MessagePtr createInvalidMessage(const MsgDataSeq& data);
 
+    // Endpoints are stored as ids and resolved into names only when
+    // the message is displayed or saved.
+    static void setEndpointsToMessageProperties(const DataInfo& dataInfo, Message& msg);
+    static QVariantMap getExtraInfo(const Message& msg);
+    void resolveEndpoints(Message& msg);
+
 protected:
     virtual const QString& nameImpl() const = 0;
 
@@ -76,6 +84,8 @@ protected:
 
     virtual DataInfoPtr writeImpl(Message& msg) = 0;
 
+    virtual void closeStreamImpl(DataInfo::StreamId streamId);
+
     virtual MessagesList createAllMessagesImpl() = 0;
 
     virtual MessagePtr createMessageImpl(const QString& idAsString, unsigned idx) = 0;
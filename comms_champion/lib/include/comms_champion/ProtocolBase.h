@@ -21,6 +21,7 @@
 #include <algorithm>
 #include <iterator>
 #include <cassert>
+#include <map>
 
 
 #include "comms/CompileControl.h"
@@ -78,41 +79,57 @@ protected:
 
     virtual MessagesList readImpl(const DataInfo& dataInfo, bool final) override
     {
-        const std::uint8_t* iter = &dataInfo.m_data[0];
-        auto size = dataInfo.m_data.size();
+        auto& stream = m_streams[dataInfo.m_streamId];
+        auto& garbage = stream.m_garbage;
+
+        // Complete frames are parsed in place when there is nothing accumulated
+        bool inPlace = dataInfo.m_wholeFrame && stream.m_data.empty();
+        if (inPlace) {
+            final = true;
+        }
+        else {
+            auto& accData = stream.m_data;
+            accData.reserve(accData.size() + dataInfo.m_data.size());
+            std::copy(dataInfo.m_data.begin(), dataInfo.m_data.end(), std::back_inserter(accData));
+        }
+
+        const auto& data = inPlace ? dataInfo.m_data : stream.m_data;
 
         MessagesList allMsgs;
-        m_data.reserve(m_data.size() + size);
-        std::copy_n(iter, size, std::back_inserter(m_data));
 
         using ReadIterator = typename ProtocolMessage::ReadIterator;
-        ReadIterator readIterBeg = &m_data[0];
+        ReadIterator readIterBeg = &data[0];
 
         auto remainingSizeCalc =
-            [this](ReadIterator readIter) -> std::size_t
+            [&data](ReadIterator readIter) -> std::size_t
             {
-                ReadIterator const dataBegin = &m_data[0];
+                ReadIterator const dataBegin = &data[0];
                 auto consumed =
                     static_cast<std::size_t>(
                         std::distance(dataBegin, readIter));
-                assert(consumed <= m_data.size());
-                return m_data.size() - consumed;
+                assert(consumed <= data.size());
+                return data.size() - consumed;
             };
 
         auto eraseGuard =
             comms::util::makeScopeGuard(
-                [this, &readIterBeg]()
+                [&stream, &data, &readIterBeg, inPlace]()
                 {
-                    ReadIterator dataBegin = &m_data[0];
+                    if (inPlace) {
+                        return;
+                    }
+
+                    ReadIterator dataBegin = &data[0];
                     auto dist =
                         static_cast<std::size_t>(
                             std::distance(dataBegin, readIterBeg));
-                    m_data.erase(m_data.begin(), m_data.begin() + dist);
+                    stream.m_data.erase(stream.m_data.begin(), stream.m_data.begin() + dist);
                 });
 
         auto setExtraInfoFunc =
             [&dataInfo](Message& msg)
             {
+                setEndpointsToMessageProperties(dataInfo, msg);
                 if (dataInfo.m_extraProperties.isEmpty()) {
                     return;
                 }
@@ -130,20 +147,20 @@ protected:
             };
 
         auto checkGarbageFunc =
-            [this, &allMsgs, &setExtraInfoFunc]()
+            [this, &garbage, &allMsgs, &setExtraInfoFunc]()
             {
-                if (!m_garbage.empty()) {
+                if (!garbage.empty()) {
                     MessagePtr invalidMsgPtr(new InvalidMsg());
                     setNameToMessageProperties(*invalidMsgPtr);
                     std::unique_ptr<RawDataMsg> rawDataMsgPtr(new RawDataMsg());
-                    ReadIterator garbageReadIterator = &m_garbage[0];
-                    auto esTmp = rawDataMsgPtr->read(garbageReadIterator, m_garbage.size());
+                    ReadIterator garbageReadIterator = &garbage[0];
+                    auto esTmp = rawDataMsgPtr->read(garbageReadIterator, garbage.size());
                     static_cast<void>(esTmp);
                     assert(esTmp == comms::ErrorStatus::Success);
                     setRawDataToMessageProperties(MessagePtr(rawDataMsgPtr.release()), *invalidMsgPtr);
                     setExtraInfoFunc(*invalidMsgPtr);
                     allMsgs.push_back(std::move(invalidMsgPtr));
-                    m_garbage.clear();
+                    garbage.clear();
                 }
             };
 
@@ -222,20 +239,20 @@ protected:
             }
 
             // Protocol error
-            m_garbage.push_back(*readIterBeg);
+            garbage.push_back(*readIterBeg);
             static const std::size_t GarbageLimit = 512;
-            if (GarbageLimit <= m_garbage.size()) {
+            if (GarbageLimit <= garbage.size()) {
                 checkGarbageFunc();
             }
             ++readIterBeg;
         }
 
         if (final) {
-            ReadIterator dataBegin = &m_data[0];
+            ReadIterator dataBegin = &data[0];
             auto consumed =
                 static_cast<std::size_t>(std::distance(dataBegin, readIterBeg));
-            auto remDataCount = m_data.size() - consumed;
-            m_garbage.insert(m_garbage.end(), m_data.begin() + consumed, m_data.end());
+            auto remDataCount = data.size() - consumed;
+            garbage.insert(garbage.end(), data.begin() + consumed, data.end());
             std::advance(readIterBeg, remDataCount);
             checkGarbageFunc();
         }
@@ -269,6 +286,11 @@ protected:
         return dataInfo;
     }
 
+    virtual void closeStreamImpl(DataInfo::StreamId streamId) override
+    {
+        m_streams.erase(streamId);
+    }
+
     virtual UpdateStatus updateMessageImpl(Message& msg) override
     {
         bool refreshed = msg.refreshMsg();
@@ -525,9 +547,16 @@ private:
         return result;
     }
 
+    struct StreamState
+    {
+        std::vector<std::uint8_t> m_data;
+        std::vector<std::uint8_t> m_garbage;
+    };
+
+    typedef std::map<DataInfo::StreamId, StreamState> StreamsMap;
+
     ProtocolStack m_protStack;
-    std::vector<std::uint8_t> m_data;
-    std::vector<std::uint8_t> m_garbage;
+    StreamsMap m_streams;
 };
 
 }  // namespace comms_champion
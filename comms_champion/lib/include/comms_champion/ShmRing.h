@@ -0,0 +1,427 @@
+//
+// Copyright 2016 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#ifndef __linux__
+#error "ShmRing is supported on Linux only"
+#endif
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <cerrno>
+#include <algorithm>
+#include <atomic>
+#include <new>
+#include <string>
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+namespace comms_champion
+{
+
+// Single producer / single consumer ring buffer in POSIX shared memory.
+// Header only and Qt independent, so producer applications may use it
+// without linking to CommsChampion. The consumer creates the ring,
+// the producer attaches to it. Futex is used only to wake up the consumer
+// sleeping on an empty ring.
+class ShmRing
+{
+public:
+    static const std::uint32_t Magic = 0x52536343; // "CcSR"
+    static const std::uint32_t Version = 1U;
+    static const std::size_t MinCapacity = 4U * 1024U;
+    static const std::size_t DefaultCapacity = 4U * 1024U * 1024U;
+
+    ShmRing() = default;
+
+    ~ShmRing()
+    {
+        close();
+    }
+
+    ShmRing(const ShmRing&) = delete;
+    ShmRing& operator=(const ShmRing&) = delete;
+
+    // Consumer side, capacity is rounded up to power of two
+    bool create(const std::string& name, std::size_t capacity = DefaultCapacity)
+    {
+        close();
+
+        std::size_t roundedCapacity = MinCapacity;
+        while (roundedCapacity < capacity) {
+            roundedCapacity <<= 1;
+        }
+
+        ::shm_unlink(name.c_str());
+        int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd < 0) {
+            return setError("shm_open");
+        }
+
+        auto mapSize = sizeof(Header) + roundedCapacity;
+        if (::ftruncate(fd, static_cast<off_t>(mapSize)) != 0) {
+            setError("ftruncate");
+            ::close(fd);
+            ::shm_unlink(name.c_str());
+            return false;
+        }
+
+        if (!map(fd, mapSize)) {
+            ::shm_unlink(name.c_str());
+            return false;
+        }
+
+        auto* header = new (m_header) Header;
+        header->m_capacity = roundedCapacity;
+        header->m_head.store(0U, std::memory_order_relaxed);
+        header->m_tail.store(0U, std::memory_order_relaxed);
+        header->m_consumerWaiting.store(0U, std::memory_order_relaxed);
+        header->m_wakeSeq.store(0U, std::memory_order_relaxed);
+        header->m_version = Version;
+        header->m_magic.store(Magic, std::memory_order_release);
+
+        m_name = name;
+        m_owner = true;
+        loadCachedPositions();
+        return true;
+    }
+
+    // Producer side
+    bool attach(const std::string& name)
+    {
+        close();
+
+        int fd = ::shm_open(name.c_str(), O_RDWR, 0);
+        if (fd < 0) {
+            return setError("shm_open");
+        }
+
+        struct stat info;
+        if (::fstat(fd, &info) != 0) {
+            setError("fstat");
+            ::close(fd);
+            return false;
+        }
+
+        auto mapSize = static_cast<std::size_t>(info.st_size);
+        if (mapSize < (sizeof(Header) + MinCapacity)) {
+            ::close(fd);
+            m_error = "Shared memory object is too small";
+            return false;
+        }
+
+        if (!map(fd, mapSize)) {
+            return false;
+        }
+
+        if ((m_header->m_magic.load(std::memory_order_acquire) != Magic) ||
+            (m_header->m_version != Version) ||
+            ((sizeof(Header) + m_header->m_capacity) != mapSize)) {
+            close();
+            m_error = "Shared memory object is not a valid ring";
+            return false;
+        }
+
+        m_name = name;
+        m_owner = false;
+        loadCachedPositions();
+        return true;
+    }
+
+    void close()
+    {
+        if (m_header != nullptr) {
+            ::munmap(m_header, m_mapSize);
+        }
+
+        if (m_owner) {
+            ::shm_unlink(m_name.c_str());
+        }
+
+        m_header = nullptr;
+        m_data = nullptr;
+        m_mapSize = 0U;
+        m_cachedHead = 0U;
+        m_cachedTail = 0U;
+        m_owner = false;
+        m_name.clear();
+    }
+
+    bool isOpen() const
+    {
+        return m_header != nullptr;
+    }
+
+    std::size_t capacity() const
+    {
+        return isOpen() ? static_cast<std::size_t>(m_header->m_capacity) : 0U;
+    }
+
+    std::size_t maxRecordSize() const
+    {
+        return (capacity() / 2U) - LengthSize;
+    }
+
+    const std::string& errorString() const
+    {
+        return m_error;
+    }
+
+    // Producer side, fails when there is not enough free space
+    bool write(const void* data, std::size_t size)
+    {
+        if ((!isOpen()) || (maxRecordSize() < size)) {
+            return false;
+        }
+
+        auto cap = m_header->m_capacity;
+        auto recordSize = alignedSize(LengthSize + size);
+        auto head = m_header->m_head.load(std::memory_order_relaxed);
+        auto offset = head & (cap - 1U);
+        auto toEnd = cap - offset;
+        std::uint64_t padding = 0U;
+        if (toEnd < recordSize) {
+            padding = toEnd;
+        }
+
+        auto required = padding + recordSize;
+        if (!hasSpace(cap, head, m_cachedTail, required)) {
+            m_cachedTail = m_header->m_tail.load(std::memory_order_acquire);
+            if (!hasSpace(cap, head, m_cachedTail, required)) {
+                return false;
+            }
+        }
+
+        if (padding != 0U) {
+            storeLength(offset, WrapMarker);
+            head += padding;
+            offset = 0U;
+        }
+
+        storeLength(offset, static_cast<std::uint32_t>(size));
+        std::memcpy(&m_data[offset + LengthSize], data, size);
+        m_header->m_head.store(head + recordSize, std::memory_order_seq_cst);
+
+        if (m_header->m_consumerWaiting.load(std::memory_order_seq_cst) != 0U) {
+            wakeConsumer();
+        }
+        return true;
+    }
+
+    // Consumer side, func(const std::uint8_t*, std::size_t) is invoked per record
+    template <typename TFunc>
+    std::size_t read(TFunc&& func, std::size_t maxCount)
+    {
+        if (!isOpen()) {
+            return 0U;
+        }
+
+        auto cap = m_header->m_capacity;
+        auto tail = m_header->m_tail.load(std::memory_order_relaxed);
+        std::size_t count = 0U;
+        while (count < maxCount) {
+            if (m_cachedHead <= tail) {
+                m_cachedHead = m_header->m_head.load(std::memory_order_acquire);
+                if ((m_cachedHead <= tail) || (cap < (m_cachedHead - tail))) {
+                    break;
+                }
+            }
+
+            auto offset = tail & (cap - 1U);
+            auto length = loadLength(offset);
+            if (length == WrapMarker) {
+                tail += cap - offset;
+            }
+            else {
+                func(
+                    static_cast<const std::uint8_t*>(&m_data[offset + LengthSize]),
+                    static_cast<std::size_t>(length));
+                tail += alignedSize(LengthSize + length);
+                ++count;
+            }
+
+            m_header->m_tail.store(tail, std::memory_order_release);
+        }
+
+        return count;
+    }
+
+    bool empty() const
+    {
+        if (!isOpen()) {
+            return true;
+        }
+
+        return
+            m_header->m_head.load(std::memory_order_seq_cst) ==
+                m_header->m_tail.load(std::memory_order_relaxed);
+    }
+
+    // Bytes written by the producer and not consumed yet
+    std::size_t usedBytes() const
+    {
+        if (!isOpen()) {
+            return 0U;
+        }
+
+        auto tail = m_header->m_tail.load(std::memory_order_acquire);
+        auto head = m_header->m_head.load(std::memory_order_acquire);
+        if (head <= tail) {
+            return 0U;
+        }
+
+        return static_cast<std::size_t>(std::min(head - tail, m_header->m_capacity));
+    }
+
+    bool waitForData(unsigned timeoutMs)
+    {
+        if (!isOpen()) {
+            return false;
+        }
+
+        auto seq = m_header->m_wakeSeq.load(std::memory_order_seq_cst);
+        if (!empty()) {
+            return true;
+        }
+
+        m_header->m_consumerWaiting.store(1U, std::memory_order_seq_cst);
+        if (empty()) {
+            struct timespec timeout;
+            timeout.tv_sec = static_cast<time_t>(timeoutMs / 1000U);
+            timeout.tv_nsec = static_cast<long>((timeoutMs % 1000U) * 1000000U);
+            futex(&m_header->m_wakeSeq, FUTEX_WAIT, seq, &timeout);
+        }
+        m_header->m_consumerWaiting.store(0U, std::memory_order_seq_cst);
+        return !empty();
+    }
+
+    void wakeConsumer()
+    {
+        if (!isOpen()) {
+            return;
+        }
+
+        m_header->m_wakeSeq.fetch_add(1U, std::memory_order_seq_cst);
+        futex(&m_header->m_wakeSeq, FUTEX_WAKE, 1U, nullptr);
+    }
+
+private:
+    static const std::size_t CacheLineSize = 64U;
+    static const std::size_t LengthSize = sizeof(std::uint32_t);
+    static const std::uint64_t RecordAlignment = 8U;
+    static const std::uint32_t WrapMarker = 0xffffffffU;
+
+    struct Header
+    {
+        std::atomic<std::uint32_t> m_magic;
+        std::uint32_t m_version;
+        std::uint64_t m_capacity;
+        alignas(CacheLineSize) std::atomic<std::uint64_t> m_head;
+        alignas(CacheLineSize) std::atomic<std::uint64_t> m_tail;
+        alignas(CacheLineSize) std::atomic<std::uint32_t> m_consumerWaiting;
+        std::atomic<std::uint32_t> m_wakeSeq;
+        char m_padding[CacheLineSize - (2 * sizeof(std::uint32_t))];
+    };
+
+    // Positions are free running counters, the tail never passes the head
+    // and the head never gets more than capacity ahead of the tail
+    static bool hasSpace(
+        std::uint64_t cap,
+        std::uint64_t head,
+        std::uint64_t tail,
+        std::uint64_t required)
+    {
+        if (head < tail) {
+            return false;
+        }
+
+        auto used = head - tail;
+        return (used <= cap) && (required <= (cap - used));
+    }
+
+    void loadCachedPositions()
+    {
+        m_cachedHead = m_header->m_head.load(std::memory_order_acquire);
+        m_cachedTail = m_header->m_tail.load(std::memory_order_acquire);
+    }
+
+    static std::uint64_t alignedSize(std::uint64_t size)
+    {
+        return (size + (RecordAlignment - 1U)) & ~(RecordAlignment - 1U);
+    }
+
+    static void futex(
+        std::atomic<std::uint32_t>* addr,
+        int op,
+        std::uint32_t value,
+        const struct timespec* timeout)
+    {
+        ::syscall(SYS_futex, addr, op, value, timeout, nullptr, 0);
+    }
+
+    bool map(int fd, std::size_t mapSize)
+    {
+        auto* addr = ::mmap(nullptr, mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (addr == MAP_FAILED) {
+            return setError("mmap");
+        }
+
+        m_header = static_cast<Header*>(addr);
+        m_data = static_cast<std::uint8_t*>(addr) + sizeof(Header);
+        m_mapSize = mapSize;
+        return true;
+    }
+
+    bool setError(const char* op)
+    {
+        m_error = std::string(op) + ": " + std::strerror(errno);
+        return false;
+    }
+
+    void storeLength(std::uint64_t offset, std::uint32_t length)
+    {
+        std::memcpy(&m_data[offset], &length, sizeof(length));
+    }
+
+    std::uint32_t loadLength(std::uint64_t offset) const
+    {
+        std::uint32_t length = 0U;
+        std::memcpy(&length, &m_data[offset], sizeof(length));
+        return length;
+    }
+
+    Header* m_header = nullptr;
+    std::uint8_t* m_data = nullptr;
+    std::size_t m_mapSize = 0U;
+    std::uint64_t m_cachedHead = 0U;
+    std::uint64_t m_cachedTail = 0U;
+    bool m_owner = false;
+    std::string m_name;
+    std::string m_error;
+};
+
+}  // namespace comms_champion
@@ -21,16 +21,20 @@
 #include <cstdint>
 #include <cstddef>
 #include <vector>
+#include <utility>
 #include <functional>
+#include <memory>
 
 #include "comms/CompileControl.h"
 
 CC_DISABLE_WARNINGS()
 #include <QtCore/QString>
+#include <QtCore/QVariant>
 CC_ENABLE_WARNINGS()
 
 #include "Api.h"
 #include "DataInfo.h"
+#include "Protocol.h"
 
 namespace comms_champion
 {
@@ -59,6 +63,10 @@ public:
 
     void sendData(DataInfoPtr dataPtr);
 
+    // Invoked after the data passed to sendData() has been fully processed
+    // by the caller, e.g. the sent message has been recorded
+    void flushSendData();
+
     typedef std::function<void (DataInfoPtr)> DataReceivedCallback;
     template <typename TFunc>
     void setDataReceivedCallback(TFunc&& func)
@@ -80,7 +88,24 @@ public:
         m_disconnectedReportCallback = std::forward<TFunc>(func);
     }
 
+    typedef std::function <void (DataInfo::StreamId)> StreamClosedReportCallback;
+    template <typename TFunc>
+    void setStreamClosedReportCallback(TFunc&& func)
+    {
+        m_streamClosedReportCallback = std::forward<TFunc>(func);
+    }
+
     unsigned connectionProperties() const;
+
+    // Number of bytes accepted by sendData(), but not written yet
+    std::size_t pendingBytes() const;
+
+    // Implementation specific statistics as name/value pairs
+    typedef std::vector<std::pair<QString, QVariant> > StatsList;
+    StatsList stats() const;
+
+    void setProtocol(ProtocolPtr protocol);
+
 protected:
 
     virtual bool startImpl();
@@ -88,17 +113,24 @@ protected:
     virtual bool socketConnectImpl();
     virtual void socketDisconnectImpl();
     virtual void sendDataImpl(DataInfoPtr dataPtr) = 0;
+    virtual void flushSendDataImpl();
     virtual unsigned connectionPropertiesImpl() const;
+    virtual std::size_t pendingBytesImpl() const;
+    virtual StatsList statsImpl() const;
 
     void reportDataReceived(DataInfoPtr dataPtr);
     void reportError(const QString& msg);
     void reportDisconnected();
+    void reportStreamClosed(DataInfo::StreamId streamId);
+    ProtocolPtr getProtocol() const;
 
 private:
     DataReceivedCallback m_dataReceivedCallback;
     ErrorReportCallback m_errorReportCallback;
     DisconnectedReportCallback m_disconnectedReportCallback;
+    StreamClosedReportCallback m_streamClosedReportCallback;
 
+    std::weak_ptr<Protocol> m_protocol;
     bool m_connected = false;
 };
 
@@ -23,6 +23,11 @@
 #include "MessageHandler.h"
 #include "MessageBase.h"
 #include "ErrorStatus.h"
+#include "DataInfo.h"
+#include "DataInfoPool.h"
+#include "HexCodec.h"
+#include "EndpointRegistry.h"
+#include "LatencyRecorder.h"
 #include "Protocol.h"
 #include "ProtocolBase.h"
 #include "PluginProperties.h"
@@ -35,6 +40,12 @@
 #include "InvalidMessage.h"
 #include "MsgMgr.h"
 #include "MsgFileMgr.h"
+#include "MsgCaptureFile.h"
+#include "MsgCaptureIndex.h"
+#include "MsgFileStreamReader.h"
+#include "MsgFileRecorder.h"
+#include "PcapReader.h"
+#include "PcapWriter.h"
 #include "MsgSendMgr.h"
 #include "StaticSingleton.h"
 #include "property/message.h"
@@ -25,6 +25,7 @@
 #include <cassert>
 #include <memory>
 #include <limits>
+#include <type_traits>
 
 #include "comms/CompileControl.h"
 
@@ -34,6 +35,7 @@ CC_ENABLE_WARNINGS()
 
 #include "comms/comms.h"
 
+#include "comms_champion/HexCodec.h"
 #include "FieldWrapper.h"
 
 namespace comms_champion
@@ -96,52 +98,19 @@ protected:
 
     virtual QString getValueImpl() const override
     {
-        QString retStr;
         auto& dataField = Base::field();
         auto& data = dataField.value();
-        for (auto byte : data) {
-            retStr.append(QString("%1").arg(static_cast<uint>(byte), 2, 16, QChar('0')));
+        typedef typename std::decay<decltype(data[0])>::type ElementType;
+        static_assert(sizeof(ElementType) == 1U, "Raw data is expected to consist of bytes");
+        if (data.empty()) {
+            return QString();
         }
-        return retStr;
+        return encodeHex(reinterpret_cast<const std::uint8_t*>(&data[0]), data.size());
     }
 
     virtual void setValueImpl(const QString& val) override
     {
-        SerialisedSeq data;
-        QString byteStr;
-
-        auto addByteToData =
-            [&data, &byteStr]() mutable
-            {
-                bool ok = false;
-                auto intVal = byteStr.toInt(&ok, 16);
-                if (!ok) {
-                    return;
-                }
-
-                data.push_back(static_cast<typename SerialisedSeq::value_type>(intVal));
-                byteStr.clear();
-            };
-
-        for (auto ch : val) {
-            if (((ch < '0') || ('9' < ch)) &&
-                ((ch.toLower() < 'a') || ('f' < ch.toLower()))) {
-                continue;
-            }
-
-            byteStr.append(ch);
-
-            if (2 <= byteStr.size()) {
-                addByteToData();
-            }
-        }
-
-        if (!byteStr.isEmpty()) {
-            byteStr.append('0');
-            addByteToData();
-        }
-
-        Base::setSerialisedValueImpl(data);
+        Base::setSerialisedValueImpl(decodeHex(val, HexDecodeMode::PadBack));
     }
 
     virtual bool setSerialisedValueImpl(const SerialisedSeq& value) override
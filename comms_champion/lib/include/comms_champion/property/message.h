@@ -246,6 +246,28 @@ private:
     static const QByteArray PropName;
 };
 
+class CC_API FromEndpoint : public PropBase<unsigned>
+{
+    typedef PropBase<unsigned> Base;
+public:
+    FromEndpoint() : Base(Name, PropName) {};
+
+private:
+    static const QString Name;
+    static const QByteArray PropName;
+};
+
+class CC_API ToEndpoint : public PropBase<unsigned>
+{
+    typedef PropBase<unsigned> Base;
+public:
+    ToEndpoint() : Base(Name, PropName) {};
+
+private:
+    static const QString Name;
+    static const QByteArray PropName;
+};
+
 class CC_API ScrollPos : public PropBase<int>
 {
     typedef PropBase<int> Base;
@@ -13,13 +13,17 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include "comms_champion/DataInfo.h"
+#include "comms_champion/DataInfoPool.h"
 
 namespace comms_champion
 {
 
+const DataInfo::StreamId DataInfo::DefaultStreamId;
+const DataInfo::EndpointId DataInfo::NoEndpoint;
+
 CC_API DataInfoPtr makeDataInfo()
 {
-    return DataInfoPtr(new DataInfo());
+    return DataInfoPool::instanceRef().alloc();
 }
 
 } // namespace comms_champion
@@ -0,0 +1,167 @@
+//
+// Copyright 2016 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "comms_champion/DataInfoPool.h"
+
+#include <cassert>
+#include <mutex>
+#include <vector>
+#include <algorithm>
+
+namespace comms_champion
+{
+
+class DataInfoPoolImpl : public std::enable_shared_from_this<DataInfoPoolImpl>
+{
+public:
+    typedef DataInfoPool::Stats Stats;
+
+    DataInfoPoolImpl(std::size_t maxCachedCount, std::size_t maxRetainedCapacity)
+      : m_maxCachedCount(maxCachedCount),
+        m_maxRetainedCapacity(maxRetainedCapacity)
+    {
+    }
+
+    ~DataInfoPoolImpl()
+    {
+        for (auto* info : m_cache) {
+            delete info;
+        }
+    }
+
+    DataInfoPtr alloc()
+    {
+        DataInfo* info = nullptr;
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            ++m_stats.m_allocCount;
+            if (!m_cache.empty()) {
+                info = m_cache.back();
+                m_cache.pop_back();
+                ++m_stats.m_hitCount;
+            }
+
+            ++m_stats.m_outstandingCount;
+            m_stats.m_peakOutstandingCount =
+                std::max(m_stats.m_peakOutstandingCount, m_stats.m_outstandingCount);
+        }
+
+        if (info == nullptr) {
+            info = new DataInfo();
+        }
+
+        std::weak_ptr<DataInfoPoolImpl> pool = shared_from_this();
+        return DataInfoPtr(
+            info,
+            [pool](DataInfo* ptr)
+            {
+                auto poolPtr = pool.lock();
+                if (!poolPtr) {
+                    delete ptr;
+                    return;
+                }
+
+                poolPtr->release(ptr);
+            });
+    }
+
+    Stats getStats() const
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        auto stats = m_stats;
+        stats.m_cachedCount = m_cache.size();
+        return stats;
+    }
+
+private:
+    void release(DataInfo* info)
+    {
+        assert(info != nullptr);
+        if (m_maxRetainedCapacity < info->m_data.capacity()) {
+            DataInfo::DataSeq().swap(info->m_data);
+        }
+        else {
+            info->m_data.clear();
+        }
+
+        info->m_extraProperties.clear();
+        info->m_timestamp = DataInfo::Timestamp();
+        info->m_streamId = DataInfo::DefaultStreamId;
+        info->m_fromEndpoint = DataInfo::NoEndpoint;
+        info->m_toEndpoint = DataInfo::NoEndpoint;
+        info->m_wholeFrame = false;
+
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            assert(0U < m_stats.m_outstandingCount);
+            --m_stats.m_outstandingCount;
+            if (m_cache.size() < m_maxCachedCount) {
+                m_cache.push_back(info);
+                return;
+            }
+        }
+
+        delete info;
+    }
+
+    const std::size_t m_maxCachedCount;
+    const std::size_t m_maxRetainedCapacity;
+    mutable std::mutex m_lock;
+    std::vector<DataInfo*> m_cache;
+    Stats m_stats;
+};
+
+const std::size_t DataInfoPool::DefaultMaxCachedCount;
+const std::size_t DataInfoPool::DefaultMaxRetainedCapacity;
+
+DataInfoPool::DataInfoPool(std::size_t maxCachedCount, std::size_t maxRetainedCapacity)
+  : m_impl(new DataInfoPoolImpl(maxCachedCount, maxRetainedCapacity))
+{
+}
+
+DataInfoPool::~DataInfoPool() = default;
+
+DataInfoPtr DataInfoPool::alloc()
+{
+    return m_impl->alloc();
+}
+
+DataInfoPool::Stats DataInfoPool::getStats() const
+{
+    return m_impl->getStats();
+}
+
+double DataInfoPool::hitRate(const Stats& stats)
+{
+    if (stats.m_allocCount == 0U) {
+        return 0.0;
+    }
+
+    return
+        static_cast<double>(stats.m_hitCount) /
+        static_cast<double>(stats.m_allocCount);
+}
+
+DataInfoPool& DataInfoPool::instanceRef()
+{
+    static DataInfoPool Pool;
+    return Pool;
+}
+
+}  // namespace comms_champion
+
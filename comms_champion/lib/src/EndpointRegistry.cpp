@@ -0,0 +1,398 @@
+//
+// Copyright 2016 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "comms_champion/EndpointRegistry.h"
+
+#include <cassert>
+#include <mutex>
+#include <vector>
+#include <list>
+#include <algorithm>
+#include <unordered_map>
+
+namespace comms_champion
+{
+
+class EndpointRegistryImpl
+{
+public:
+    typedef EndpointRegistry::EndpointId EndpointId;
+    typedef EndpointRegistry::TransportId TransportId;
+    typedef EndpointRegistry::AddressBytes AddressBytes;
+    typedef EndpointRegistry::PortType PortType;
+    typedef EndpointRegistry::FormatFunc FormatFunc;
+
+    void setCapacity(std::size_t value)
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_capacity = std::max(value, std::size_t(1U));
+        evict();
+    }
+
+    TransportId registerTransport(const QString& name)
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        auto iter =
+            std::find_if(
+                m_transports.begin(), m_transports.end(),
+                [&name](const TransportInfo& info) -> bool
+                {
+                    return info.m_name == name;
+                });
+
+        if (iter != m_transports.end()) {
+            return static_cast<TransportId>(std::distance(m_transports.begin(), iter));
+        }
+
+        TransportInfo info;
+        info.m_name = name;
+        info.m_fromPropName = name + ".from";
+        info.m_toPropName = name + ".to";
+        m_transports.push_back(std::move(info));
+        return static_cast<TransportId>(m_transports.size() - 1);
+    }
+
+    EndpointId find(
+        TransportId transport,
+        const AddressBytes& address,
+        PortType port) const
+    {
+        Key key{transport, address, port};
+        std::lock_guard<std::mutex> guard(m_lock);
+        auto iter = m_ids.find(key);
+        if (iter == m_ids.end()) {
+            return DataInfo::NoEndpoint;
+        }
+
+        touch(iter->second);
+        return iter->second->m_id;
+    }
+
+    EndpointId insert(
+        TransportId transport,
+        const AddressBytes& address,
+        PortType port,
+        FormatFunc&& formatFunc)
+    {
+        Key key{transport, address, port};
+        std::lock_guard<std::mutex> guard(m_lock);
+        assert(transport < m_transports.size());
+        auto iter = m_ids.find(key);
+        if (iter != m_ids.end()) {
+            touch(iter->second);
+            return iter->second->m_id;
+        }
+
+        EndpointInfo info;
+        info.m_id = m_nextId;
+        info.m_key = key;
+        info.m_formatFunc = std::move(formatFunc);
+        m_endpoints.push_front(std::move(info));
+
+        ++m_nextId;
+        if (m_nextId == DataInfo::NoEndpoint) {
+            ++m_nextId;
+        }
+
+        auto infoIter = m_endpoints.begin();
+        m_ids.insert(std::make_pair(key, infoIter));
+        m_byId.insert(std::make_pair(infoIter->m_id, infoIter));
+        evict();
+        return infoIter->m_id;
+    }
+
+    QString endpointName(EndpointId id) const
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        auto* info = endpointInfo(id);
+        if (info == nullptr) {
+            return QString();
+        }
+
+        return nameOf(*info);
+    }
+
+    void pin(EndpointId fromEndpoint, EndpointId toEndpoint)
+    {
+        if ((fromEndpoint == DataInfo::NoEndpoint) &&
+            (toEndpoint == DataInfo::NoEndpoint)) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> guard(m_lock);
+        pinEndpoint(fromEndpoint);
+        pinEndpoint(toEndpoint);
+    }
+
+    void unpin(EndpointId fromEndpoint, EndpointId toEndpoint)
+    {
+        if ((fromEndpoint == DataInfo::NoEndpoint) &&
+            (toEndpoint == DataInfo::NoEndpoint)) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> guard(m_lock);
+        unpinEndpoint(fromEndpoint);
+        unpinEndpoint(toEndpoint);
+        evict();
+    }
+
+    void addToProperties(
+        EndpointId fromEndpoint,
+        EndpointId toEndpoint,
+        DataInfo::PropertiesMap& props) const
+    {
+        if ((fromEndpoint == DataInfo::NoEndpoint) &&
+            (toEndpoint == DataInfo::NoEndpoint)) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> guard(m_lock);
+        auto* fromInfo = endpointInfo(fromEndpoint);
+        if (fromInfo != nullptr) {
+            assert(fromInfo->m_key.m_transport < m_transports.size());
+            props.insert(
+                m_transports[fromInfo->m_key.m_transport].m_fromPropName,
+                nameOf(*fromInfo));
+        }
+
+        auto* toInfo = endpointInfo(toEndpoint);
+        if (toInfo != nullptr) {
+            assert(toInfo->m_key.m_transport < m_transports.size());
+            props.insert(
+                m_transports[toInfo->m_key.m_transport].m_toPropName,
+                nameOf(*toInfo));
+        }
+    }
+
+private:
+    struct Key
+    {
+        TransportId m_transport;
+        AddressBytes m_address;
+        PortType m_port;
+
+        bool operator==(const Key& other) const
+        {
+            return
+                (m_transport == other.m_transport) &&
+                (m_port == other.m_port) &&
+                (m_address == other.m_address);
+        }
+    };
+
+    struct KeyHash
+    {
+        std::size_t operator()(const Key& key) const
+        {
+            auto result = static_cast<std::size_t>(14695981039346656037ULL);
+            auto mix =
+                [&result](std::uint8_t byte)
+                {
+                    result ^= byte;
+                    result *= static_cast<std::size_t>(1099511628211ULL);
+                };
+
+            for (auto byte : key.m_address) {
+                mix(byte);
+            }
+
+            mix(static_cast<std::uint8_t>(key.m_port));
+            mix(static_cast<std::uint8_t>(key.m_port >> 8));
+            mix(static_cast<std::uint8_t>(key.m_transport));
+            return result;
+        }
+    };
+
+    struct TransportInfo
+    {
+        QString m_name;
+        QString m_fromPropName;
+        QString m_toPropName;
+    };
+
+    struct EndpointInfo
+    {
+        EndpointId m_id = DataInfo::NoEndpoint;
+        Key m_key;
+        FormatFunc m_formatFunc;
+        mutable QString m_name;
+        mutable bool m_formatted = false;
+        unsigned m_pinCount = 0U;
+    };
+
+    // Most recently used endpoints are at the front, pinned ones are
+    // moved to a separate list
+    typedef std::list<EndpointInfo> EndpointsList;
+    typedef EndpointsList::iterator EndpointIter;
+
+    const EndpointInfo* endpointInfo(EndpointId id) const
+    {
+        auto iter = m_byId.find(id);
+        if (iter == m_byId.end()) {
+            return nullptr;
+        }
+
+        touch(iter->second);
+        return &(*iter->second);
+    }
+
+    void touch(EndpointIter iter) const
+    {
+        if (iter->m_pinCount == 0U) {
+            m_endpoints.splice(m_endpoints.begin(), m_endpoints, iter);
+        }
+    }
+
+    void pinEndpoint(EndpointId id)
+    {
+        auto iter = m_byId.find(id);
+        if (iter == m_byId.end()) {
+            return;
+        }
+
+        auto infoIter = iter->second;
+        if (infoIter->m_pinCount == 0U) {
+            m_pinned.splice(m_pinned.end(), m_endpoints, infoIter);
+        }
+        ++infoIter->m_pinCount;
+    }
+
+    void unpinEndpoint(EndpointId id)
+    {
+        auto iter = m_byId.find(id);
+        if (iter == m_byId.end()) {
+            return;
+        }
+
+        auto infoIter = iter->second;
+        if (infoIter->m_pinCount == 0U) {
+            assert(!"Unpinning endpoint that is not pinned");
+            return;
+        }
+
+        --infoIter->m_pinCount;
+        if (infoIter->m_pinCount == 0U) {
+            m_endpoints.splice(m_endpoints.begin(), m_pinned, infoIter);
+        }
+    }
+
+    void evict()
+    {
+        while (m_capacity < m_endpoints.size()) {
+            auto& info = m_endpoints.back();
+            m_ids.erase(info.m_key);
+            m_byId.erase(info.m_id);
+            m_endpoints.pop_back();
+        }
+    }
+
+    static const QString& nameOf(const EndpointInfo& info)
+    {
+        if (!info.m_formatted) {
+            if (info.m_formatFunc) {
+                info.m_name = info.m_formatFunc();
+            }
+            info.m_formatted = true;
+        }
+
+        return info.m_name;
+    }
+
+    mutable std::mutex m_lock;
+    std::vector<TransportInfo> m_transports;
+    mutable EndpointsList m_endpoints;
+    EndpointsList m_pinned;
+    std::unordered_map<Key, EndpointIter, KeyHash> m_ids;
+    std::unordered_map<EndpointId, EndpointIter> m_byId;
+    EndpointId m_nextId = DataInfo::NoEndpoint + 1;
+    std::size_t m_capacity = EndpointRegistry::DefaultCapacity;
+};
+
+EndpointRegistry::EndpointRegistry()
+  : m_impl(new EndpointRegistryImpl())
+{
+}
+
+EndpointRegistry::~EndpointRegistry() = default;
+
+void EndpointRegistry::setCapacity(std::size_t value)
+{
+    m_impl->setCapacity(value);
+}
+
+EndpointRegistry::TransportId EndpointRegistry::registerTransport(const QString& name)
+{
+    return m_impl->registerTransport(name);
+}
+
+EndpointRegistry::EndpointId EndpointRegistry::find(
+    TransportId transport,
+    const AddressBytes& address,
+    PortType port) const
+{
+    return m_impl->find(transport, address, port);
+}
+
+EndpointRegistry::EndpointId EndpointRegistry::insert(
+    TransportId transport,
+    const AddressBytes& address,
+    PortType port,
+    FormatFunc&& formatFunc)
+{
+    return m_impl->insert(transport, address, port, std::move(formatFunc));
+}
+
+QString EndpointRegistry::endpointName(EndpointId id) const
+{
+    return m_impl->endpointName(id);
+}
+
+void EndpointRegistry::pin(EndpointId fromEndpoint, EndpointId toEndpoint)
+{
+    m_impl->pin(fromEndpoint, toEndpoint);
+}
+
+void EndpointRegistry::unpin(EndpointId fromEndpoint, EndpointId toEndpoint)
+{
+    m_impl->unpin(fromEndpoint, toEndpoint);
+}
+
+void EndpointRegistry::addToProperties(
+    const DataInfo& info,
+    DataInfo::PropertiesMap& props) const
+{
+    m_impl->addToProperties(info.m_fromEndpoint, info.m_toEndpoint, props);
+}
+
+void EndpointRegistry::addToProperties(
+    EndpointId fromEndpoint,
+    EndpointId toEndpoint,
+    DataInfo::PropertiesMap& props) const
+{
+    m_impl->addToProperties(fromEndpoint, toEndpoint, props);
+}
+
+EndpointRegistry& EndpointRegistry::instanceRef()
+{
+    static EndpointRegistry Registry;
+    return Registry;
+}
+
+}  // namespace comms_champion
+
@@ -43,6 +43,22 @@ QList<DataInfoPtr> Filter::sendData(DataInfoPtr dataPtr)
     return sendDataImpl(std::move(dataPtr));
 }
 
+void Filter::recvDataBatch(
+    const DataInfoPtr* data,
+    std::size_t count,
+    DataInfosList& out)
+{
+    recvDataBatchImpl(data, count, out);
+}
+
+void Filter::sendDataBatch(
+    const DataInfoPtr* data,
+    std::size_t count,
+    DataInfosList& out)
+{
+    sendDataBatchImpl(data, count, out);
+}
+
 bool Filter::startImpl()
 {
     return true;
@@ -52,6 +68,28 @@ void Filter::stopImpl()
 {
 }
 
+void Filter::recvDataBatchImpl(
+    const DataInfoPtr* data,
+    std::size_t count,
+    DataInfosList& out)
+{
+    for (auto idx = 0U; idx < count; ++idx) {
+        auto result = recvDataImpl(data[idx]);
+        out.insert(out.end(), result.begin(), result.end());
+    }
+}
+
+void Filter::sendDataBatchImpl(
+    const DataInfoPtr* data,
+    std::size_t count,
+    DataInfosList& out)
+{
+    for (auto idx = 0U; idx < count; ++idx) {
+        auto result = sendDataImpl(data[idx]);
+        out.insert(out.end(), result.begin(), result.end());
+    }
+}
+
 void Filter::reportDataToSend(DataInfoPtr dataPtr)
 {
     if (m_dataToSendCallback) {
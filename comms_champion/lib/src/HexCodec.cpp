@@ -0,0 +1,161 @@
+//
+// Copyright 2016 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "comms_champion/HexCodec.h"
+
+#include <cassert>
+
+namespace comms_champion
+{
+
+namespace
+{
+
+const char HexDigits[] = "0123456789abcdef";
+
+const signed char InvalidChar = -1;
+const signed char SpaceChar = -2;
+
+struct DecodeTable
+{
+    DecodeTable()
+    {
+        for (auto& val : m_values) {
+            val = InvalidChar;
+        }
+
+        for (auto idx = 0; idx < 10; ++idx) {
+            m_values['0' + idx] = static_cast<signed char>(idx);
+        }
+
+        for (auto idx = 0; idx < 6; ++idx) {
+            m_values['a' + idx] = static_cast<signed char>(10 + idx);
+            m_values['A' + idx] = static_cast<signed char>(10 + idx);
+        }
+
+        m_values[' '] = SpaceChar;
+        m_values['\t'] = SpaceChar;
+        m_values['\n'] = SpaceChar;
+        m_values['\r'] = SpaceChar;
+    }
+
+    signed char value(QChar ch) const
+    {
+        auto code = ch.unicode();
+        if (0x7f < code) {
+            return InvalidChar;
+        }
+        return m_values[code];
+    }
+
+private:
+    signed char m_values[0x80];
+};
+
+const DecodeTable& decodeTable()
+{
+    static const DecodeTable Table;
+    return Table;
+}
+
+}  // namespace
+
+QString encodeHex(const std::uint8_t* data, std::size_t len, char sep)
+{
+    if (len == 0U) {
+        return QString();
+    }
+
+    std::size_t charsCount = len * 2;
+    if (sep != '\0') {
+        charsCount += len - 1;
+    }
+
+    QString str(static_cast<int>(charsCount), Qt::Uninitialized);
+    auto* out = str.data();
+    for (auto idx = 0U; idx < len; ++idx) {
+        if ((idx != 0U) && (sep != '\0')) {
+            *out = QLatin1Char(sep);
+            ++out;
+        }
+
+        auto byte = data[idx];
+        out[0] = QLatin1Char(HexDigits[byte >> 4]);
+        out[1] = QLatin1Char(HexDigits[byte & 0xf]);
+        out += 2;
+    }
+    assert(out == (str.data() + str.size()));
+    return str;
+}
+
+void decodeHex(const QString& str, HexDataSeq& data, HexDecodeMode mode)
+{
+    auto& table = decodeTable();
+    auto* begin = str.constData();
+    auto* end = begin + str.size();
+
+    bool pending = false;
+    if (mode == HexDecodeMode::PadFront) {
+        std::size_t digitsCount = 0U;
+        for (auto* pos = begin; pos != end; ++pos) {
+            if (0 <= table.value(*pos)) {
+                ++digitsCount;
+            }
+        }
+        pending = ((digitsCount & 0x1) != 0U);
+    }
+
+    data.reserve(data.size() + static_cast<std::size_t>(str.size() / 2) + 1U);
+    unsigned byte = 0U;
+    for (auto* pos = begin; pos != end; ++pos) {
+        auto val = table.value(*pos);
+        if (val == SpaceChar) {
+            if ((mode == HexDecodeMode::Separated) && pending) {
+                data.push_back(static_cast<std::uint8_t>(byte));
+                pending = false;
+                byte = 0U;
+            }
+            continue;
+        }
+
+        if (val < 0) {
+            continue;
+        }
+
+        byte = (byte << 4) | static_cast<unsigned>(val);
+        if (!pending) {
+            pending = true;
+            continue;
+        }
+
+        data.push_back(static_cast<std::uint8_t>(byte));
+        pending = false;
+        byte = 0U;
+    }
+
+    if (!pending) {
+        return;
+    }
+
+    if (mode == HexDecodeMode::PadBack) {
+        byte <<= 4;
+    }
+    data.push_back(static_cast<std::uint8_t>(byte));
+}
+
+}  // namespace comms_champion
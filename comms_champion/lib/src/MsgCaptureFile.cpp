@@ -0,0 +1,266 @@
+//
+// Copyright 2016 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "comms_champion/MsgCaptureFile.h"
+
+#include <cassert>
+#include <cstring>
+#include <algorithm>
+
+CC_DISABLE_WARNINGS()
+#include <QtCore/QFile>
+CC_ENABLE_WARNINGS()
+
+namespace comms_champion
+{
+
+namespace
+{
+
+const char Magic[] = "CCMSGCAP";
+const std::size_t MagicSize = sizeof(Magic) - 1;
+const std::uint32_t Version = 1U;
+const std::size_t RecordSizeFieldLen = 4U;
+const std::size_t RecordFixedLen = 20U;
+
+template <typename T>
+T readLittleEndian(const uchar*& pos, std::size_t size)
+{
+    T value = 0;
+    for (auto idx = 0U; idx < size; ++idx) {
+        value |= static_cast<T>(static_cast<T>(pos[idx]) << (idx * 8U));
+    }
+    pos += size;
+    return value;
+}
+
+template <typename T>
+void writeLittleEndian(QByteArray& buf, T value, std::size_t size)
+{
+    for (auto idx = 0U; idx < size; ++idx) {
+        buf.append(static_cast<char>(static_cast<std::uint8_t>(value >> (idx * 8U))));
+    }
+}
+
+}  // namespace
+
+class MsgCaptureFileImpl
+{
+public:
+    QFile m_file;
+    uchar* m_begin = nullptr;
+    const uchar* m_end = nullptr;
+    const uchar* m_pos = nullptr;
+};
+
+MsgCaptureFile::MsgCaptureFile()
+  : m_impl(new MsgCaptureFileImpl())
+{
+}
+
+MsgCaptureFile::~MsgCaptureFile()
+{
+    close();
+}
+
+bool MsgCaptureFile::open(const QString& filename)
+{
+    close();
+
+    auto& file = m_impl->m_file;
+    file.setFileName(filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    auto size = file.size();
+    if (size < static_cast<qint64>(HeaderSize)) {
+        file.close();
+        return false;
+    }
+
+    auto* data = file.map(0, size);
+    if (data == nullptr) {
+        file.close();
+        return false;
+    }
+
+    if (std::memcmp(data, Magic, MagicSize) != 0) {
+        file.unmap(data);
+        file.close();
+        return false;
+    }
+
+    const uchar* versionPos = data + MagicSize;
+    auto version = readLittleEndian<std::uint32_t>(versionPos, sizeof(std::uint32_t));
+    if (version != Version) {
+        file.unmap(data);
+        file.close();
+        return false;
+    }
+
+    m_impl->m_begin = data;
+    m_impl->m_end = data + size;
+    m_impl->m_pos = data + HeaderSize;
+    return true;
+}
+
+void MsgCaptureFile::close()
+{
+    auto& file = m_impl->m_file;
+    if (m_impl->m_begin != nullptr) {
+        file.unmap(m_impl->m_begin);
+    }
+
+    if (file.isOpen()) {
+        file.close();
+    }
+
+    m_impl->m_begin = nullptr;
+    m_impl->m_end = nullptr;
+    m_impl->m_pos = nullptr;
+}
+
+bool MsgCaptureFile::isOpen() const
+{
+    return m_impl->m_begin != nullptr;
+}
+
+bool MsgCaptureFile::readNext(Record& record)
+{
+    auto pos = m_impl->m_pos;
+    auto end = m_impl->m_end;
+    if ((pos == nullptr) ||
+        (static_cast<std::size_t>(end - pos) < (RecordSizeFieldLen + RecordFixedLen))) {
+        return false;
+    }
+
+    auto recSize = readLittleEndian<std::uint32_t>(pos, sizeof(std::uint32_t));
+    if ((recSize < RecordFixedLen) ||
+        (static_cast<std::size_t>(end - pos) < recSize)) {
+        // Truncated capture
+        return false;
+    }
+
+    auto recEnd = pos + recSize;
+    auto timestamp = readLittleEndian<std::uint64_t>(pos, sizeof(std::uint64_t));
+    auto type = readLittleEndian<std::uint8_t>(pos, sizeof(std::uint8_t));
+    ++pos; // reserved
+    auto idLen = readLittleEndian<std::uint16_t>(pos, sizeof(std::uint16_t));
+    auto dataLen = readLittleEndian<std::uint32_t>(pos, sizeof(std::uint32_t));
+    auto extraLen = readLittleEndian<std::uint32_t>(pos, sizeof(std::uint32_t));
+
+    auto payloadLen =
+        static_cast<std::size_t>(idLen) +
+        static_cast<std::size_t>(dataLen) +
+        static_cast<std::size_t>(extraLen);
+    if (static_cast<std::size_t>(recEnd - pos) < payloadLen) {
+        return false;
+    }
+
+    record.m_timestamp = timestamp;
+    record.m_type = Message::Type::Invalid;
+    if (type < static_cast<std::uint8_t>(Message::Type::NumOfValues)) {
+        record.m_type = static_cast<Message::Type>(type);
+    }
+
+    record.m_id = reinterpret_cast<const char*>(pos);
+    record.m_idLen = idLen;
+    pos += idLen;
+    record.m_data = pos;
+    record.m_dataLen = dataLen;
+    pos += dataLen;
+    record.m_extraInfo = reinterpret_cast<const char*>(pos);
+    record.m_extraInfoLen = extraLen;
+
+    m_impl->m_pos = recEnd;
+    return true;
+}
+
+void MsgCaptureFile::rewind()
+{
+    if (m_impl->m_begin != nullptr) {
+        m_impl->m_pos = m_impl->m_begin + HeaderSize;
+    }
+}
+
+MsgCaptureFile::Position MsgCaptureFile::position() const
+{
+    if (m_impl->m_begin == nullptr) {
+        return 0U;
+    }
+
+    return static_cast<Position>(m_impl->m_pos - m_impl->m_begin);
+}
+
+bool MsgCaptureFile::seek(Position pos)
+{
+    auto begin = m_impl->m_begin;
+    if ((begin == nullptr) ||
+        (pos < HeaderSize) ||
+        (static_cast<Position>(m_impl->m_end - begin) < pos)) {
+        return false;
+    }
+
+    m_impl->m_pos = begin + pos;
+    return true;
+}
+
+bool MsgCaptureFile::isCaptureHeader(const QByteArray& data)
+{
+    return
+        (MagicSize <= static_cast<std::size_t>(data.size())) &&
+        (std::memcmp(data.constData(), Magic, MagicSize) == 0);
+}
+
+QByteArray MsgCaptureFile::header()
+{
+    QByteArray buf(Magic, static_cast<int>(MagicSize));
+    writeLittleEndian(buf, Version, sizeof(std::uint32_t));
+    writeLittleEndian(buf, 0U, sizeof(std::uint32_t));
+    assert(static_cast<std::size_t>(buf.size()) == HeaderSize);
+    return buf;
+}
+
+void MsgCaptureFile::appendRecord(
+    QByteArray& buf,
+    unsigned long long timestamp,
+    Message::Type type,
+    const QByteArray& id,
+    const Message::DataSeq& data,
+    const QByteArray& extraInfo)
+{
+    auto idLen = std::min(static_cast<std::size_t>(id.size()), static_cast<std::size_t>(0xffff));
+    auto recSize = RecordFixedLen + idLen + data.size() + static_cast<std::size_t>(extraInfo.size());
+    buf.reserve(buf.size() + static_cast<int>(RecordSizeFieldLen + recSize));
+
+    writeLittleEndian(buf, recSize, sizeof(std::uint32_t));
+    writeLittleEndian(buf, timestamp, sizeof(std::uint64_t));
+    writeLittleEndian(buf, static_cast<unsigned>(type), sizeof(std::uint8_t));
+    writeLittleEndian(buf, 0U, sizeof(std::uint8_t));
+    writeLittleEndian(buf, idLen, sizeof(std::uint16_t));
+    writeLittleEndian(buf, data.size(), sizeof(std::uint32_t));
+    writeLittleEndian(buf, extraInfo.size(), sizeof(std::uint32_t));
+    buf.append(id.constData(), static_cast<int>(idLen));
+    if (!data.empty()) {
+        buf.append(reinterpret_cast<const char*>(&data[0]), static_cast<int>(data.size()));
+    }
+    buf.append(extraInfo);
+}
+
+}  // namespace comms_champion
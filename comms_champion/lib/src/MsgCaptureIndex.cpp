@@ -0,0 +1,654 @@
+//
+// Copyright 2016 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "comms_champion/MsgCaptureIndex.h"
+
+#include <cassert>
+#include <cstring>
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+
+CC_DISABLE_WARNINGS()
+#include <QtCore/QFile>
+CC_ENABLE_WARNINGS()
+
+namespace comms_champion
+{
+
+namespace
+{
+
+const char Magic[] = "CCMSGIDX";
+const std::size_t MagicSize = sizeof(Magic) - 1;
+const std::uint32_t Version = 2U;
+const std::size_t HeaderSize = 40U;
+const std::size_t BlockSizeFieldLen = 4U;
+const std::size_t BlockFixedLen = 36U;
+const std::size_t IdFixedLen = 10U;
+
+template <typename T>
+T readLittleEndian(const std::uint8_t*& pos, std::size_t size)
+{
+    T value = 0;
+    for (auto idx = 0U; idx < size; ++idx) {
+        value |= static_cast<T>(static_cast<T>(pos[idx]) << (idx * 8U));
+    }
+    pos += size;
+    return value;
+}
+
+template <typename T>
+void writeLittleEndian(QByteArray& buf, T value, std::size_t size)
+{
+    for (auto idx = 0U; idx < size; ++idx) {
+        buf.append(static_cast<char>(static_cast<std::uint8_t>(value >> (idx * 8U))));
+    }
+}
+
+typedef std::vector<std::uint8_t> DeltasSeq;
+
+void appendDelta(DeltasSeq& deltas, unsigned long long value)
+{
+    while (0x80 <= value) {
+        deltas.push_back(static_cast<std::uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    deltas.push_back(static_cast<std::uint8_t>(value));
+}
+
+bool readDelta(const std::uint8_t*& pos, const std::uint8_t* end, unsigned long long& value)
+{
+    value = 0U;
+    unsigned shift = 0U;
+    while (pos < end) {
+        auto byte = *pos;
+        ++pos;
+        if (shift < 64U) {
+            value |= static_cast<unsigned long long>(byte & 0x7f) << shift;
+        }
+
+        if ((byte & 0x80) == 0U) {
+            return true;
+        }
+        shift += 7U;
+    }
+    return false;
+}
+
+struct Posting
+{
+    DeltasSeq m_deltas;
+    MsgCaptureIndex::Position m_last = 0U;
+    unsigned long long m_count = 0U;
+
+    void add(MsgCaptureIndex::Position pos)
+    {
+        assert(m_last <= pos);
+        appendDelta(m_deltas, pos - m_last);
+        m_last = pos;
+        ++m_count;
+    }
+};
+
+struct BlockInfo
+{
+    MsgCaptureIndex::Position m_begin = 0U;
+    MsgCaptureIndex::Position m_end = 0U;
+    unsigned long long m_minTimestamp = 0U;
+    unsigned long long m_maxTimestamp = 0U;
+};
+
+typedef std::unordered_map<std::string, Posting> PostingsMap;
+
+std::uint32_t recordChecksum(
+    MsgCaptureIndex::Position size,
+    unsigned long long timestamp,
+    const char* id,
+    std::size_t idLen)
+{
+    // FNV-1a
+    std::uint32_t hash = 2166136261U;
+    auto addByte =
+        [&hash](std::uint8_t byte)
+        {
+            hash ^= byte;
+            hash *= 16777619U;
+        };
+
+    for (auto idx = 0U; idx < sizeof(std::uint64_t); ++idx) {
+        addByte(static_cast<std::uint8_t>(size >> (idx * 8U)));
+    }
+
+    for (auto idx = 0U; idx < sizeof(std::uint64_t); ++idx) {
+        addByte(static_cast<std::uint8_t>(timestamp >> (idx * 8U)));
+    }
+
+    for (auto idx = 0U; idx < idLen; ++idx) {
+        addByte(static_cast<std::uint8_t>(id[idx]));
+    }
+    return hash;
+}
+
+// Identifies the capture the index belongs to: its header and checksum
+// of the first record
+QByteArray captureIdentity(std::uint32_t firstRecordChecksum)
+{
+    auto buf = MsgCaptureFile::header();
+    writeLittleEndian(buf, firstRecordChecksum, sizeof(std::uint32_t));
+    writeLittleEndian(buf, 0U, sizeof(std::uint32_t));
+    return buf;
+}
+
+QByteArray captureIdentity(MsgCaptureFile& capture)
+{
+    MsgCaptureFile::Record record;
+    if ((!capture.seek(MsgCaptureFile::HeaderSize)) || (!capture.readNext(record))) {
+        return captureIdentity(recordChecksum(0U, 0U, nullptr, 0U));
+    }
+
+    auto size = capture.position() - MsgCaptureFile::HeaderSize;
+    return captureIdentity(recordChecksum(size, record.m_timestamp, record.m_id, record.m_idLen));
+}
+
+}  // namespace
+
+class MsgCaptureIndexImpl
+{
+public:
+    typedef MsgCaptureIndex::Position Position;
+
+    ~MsgCaptureIndexImpl()
+    {
+        close();
+    }
+
+    bool open(const QString& captureFilename)
+    {
+        reset();
+
+        MsgCaptureFile capture;
+        if (!capture.open(captureFilename)) {
+            return false;
+        }
+
+        auto captureSize = static_cast<Position>(QFile(captureFilename).size());
+        auto indexFilename = MsgCaptureIndex::filenameFor(captureFilename);
+        auto identity = captureIdentity(capture);
+        m_lookupEnabled = true;
+        m_file.setFileName(indexFilename);
+        std::size_t validLen = 0U;
+        if (m_file.open(QIODevice::ReadOnly)) {
+            auto contents = m_file.readAll();
+            m_file.close();
+
+            validLen = load(contents, captureSize, identity);
+            if ((0U < validLen) && (validLen < static_cast<std::size_t>(contents.size()))) {
+                // Drop partially written block
+                QFile::resize(indexFilename, static_cast<qint64>(validLen));
+            }
+        }
+
+        if (0U < validLen) {
+            m_file.open(QIODevice::WriteOnly | QIODevice::Append);
+            m_headerWritten = true;
+        }
+        else if (openNewFile()) {
+            writeHeader(identity);
+        }
+
+        m_open = true;
+        if (!capture.seek(std::max(m_indexedEnd, static_cast<Position>(MsgCaptureFile::HeaderSize)))) {
+            return true;
+        }
+
+        MsgCaptureFile::Record record;
+        auto pos = capture.position();
+        while (capture.readNext(record)) {
+            auto end = capture.position();
+            addRecord(pos, end, record.m_timestamp, record.m_id, record.m_idLen);
+            pos = end;
+        }
+
+        finishBlock();
+        if (m_file.isOpen()) {
+            m_file.flush();
+        }
+        return true;
+    }
+
+    // The header is written when the first record is known
+    bool create(const QString& captureFilename)
+    {
+        reset();
+        m_lookupEnabled = false;
+        m_file.setFileName(MsgCaptureIndex::filenameFor(captureFilename));
+        m_open = openNewFile();
+        return m_open;
+    }
+
+    void close()
+    {
+        if (m_file.isOpen() && (!m_headerWritten)) {
+            writeHeader(captureIdentity(recordChecksum(0U, 0U, nullptr, 0U)));
+        }
+
+        finishBlock();
+        if (m_file.isOpen()) {
+            m_file.close();
+        }
+        m_open = false;
+    }
+
+    bool isOpen() const
+    {
+        return m_open;
+    }
+
+    void addRecord(
+        Position pos,
+        Position end,
+        unsigned long long timestamp,
+        const char* id,
+        std::size_t idLen)
+    {
+        if (m_file.isOpen() && (!m_headerWritten)) {
+            writeHeader(captureIdentity(recordChecksum(end - pos, timestamp, id, idLen)));
+        }
+
+        if (m_blockCount == 0U) {
+            m_block.m_begin = pos;
+            m_block.m_minTimestamp = timestamp;
+            m_block.m_maxTimestamp = timestamp;
+        }
+        else {
+            m_block.m_minTimestamp = std::min(m_block.m_minTimestamp, timestamp);
+            m_block.m_maxTimestamp = std::max(m_block.m_maxTimestamp, timestamp);
+        }
+
+        m_block.m_end = end;
+        ++m_blockCount;
+
+        m_key.assign(id, std::min(idLen, static_cast<std::size_t>(0xffff)));
+        auto& blockPosting = m_blockPostings[m_key];
+        if (blockPosting.m_count == 0U) {
+            blockPosting.m_last = m_block.m_begin;
+        }
+        blockPosting.add(pos);
+        if (m_lookupEnabled) {
+            m_postings[m_key].add(pos);
+        }
+
+        m_indexedEnd = end;
+        ++m_recordsCount;
+
+        if (m_blockSize <= m_blockCount) {
+            finishBlock();
+        }
+    }
+
+    Position indexedEnd() const
+    {
+        return m_indexedEnd;
+    }
+
+    unsigned long long recordsCount() const
+    {
+        return m_recordsCount;
+    }
+
+    MsgCaptureIndex::SpansList findTimeRange(
+        unsigned long long from,
+        unsigned long long to) const
+    {
+        MsgCaptureIndex::SpansList spans;
+        auto addBlock =
+            [&spans, from, to](const BlockInfo& block)
+            {
+                if ((to < block.m_minTimestamp) || (block.m_maxTimestamp < from)) {
+                    return;
+                }
+
+                if ((!spans.empty()) && (spans.back().m_end == block.m_begin)) {
+                    spans.back().m_end = block.m_end;
+                    return;
+                }
+
+                MsgCaptureIndex::Span span;
+                span.m_begin = block.m_begin;
+                span.m_end = block.m_end;
+                spans.push_back(span);
+            };
+
+        for (auto& block : m_blocks) {
+            addBlock(block);
+        }
+
+        if (0U < m_blockCount) {
+            addBlock(m_block);
+        }
+        return spans;
+    }
+
+    MsgCaptureIndex::PositionsList findId(const QByteArray& id) const
+    {
+        MsgCaptureIndex::PositionsList positions;
+        auto iter = m_postings.find(std::string(id.constData(), static_cast<std::size_t>(id.size())));
+        if (iter == m_postings.end()) {
+            return positions;
+        }
+
+        auto& posting = iter->second;
+        positions.reserve(static_cast<std::size_t>(posting.m_count));
+        auto* pos = posting.m_deltas.data();
+        auto* end = pos + posting.m_deltas.size();
+        Position value = 0U;
+        unsigned long long delta = 0U;
+        while (readDelta(pos, end, delta)) {
+            value += delta;
+            positions.push_back(value);
+        }
+        return positions;
+    }
+
+    std::size_t m_blockSize = MsgCaptureIndex::DefaultBlockSize;
+
+private:
+    void reset()
+    {
+        close();
+        m_blocks.clear();
+        m_postings.clear();
+        m_blockPostings.clear();
+        m_block = BlockInfo();
+        m_blockCount = 0U;
+        m_indexedEnd = 0U;
+        m_recordsCount = 0U;
+        m_headerWritten = false;
+    }
+
+    bool openNewFile()
+    {
+        return m_file.open(QIODevice::WriteOnly | QIODevice::Truncate);
+    }
+
+    void writeHeader(const QByteArray& identity)
+    {
+        QByteArray buf(Magic, static_cast<int>(MagicSize));
+        writeLittleEndian(buf, Version, sizeof(std::uint32_t));
+        writeLittleEndian(buf, 0U, sizeof(std::uint32_t));
+        buf.append(identity);
+        assert(static_cast<std::size_t>(buf.size()) == HeaderSize);
+        m_file.write(buf);
+        m_headerWritten = true;
+    }
+
+    // Returns length of the valid contents, 0 when the header is invalid
+    // or belongs to another capture
+    std::size_t load(const QByteArray& contents, Position captureSize, const QByteArray& identity)
+    {
+        auto* begin = reinterpret_cast<const std::uint8_t*>(contents.constData());
+        auto* end = begin + contents.size();
+        if ((static_cast<std::size_t>(contents.size()) < HeaderSize) ||
+            (std::memcmp(begin, Magic, MagicSize) != 0)) {
+            return 0U;
+        }
+
+        auto* pos = begin + MagicSize;
+        if (readLittleEndian<std::uint32_t>(pos, sizeof(std::uint32_t)) != Version) {
+            return 0U;
+        }
+
+        pos += sizeof(std::uint32_t);
+        auto identityLen = static_cast<std::size_t>(identity.size());
+        assert((HeaderSize - identityLen) == static_cast<std::size_t>(pos - begin));
+        if (std::memcmp(pos, identity.constData(), identityLen) != 0) {
+            return 0U;
+        }
+
+        pos = begin + HeaderSize;
+        auto expectedBegin = static_cast<Position>(MsgCaptureFile::HeaderSize);
+        while (static_cast<std::size_t>(end - pos) >= (BlockSizeFieldLen + BlockFixedLen)) {
+            auto* blockPos = pos;
+            auto blockSize = readLittleEndian<std::uint32_t>(blockPos, sizeof(std::uint32_t));
+            if ((blockSize < BlockFixedLen) ||
+                (static_cast<std::size_t>(end - blockPos) < blockSize)) {
+                break;
+            }
+
+            auto* blockEnd = blockPos + blockSize;
+            BlockInfo block;
+            block.m_begin = readLittleEndian<std::uint64_t>(blockPos, sizeof(std::uint64_t));
+            block.m_end = readLittleEndian<std::uint64_t>(blockPos, sizeof(std::uint64_t));
+            block.m_minTimestamp = readLittleEndian<std::uint64_t>(blockPos, sizeof(std::uint64_t));
+            block.m_maxTimestamp = readLittleEndian<std::uint64_t>(blockPos, sizeof(std::uint64_t));
+            auto idsCount = readLittleEndian<std::uint32_t>(blockPos, sizeof(std::uint32_t));
+            if ((block.m_begin != expectedBegin) ||
+                (block.m_end < block.m_begin) ||
+                (captureSize < block.m_end)) {
+                break;
+            }
+
+            if (!loadBlockPostings(blockPos, blockEnd, idsCount, block)) {
+                break;
+            }
+
+            m_blocks.push_back(block);
+            m_indexedEnd = block.m_end;
+            expectedBegin = block.m_end;
+            pos = blockEnd;
+        }
+
+        return static_cast<std::size_t>(pos - begin);
+    }
+
+    bool loadBlockPostings(
+        const std::uint8_t* pos,
+        const std::uint8_t* end,
+        unsigned idsCount,
+        const BlockInfo& block)
+    {
+        // Parsed separately to leave the index untouched on error
+        typedef std::vector<std::pair<std::string, PositionsList> > BlockPostings;
+        BlockPostings postings;
+        postings.reserve(idsCount);
+        for (auto idx = 0U; idx < idsCount; ++idx) {
+            if (static_cast<std::size_t>(end - pos) < IdFixedLen) {
+                return false;
+            }
+
+            auto idLen = readLittleEndian<std::uint16_t>(pos, sizeof(std::uint16_t));
+            if (static_cast<std::size_t>(end - pos) < idLen + 8U) {
+                return false;
+            }
+
+            postings.emplace_back(std::string(reinterpret_cast<const char*>(pos), idLen), PositionsList());
+            pos += idLen;
+            auto count = readLittleEndian<std::uint32_t>(pos, sizeof(std::uint32_t));
+            auto deltasLen = readLittleEndian<std::uint32_t>(pos, sizeof(std::uint32_t));
+            if (static_cast<std::size_t>(end - pos) < deltasLen) {
+                return false;
+            }
+
+            auto* deltasEnd = pos + deltasLen;
+            auto& positions = postings.back().second;
+            positions.reserve(count);
+            Position value = block.m_begin;
+            unsigned long long delta = 0U;
+            while (readDelta(pos, deltasEnd, delta)) {
+                value += delta;
+                if ((value < block.m_begin) || (block.m_end <= value)) {
+                    return false;
+                }
+                positions.push_back(value);
+            }
+
+            if (positions.size() != count) {
+                return false;
+            }
+        }
+
+        for (auto& blockPosting : postings) {
+            auto& posting = m_postings[blockPosting.first];
+            for (auto value : blockPosting.second) {
+                posting.add(value);
+            }
+            m_recordsCount += blockPosting.second.size();
+        }
+        return true;
+    }
+
+    void finishBlock()
+    {
+        if (m_blockCount == 0U) {
+            return;
+        }
+
+        if (m_lookupEnabled) {
+            m_blocks.push_back(m_block);
+        }
+
+        if (m_file.isOpen()) {
+            writeBlock();
+        }
+
+        m_blockPostings.clear();
+        m_blockCount = 0U;
+    }
+
+    void writeBlock()
+    {
+        auto& buf = m_writeBuf;
+        buf.resize(0);
+        writeLittleEndian(buf, 0U, BlockSizeFieldLen); // updated below
+        writeLittleEndian(buf, m_block.m_begin, sizeof(std::uint64_t));
+        writeLittleEndian(buf, m_block.m_end, sizeof(std::uint64_t));
+        writeLittleEndian(buf, m_block.m_minTimestamp, sizeof(std::uint64_t));
+        writeLittleEndian(buf, m_block.m_maxTimestamp, sizeof(std::uint64_t));
+        writeLittleEndian(buf, m_blockPostings.size(), sizeof(std::uint32_t));
+        for (auto& elem : m_blockPostings) {
+            auto& posting = elem.second;
+            writeLittleEndian(buf, elem.first.size(), sizeof(std::uint16_t));
+            buf.append(elem.first.data(), static_cast<int>(elem.first.size()));
+            writeLittleEndian(buf, posting.m_count, sizeof(std::uint32_t));
+            writeLittleEndian(buf, posting.m_deltas.size(), sizeof(std::uint32_t));
+            if (!posting.m_deltas.empty()) {
+                buf.append(
+                    reinterpret_cast<const char*>(&posting.m_deltas[0]),
+                    static_cast<int>(posting.m_deltas.size()));
+            }
+        }
+
+        auto blockSize = static_cast<std::uint32_t>(static_cast<std::size_t>(buf.size()) - BlockSizeFieldLen);
+        for (auto idx = 0U; idx < BlockSizeFieldLen; ++idx) {
+            buf[static_cast<int>(idx)] = static_cast<char>(static_cast<std::uint8_t>(blockSize >> (idx * 8U)));
+        }
+        m_file.write(buf);
+    }
+
+    typedef MsgCaptureIndex::PositionsList PositionsList;
+
+    QFile m_file;
+    bool m_open = false;
+    bool m_headerWritten = false;
+    bool m_lookupEnabled = true;
+    std::vector<BlockInfo> m_blocks;
+    PostingsMap m_postings;
+    PostingsMap m_blockPostings;
+    BlockInfo m_block;
+    std::size_t m_blockCount = 0U;
+    Position m_indexedEnd = 0U;
+    unsigned long long m_recordsCount = 0U;
+    std::string m_key;
+    QByteArray m_writeBuf;
+};
+
+MsgCaptureIndex::MsgCaptureIndex()
+  : m_impl(new MsgCaptureIndexImpl())
+{
+}
+
+MsgCaptureIndex::~MsgCaptureIndex() = default;
+
+void MsgCaptureIndex::setBlockSize(std::size_t value)
+{
+    m_impl->m_blockSize = std::max(value, static_cast<std::size_t>(1U));
+}
+
+std::size_t MsgCaptureIndex::getBlockSize() const
+{
+    return m_impl->m_blockSize;
+}
+
+bool MsgCaptureIndex::open(const QString& captureFilename)
+{
+    return m_impl->open(captureFilename);
+}
+
+bool MsgCaptureIndex::create(const QString& captureFilename)
+{
+    return m_impl->create(captureFilename);
+}
+
+void MsgCaptureIndex::close()
+{
+    m_impl->close();
+}
+
+bool MsgCaptureIndex::isOpen() const
+{
+    return m_impl->isOpen();
+}
+
+void MsgCaptureIndex::addRecord(
+    Position pos,
+    Position end,
+    unsigned long long timestamp,
+    const char* id,
+    std::size_t idLen)
+{
+    m_impl->addRecord(pos, end, timestamp, id, idLen);
+}
+
+MsgCaptureIndex::Position MsgCaptureIndex::indexedEnd() const
+{
+    return m_impl->indexedEnd();
+}
+
+unsigned long long MsgCaptureIndex::recordsCount() const
+{
+    return m_impl->recordsCount();
+}
+
+MsgCaptureIndex::SpansList MsgCaptureIndex::findTimeRange(
+    unsigned long long from,
+    unsigned long long to) const
+{
+    return m_impl->findTimeRange(from, to);
+}
+
+MsgCaptureIndex::PositionsList MsgCaptureIndex::findId(const QByteArray& id) const
+{
+    return m_impl->findId(id);
+}
+
+QString MsgCaptureIndex::filenameFor(const QString& captureFilename)
+{
+    return captureFilename + ".idx";
+}
+
+}  // namespace comms_champion
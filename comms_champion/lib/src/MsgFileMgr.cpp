@@ -21,6 +21,8 @@
 #include <algorithm>
 #include <iterator>
 #include <iostream>
+#include <set>
+#include <chrono>
 
 #include "comms/CompileControl.h"
 
@@ -31,6 +33,12 @@ CC_DISABLE_WARNINGS()
 #include <QtCore/QVariantMap>
 CC_ENABLE_WARNINGS()
 
+#include "comms_champion/HexCodec.h"
+#include "comms_champion/MsgCaptureFile.h"
+#include "comms_champion/MsgCaptureIndex.h"
+#include "comms_champion/MsgFileStreamReader.h"
+#include "comms_champion/PcapReader.h"
+#include "comms_champion/PcapWriter.h"
 #include "comms_champion/property/message.h"
 
 namespace comms_champion
@@ -170,88 +178,41 @@ const QString ExtraPropsProp::Name("extra_info");
 const QByteArray ExtraPropsProp::PropName = ExtraPropsProp::Name.toUtf8();
 
 
-QString encodeMsgData(const Message& msg)
+Message::DataSeq getMsgData(const Message& msg)
 {
-    Message::DataSeq msgData;
-    do {
-        if (!msg.idAsString().isEmpty()) {
-            msgData = msg.encodeData();
-            break;
-        }
-
-        auto rawDataMsg = property::message::RawDataMsg().getFrom(msg);
-        if (!rawDataMsg) {
-            break;
-        }
-
-        msgData = rawDataMsg->encodeData();
-    } while (false);
+    if (!msg.idAsString().isEmpty()) {
+        return msg.encodeData();
+    }
 
-    QString msgDataStr;
-    for (auto dataByte : msgData) {
-        if (!msgDataStr.isEmpty()) {
-            msgDataStr.append(' ');
-        }
-        msgDataStr.append(
-            QString("%1").arg(
-                static_cast<unsigned>(dataByte), 2, 16, QChar('0')));
+    auto rawDataMsg = property::message::RawDataMsg().getFrom(msg);
+    if (!rawDataMsg) {
+        return Message::DataSeq();
     }
 
-    return msgDataStr;
+    return rawDataMsg->encodeData();
 }
 
-MessagePtr createMsgObjectFrom(
-    const QVariant& msgMapVar,
-    Protocol& protocol)
+QString encodeMsgData(const Message::DataSeq& msgData)
 {
-    if ((!msgMapVar.isValid()) || (!msgMapVar.canConvert<QVariantMap>())) {
-        return MessagePtr();
-    }
-
-    auto msgMap = msgMapVar.value<QVariantMap>();
-    auto msgId = IdProp().getFrom(msgMap);
-    auto dataStr = DataProp().getFrom(msgMap);
-
-    if (msgId.isEmpty() && dataStr.isEmpty()) {
-        return MessagePtr();
-    }
-
-    QString stripedDataStr;
-    stripedDataStr.reserve(dataStr.size());
-    std::copy_if(
-        dataStr.begin(), dataStr.end(), std::back_inserter(stripedDataStr),
-        [](QChar ch) -> bool
-        {
-            return
-                ch.isDigit() ||
-                ((QChar('A') <= ch) && (ch <= QChar('F'))) ||
-                ((QChar('a') <= ch) && (ch <= QChar('f')));
-        });
-
-    if ((stripedDataStr.size() & 0x1) != 0) {
-        stripedDataStr.prepend(QChar('0'));
-    }
-
-    Message::DataSeq data;
-    QString num;
-    for (auto ch : stripedDataStr) {
-        num.append(ch);
-        if (num.size() == 1) {
-            continue;
-        }
+    return encodeHex(msgData, ' ');
+}
 
-        assert(num.size() == 2);
-        bool ok = false;
-        auto byte = num.toInt(&ok, 16);
-        static_cast<void>(ok);
-        assert(ok);
-        assert((0 <= byte) && (byte <= 0xff));
-        data.push_back(static_cast<Message::DataSeq::value_type>(byte));
-        num.clear();
-    }
+QString encodeMsgData(const Message& msg)
+{
+    return encodeMsgData(getMsgData(msg));
+}
 
-    auto extraInfo = ExtraPropsProp().getFrom(msgMap);
+Message::DataSeq decodeMsgData(const QString& dataStr)
+{
+    return decodeHex(dataStr, HexDecodeMode::PadFront);
+}
 
+MessagePtr createMsgObject(
+    const QString& msgId,
+    const Message::DataSeq& data,
+    QVariantMap extraInfo,
+    Protocol& protocol)
+{
     MessagePtr msg;
     if (msgId.isEmpty()) {
         msg = protocol.createInvalidMessage(data);
@@ -292,30 +253,77 @@ MessagePtr createMsgObjectFrom(
     return msg;
 }
 
-QVariantMap convertRecvMsg(const Message& msg)
+MessagePtr createMsgObjectFrom(
+    const QVariant& msgMapVar,
+    Protocol& protocol)
 {
-    QVariantMap msgInfoMap;
-    auto idStr = msg.idAsString();
-    auto dataStr = encodeMsgData(msg);
-    if (idStr.isEmpty() && dataStr.isEmpty()) {
-        return msgInfoMap;
+    if ((!msgMapVar.isValid()) || (!msgMapVar.canConvert<QVariantMap>())) {
+        return MessagePtr();
+    }
+
+    auto msgMap = msgMapVar.value<QVariantMap>();
+    auto msgId = IdProp().getFrom(msgMap);
+    auto dataStr = DataProp().getFrom(msgMap);
+
+    if (msgId.isEmpty() && dataStr.isEmpty()) {
+        return MessagePtr();
+    }
+
+    return
+        createMsgObject(
+            msgId,
+            decodeMsgData(dataStr),
+            ExtraPropsProp().getFrom(msgMap),
+            protocol);
+}
+
+MessagePtr createMsgObjectFrom(
+    const MsgCaptureFile::Record& record,
+    Protocol& protocol)
+{
+    auto msgId = QString::fromUtf8(record.m_id, static_cast<int>(record.m_idLen));
+    if (msgId.isEmpty() && (record.m_dataLen == 0U)) {
+        return MessagePtr();
+    }
+
+    Message::DataSeq data(record.m_data, record.m_data + record.m_dataLen);
+    QVariantMap extraInfo;
+    if (0U < record.m_extraInfoLen) {
+        auto extraInfoData =
+            QByteArray::fromRawData(record.m_extraInfo, static_cast<int>(record.m_extraInfoLen));
+        extraInfo = QJsonDocument::fromJson(extraInfoData).object().toVariantMap();
     }
 
-    if (!idStr.isEmpty()) {
-        IdProp().setTo(std::move(idStr), msgInfoMap);
+    return createMsgObject(msgId, data, std::move(extraInfo), protocol);
+}
+
+QVariantMap convertRecvMsg(const MsgFileMgr::RecvSaveEntry& entry)
+{
+    QVariantMap msgInfoMap;
+    if (!entry.m_id.isEmpty()) {
+        IdProp().setTo(entry.m_id, msgInfoMap);
     }
-    DataProp().setTo(std::move(dataStr), msgInfoMap);
-    TimestampProp().setTo(property::message::Timestamp().getFrom(msg), msgInfoMap);
-    TypeProp().setTo(static_cast<unsigned>(property::message::Type().getFrom(msg)), msgInfoMap);
+    DataProp().setTo(encodeMsgData(entry.m_data), msgInfoMap);
+    TimestampProp().setTo(entry.m_timestamp, msgInfoMap);
+    TypeProp().setTo(static_cast<unsigned>(entry.m_type), msgInfoMap);
 
-    auto extraInfo = property::message::ExtraInfo().getFrom(msg);
-    if (!extraInfo.isEmpty()) {
-        ExtraPropsProp().setTo(std::move(extraInfo), msgInfoMap);
+    if (!entry.m_extraInfo.isEmpty()) {
+        ExtraPropsProp().setTo(entry.m_extraInfo, msgInfoMap);
     }
 
     return msgInfoMap;
 }
 
+QVariantMap convertRecvMsg(const Message& msg)
+{
+    MsgFileMgr::RecvSaveEntry entry;
+    if (!MsgFileMgr::snapshotRecvMsg(msg, entry)) {
+        return QVariantMap();
+    }
+
+    return convertRecvMsg(entry);
+}
+
 QVariantList convertRecvMsgList(
     const MsgFileMgr::MessagesList& allMsgs)
 {
@@ -336,35 +344,29 @@ QVariantList convertRecvMsgList(
     return convertedList;
 }
 
-MsgFileMgr::MessagesList convertRecvMsgList(
-    const QVariantList& msgs,
+MessagePtr createRecvMsgObjectFrom(
+    const QVariant& msgMapVar,
     Protocol& protocol)
 {
-    MsgFileMgr::MessagesList convertedList;
-
-    for (auto& msgMapVar : msgs) {
-        auto msg = createMsgObjectFrom(msgMapVar, protocol);
-        if (!msg) {
-            continue;
-        }
-
-        assert(msgMapVar.isValid() && msgMapVar.canConvert<QVariantMap>());
+    auto msg = createMsgObjectFrom(msgMapVar, protocol);
+    if (!msg) {
+        return msg;
+    }
 
-        auto msgMap = msgMapVar.value<QVariantMap>();
-        auto timestamp = TimestampProp().getFrom(msgMap);
-        if (timestamp == 0) {
-            // Not a receive list, skip message
-            continue;
-        }
+    assert(msgMapVar.isValid() && msgMapVar.canConvert<QVariantMap>());
 
-        auto type = static_cast<Message::Type>(TypeProp().getFrom(msgMap));
+    auto msgMap = msgMapVar.value<QVariantMap>();
+    auto timestamp = TimestampProp().getFrom(msgMap);
+    if (timestamp == 0) {
+        // Not a receive list, skip message
+        return MessagePtr();
+    }
 
-        property::message::Timestamp().setTo(timestamp, *msg);
-        property::message::Type().setTo(type, *msg);
+    auto type = static_cast<Message::Type>(TypeProp().getFrom(msgMap));
 
-        convertedList.push_back(std::move(msg));
-    }
-    return convertedList;
+    property::message::Timestamp().setTo(timestamp, *msg);
+    property::message::Type().setTo(type, *msg);
+    return msg;
 }
 
 QVariantList convertSendMsgList(
@@ -386,7 +388,7 @@ QVariantList convertSendMsgList(
         RepeatUnitsProp().setTo(property::message::RepeatDurationUnits().getFrom(*msg), msgInfoMap);
         RepeatCountProp().setTo(property::message::RepeatCount().getFrom(*msg), msgInfoMap);
 
-        auto extraInfo = property::message::ExtraInfo().getFrom(*msg);
+        auto extraInfo = Protocol::getExtraInfo(*msg);
         if (!extraInfo.isEmpty()) {
             ExtraPropsProp().setTo(std::move(extraInfo), msgInfoMap);
         }
@@ -396,88 +398,259 @@ QVariantList convertSendMsgList(
     return convertedList;
 }
 
-MsgFileMgr::MessagesList convertSendMsgList(
-    const QVariantList& msgs,
+MessagePtr createSendMsgObjectFrom(
+    const QVariant& msgMapVar,
+    Protocol& protocol,
+    unsigned long long& prevTimestamp)
+{
+    auto msg = createMsgObjectFrom(msgMapVar, protocol);
+    if (!msg) {
+        return msg;
+    }
+
+    assert(msgMapVar.isValid() && msgMapVar.canConvert<QVariantMap>());
+
+    auto msgMap = msgMapVar.value<QVariantMap>();
+    auto delay = DelayProp().getFrom(msgMap);
+    auto delayUnits = DelayUnitsProp().getFrom(msgMap);
+    auto repeatDuration = RepeatProp().getFrom(msgMap);
+    auto repeatDurationUnits = RepeatUnitsProp().getFrom(msgMap);
+    auto repeatCount = RepeatCountProp().getFrom(msgMap);
+
+    if ((repeatDuration == 0) && (repeatCount == 0)) {
+        repeatCount = 1;
+
+        do {
+            if (delay != 0) {
+                break;
+            }
+
+            // Probably receive list is loaded
+            auto timestamp = TimestampProp().getFrom(msgMap);
+            if (timestamp == 0) {
+                break;
+            }
+
+            if (prevTimestamp == 0) {
+                prevTimestamp = timestamp;
+            }
+
+            auto delayTmp = timestamp - prevTimestamp;
+            if (delayTmp <= 0) {
+                break;
+            }
+
+            prevTimestamp = timestamp;
+            delay = delayTmp;
+        } while (false);
+    }
+
+    property::message::Delay().setTo(delay, *msg);
+    property::message::DelayUnits().setTo(std::move(delayUnits), *msg);
+    property::message::RepeatDuration().setTo(repeatDuration, *msg);
+    property::message::RepeatDurationUnits().setTo(std::move(repeatDurationUnits), *msg);
+    property::message::RepeatCount().setTo(repeatCount, *msg);
+    return msg;
+}
+
+QVariantList convertMsgList(
+    MsgFileMgr::Type type,
+    const MsgFileMgr::MessagesList& allMsgs)
+{
+    if (type == MsgFileMgr::Type::Recv) {
+        return convertRecvMsgList(allMsgs);
+    }
+
+    return convertSendMsgList(allMsgs);
+}
+
+MessagePtr createRecvMsgObjectFrom(
+    const MsgCaptureFile::Record& record,
     Protocol& protocol)
 {
-    MsgFileMgr::MessagesList convertedList;
-    unsigned long long prevTimestamp = 0;
+    if (record.m_timestamp == 0) {
+        return MessagePtr();
+    }
 
-    for (auto& msgMapVar : msgs) {
-        auto msg = createMsgObjectFrom(msgMapVar, protocol);
-        if (!msg) {
-            continue;
-        }
+    auto msg = createMsgObjectFrom(record, protocol);
+    if (!msg) {
+        return msg;
+    }
 
-        assert(msgMapVar.isValid() && msgMapVar.canConvert<QVariantMap>());
+    property::message::Timestamp().setTo(record.m_timestamp, *msg);
+    property::message::Type().setTo(record.m_type, *msg);
+    return msg;
+}
 
-        auto msgMap = msgMapVar.value<QVariantMap>();
-        auto delay = DelayProp().getFrom(msgMap);
-        auto delayUnits = DelayUnitsProp().getFrom(msgMap);
-        auto repeatDuration = RepeatProp().getFrom(msgMap);
-        auto repeatDurationUnits = RepeatUnitsProp().getFrom(msgMap);
-        auto repeatCount = RepeatCountProp().getFrom(msgMap);
+void setRecordedSendDelay(
+    Message& msg,
+    unsigned long long timestamp,
+    unsigned long long& prevTimestamp)
+{
+    unsigned long long delay = 0;
+    if (prevTimestamp == 0) {
+        prevTimestamp = timestamp;
+    }
 
-        if ((repeatDuration == 0) && (repeatCount == 0)) {
-            repeatCount = 1;
+    if (prevTimestamp < timestamp) {
+        delay = timestamp - prevTimestamp;
+        prevTimestamp = timestamp;
+    }
 
-            do {
-                if (delay != 0) {
-                    break;
-                }
+    property::message::Delay().setTo(delay, msg);
+    property::message::RepeatDuration().setTo(0, msg);
+    property::message::RepeatCount().setTo(1, msg);
+}
 
-                // Probably receive list is loaded
-                auto timestamp = TimestampProp().getFrom(msgMap);
-                if (timestamp == 0) {
-                    break;
-                }
+MessagePtr createSendMsgObjectFrom(
+    const MsgCaptureFile::Record& record,
+    Protocol& protocol,
+    unsigned long long& prevTimestamp)
+{
+    auto msg = createMsgObjectFrom(record, protocol);
+    if (!msg) {
+        return msg;
+    }
 
-                if (prevTimestamp == 0) {
-                    prevTimestamp = timestamp;
-                }
+    setRecordedSendDelay(*msg, record.m_timestamp, prevTimestamp);
+    return msg;
+}
 
-                auto delayTmp = timestamp - prevTimestamp;
-                if (delayTmp <= 0) {
-                    break;
-                }
+Message::DataSeq getFrameData(Message& msg, Protocol& protocol)
+{
+    if (msg.idAsString().isEmpty()) {
+        return getMsgData(msg);
+    }
 
-                prevTimestamp = timestamp;
-                delay = delayTmp;
-            } while (false);
+    auto dataInfo = protocol.write(msg);
+    if (!dataInfo) {
+        return Message::DataSeq();
+    }
+
+    return dataInfo->m_data;
+}
+
+class LoadBatcher
+{
+public:
+    LoadBatcher(
+        MsgFileMgr::LoadBatchCallback& callback,
+        std::size_t batchSize)
+      : m_callback(callback),
+        m_batchSize(std::max(batchSize, static_cast<std::size_t>(1U)))
+    {
+    }
+
+    void add(MessagePtr msg)
+    {
+        if (!msg) {
+            return;
+        }
+
+        m_batch.push_back(std::move(msg));
+        if (m_batchSize <= m_batch.size()) {
+            flush();
         }
+    }
 
-        property::message::Delay().setTo(delay, *msg);
-        property::message::DelayUnits().setTo(std::move(delayUnits), *msg);
-        property::message::RepeatDuration().setTo(repeatDuration, *msg);
-        property::message::RepeatDurationUnits().setTo(std::move(repeatDurationUnits), *msg);
-        property::message::RepeatCount().setTo(repeatCount, *msg);
+    void flush()
+    {
+        if (m_batch.empty()) {
+            return;
+        }
 
-        convertedList.push_back(std::move(msg));
+        MsgFileMgr::MessagesList batch;
+        batch.swap(m_batch);
+        m_callback(std::move(batch));
     }
-    return convertedList;
-}
 
-QVariantList convertMsgList(
+private:
+    MsgFileMgr::LoadBatchCallback& m_callback;
+    std::size_t m_batchSize = 0U;
+    MsgFileMgr::MessagesList m_batch;
+};
+
+void addCaptureRecord(
     MsgFileMgr::Type type,
-    const MsgFileMgr::MessagesList& allMsgs)
+    const MsgCaptureFile::Record& record,
+    Protocol& protocol,
+    unsigned long long& prevTimestamp,
+    LoadBatcher& batcher)
 {
     if (type == MsgFileMgr::Type::Recv) {
-        return convertRecvMsgList(allMsgs);
+        batcher.add(createRecvMsgObjectFrom(record, protocol));
     }
+    else {
+        batcher.add(createSendMsgObjectFrom(record, protocol, prevTimestamp));
+    }
+}
 
-    return convertSendMsgList(allMsgs);
+bool openIndexedCapture(
+    const QString& filename,
+    MsgCaptureFile& capture,
+    MsgCaptureIndex& index)
+{
+    if (!capture.open(filename)) {
+        return false;
+    }
+
+    if (!index.open(filename)) {
+        capture.close();
+        return false;
+    }
+
+    // Only the loaded index is needed for the queries
+    index.close();
+    return true;
 }
 
-MsgFileMgr::MessagesList convertMsgList(
+bool loadPcapMsgs(
     MsgFileMgr::Type type,
-    const QVariantList& msgs,
-    Protocol& protocol)
+    const QString& filename,
+    Protocol& protocol,
+    LoadBatcher& batcher)
 {
-    if (type == MsgFileMgr::Type::Recv) {
-        return convertRecvMsgList(msgs, protocol);
+    PcapReader reader;
+    if (!reader.open(filename)) {
+        std::cerr << "ERROR: " << reader.errorString().toStdString() << std::endl;
+        return false;
+    }
+
+    std::set<DataInfo::StreamId> streams;
+    unsigned long long prevTimestamp = 0;
+    PcapReader::Record record;
+    DataInfo dataInfo;
+    while (reader.readNext(record)) {
+        dataInfo.m_timestamp =
+            DataInfo::Timestamp(
+                std::chrono::duration_cast<DataInfo::Timestamp::duration>(
+                    std::chrono::microseconds(record.m_timestampUs)));
+        dataInfo.m_data.assign(record.m_data, record.m_data + record.m_dataLen);
+        dataInfo.m_streamId = record.m_streamId;
+        streams.insert(record.m_streamId);
+
+        auto msgs = protocol.read(dataInfo);
+        auto timestamp = record.m_timestampUs / 1000U;
+        for (auto& msg : msgs) {
+            assert(msg);
+            property::message::Timestamp().setTo(timestamp, *msg);
+            property::message::Type().setTo(Message::Type::Received, *msg);
+            if (type == MsgFileMgr::Type::Send) {
+                setRecordedSendDelay(*msg, timestamp, prevTimestamp);
+            }
+            batcher.add(std::move(msg));
+        }
     }
 
-    return convertSendMsgList(msgs, protocol);
+    for (auto streamId : streams) {
+        protocol.closeStream(streamId);
+    }
+
+    if (reader.hasError()) {
+        std::cerr << "ERROR: " << reader.errorString().toStdString() << std::endl;
+        return false;
+    }
+    return true;
 }
 
 }  // namespace
@@ -500,35 +673,195 @@ MsgFileMgr::MessagesList MsgFileMgr::load(
     Protocol& protocol)
 {
     MessagesList allMsgs;
-    do {
+    bool result =
+        loadStreamed(
+            type,
+            filename,
+            protocol,
+            [&allMsgs](MessagesList&& msgs)
+            {
+                allMsgs.splice(allMsgs.end(), msgs);
+            });
+
+    if (!result) {
+        allMsgs.clear();
+    }
+
+    return allMsgs;
+}
+
+bool MsgFileMgr::loadStreamed(
+    Type type,
+    const QString& filename,
+    Protocol& protocol,
+    LoadBatchCallback callback,
+    std::size_t batchSize)
+{
+    assert(callback);
+    QByteArray header;
+    {
         QFile msgsFile(filename);
         if (!msgsFile.open(QIODevice::ReadOnly)) {
             std::cerr << "ERROR: Failed to load the file " <<
                 filename.toStdString() << std::endl;
-            break;
+            return false;
         }
 
-        auto data = msgsFile.readAll();
+        header = msgsFile.peek(MsgCaptureFile::HeaderSize);
+    }
 
-        auto jsonError = QJsonParseError();
-        auto jsonDoc = QJsonDocument::fromJson(data, &jsonError);
-        if (jsonError.error != QJsonParseError::NoError) {
+    LoadBatcher batcher(callback, batchSize);
+    unsigned long long prevTimestamp = 0;
+    if (PcapReader::isPcapHeader(header)) {
+        if (!loadPcapMsgs(type, filename, protocol, batcher)) {
+            batcher.flush();
+            return false;
+        }
+    }
+    else if (MsgCaptureFile::isCaptureHeader(header)) {
+        MsgCaptureFile capture;
+        if (!capture.open(filename)) {
             std::cerr << "ERROR: Invalid contents of messages file!" << std::endl;
-            break;
+            return false;
+        }
+
+        MsgCaptureFile::Record record;
+        while (capture.readNext(record)) {
+            addCaptureRecord(type, record, protocol, prevTimestamp, batcher);
+        }
+    }
+    else {
+        MsgFileStreamReader reader;
+        if (!reader.open(filename)) {
+            std::cerr << "ERROR: Failed to load the file " <<
+                filename.toStdString() << std::endl;
+            return false;
+        }
+
+        QVariantMap msgMap;
+        while (reader.readNext(msgMap)) {
+            auto msgMapVar = QVariant::fromValue(msgMap);
+            if (type == Type::Recv) {
+                batcher.add(createRecvMsgObjectFrom(msgMapVar, protocol));
+            }
+            else {
+                batcher.add(createSendMsgObjectFrom(msgMapVar, protocol, prevTimestamp));
+            }
         }
 
-        if (!jsonDoc.isArray()) {
+        if (reader.hasError()) {
+            batcher.flush();
             std::cerr << "ERROR: Invalid contents of messages file!" << std::endl;
-            break;
+            return false;
         }
+    }
 
-        auto topArray = jsonDoc.array();
-        auto varList = topArray.toVariantList();
-        allMsgs = convertMsgList(type, varList, protocol);
-        m_lastFile = filename;
-    } while (false);
+    batcher.flush();
+    m_lastFile = filename;
+    return true;
+}
 
-    return allMsgs;
+bool MsgFileMgr::loadTimeRange(
+    Type type,
+    const QString& filename,
+    Protocol& protocol,
+    unsigned long long fromTimestamp,
+    unsigned long long toTimestamp,
+    LoadBatchCallback callback,
+    std::size_t batchSize)
+{
+    assert(callback);
+    auto inRange =
+        [fromTimestamp, toTimestamp](unsigned long long timestamp) -> bool
+        {
+            return (fromTimestamp <= timestamp) && (timestamp <= toTimestamp);
+        };
+
+    MsgCaptureFile capture;
+    MsgCaptureIndex index;
+    if (!openIndexedCapture(filename, capture, index)) {
+        return
+            loadStreamed(
+                type,
+                filename,
+                protocol,
+                [&callback, &inRange](MessagesList&& msgs)
+                {
+                    msgs.remove_if(
+                        [&inRange](const MessagePtr& msg) -> bool
+                        {
+                            return !inRange(property::message::Timestamp().getFrom(*msg));
+                        });
+
+                    if (!msgs.empty()) {
+                        callback(std::move(msgs));
+                    }
+                },
+                batchSize);
+    }
+
+    LoadBatcher batcher(callback, batchSize);
+    unsigned long long prevTimestamp = 0;
+    MsgCaptureFile::Record record;
+    for (auto& span : index.findTimeRange(fromTimestamp, toTimestamp)) {
+        if (!capture.seek(span.m_begin)) {
+            continue;
+        }
+
+        while ((capture.position() < span.m_end) && capture.readNext(record)) {
+            if (inRange(record.m_timestamp)) {
+                addCaptureRecord(type, record, protocol, prevTimestamp, batcher);
+            }
+        }
+    }
+
+    batcher.flush();
+    return true;
+}
+
+bool MsgFileMgr::loadById(
+    Type type,
+    const QString& filename,
+    Protocol& protocol,
+    const QString& id,
+    LoadBatchCallback callback,
+    std::size_t batchSize)
+{
+    assert(callback);
+    MsgCaptureFile capture;
+    MsgCaptureIndex index;
+    if (!openIndexedCapture(filename, capture, index)) {
+        return
+            loadStreamed(
+                type,
+                filename,
+                protocol,
+                [&callback, &id](MessagesList&& msgs)
+                {
+                    msgs.remove_if(
+                        [&id](const MessagePtr& msg) -> bool
+                        {
+                            return msg->idAsString() != id;
+                        });
+
+                    if (!msgs.empty()) {
+                        callback(std::move(msgs));
+                    }
+                },
+                batchSize);
+    }
+
+    LoadBatcher batcher(callback, batchSize);
+    unsigned long long prevTimestamp = 0;
+    MsgCaptureFile::Record record;
+    for (auto pos : index.findId(id.toUtf8())) {
+        if (capture.seek(pos) && capture.readNext(record)) {
+            addCaptureRecord(type, record, protocol, prevTimestamp, batcher);
+        }
+    }
+
+    batcher.flush();
+    return true;
 }
 
 bool MsgFileMgr::save(Type type, const QString& filename, const MessagesList& msgs)
@@ -575,23 +908,77 @@ const QString& MsgFileMgr::getFilesFilter()
     return Str;
 }
 
-MsgFileMgr::FileSaveHandler MsgFileMgr::startRecvSave(const QString& filename)
+bool MsgFileMgr::savePcap(
+    const QString& filename,
+    const MessagesList& msgs,
+    Protocol& protocol)
+{
+    PcapWriter writer;
+    if (!writer.open(filename)) {
+        std::cerr << "ERROR: Failed to open " << filename.toStdString() << std::endl;
+        return false;
+    }
+
+    for (auto& msg : msgs) {
+        if (!msg) {
+            assert(!"Message is expected to exist");
+            continue;
+        }
+
+        auto data = getFrameData(*msg, protocol);
+        if (data.empty()) {
+            continue;
+        }
+
+        auto timestampUs = property::message::Timestamp().getFrom(*msg) * 1000U;
+        bool outgoing = (property::message::Type().getFrom(*msg) != Message::Type::Received);
+        if (!writer.write(timestampUs, data.data(), data.size(), outgoing)) {
+            std::cerr << "ERROR: Failed to write " << filename.toStdString() << std::endl;
+            return false;
+        }
+    }
+
+    writer.close();
+    m_lastFile = filename;
+    return true;
+}
+
+struct MsgFileMgr::RecvSaveFile
+{
+    RecvSaveFile(const QString& filename, Format format)
+      : m_file(filename),
+        m_format(format)
+    {
+    }
+
+    ~RecvSaveFile()
+    {
+        if (m_file.isOpen()) {
+            m_file.write(recvSaveSuffix(m_format));
+        }
+    }
+
+    QFile m_file;
+    Format m_format = Format::Json;
+    bool m_firstWritePerformed = false;
+};
+
+MsgFileMgr::FileSaveHandler MsgFileMgr::startRecvSave(
+    const QString& filename,
+    Format format)
 {
-    auto handler = std::unique_ptr<QFile>(new QFile(filename));
-    if (!handler->open(QIODevice::WriteOnly)) {
-        handler.reset();
+    auto handler = std::make_shared<RecvSaveFile>(filename, format);
+    if (!handler->m_file.open(QIODevice::WriteOnly)) {
         return FileSaveHandler();
     }
 
-    handler->write("[\n");
-    return
-        FileSaveHandler(
-            handler.release(),
-            [](QFile* ptr)
-            {
-                ptr->write("\n]\n");
-                delete ptr;
-            });
+    if (format == Format::Binary) {
+        // The index of previous capture is not valid any more
+        QFile::remove(MsgCaptureIndex::filenameFor(filename));
+    }
+
+    handler->m_file.write(recvSavePrefix(format));
+    return handler;
 }
 
 void MsgFileMgr::addToRecvSave(
@@ -600,39 +987,112 @@ void MsgFileMgr::addToRecvSave(
     bool flush)
 {
     assert(handler);
-    auto msgMap = convertRecvMsg(msg);
-    if (!msgMap.isEmpty()) {
-        auto jsonObj = QJsonObject::fromVariantMap(msgMap);
-        QJsonDocument jsonDoc(jsonObj);
-        auto data = jsonDoc.toJson();
-        assert(!data.isEmpty());
-        if (data[data.size() - 1] == '\n') {
-            data.resize(data.size() - 1);
+    RecvSaveEntry entry;
+    if (snapshotRecvMsg(msg, entry)) {
+        QByteArray data;
+        if (handler->m_firstWritePerformed) {
+            data = recvSaveSeparator(handler->m_format);
         }
+        handler->m_firstWritePerformed = true;
 
-        static const char* IndicatorPropName = "first_write_performed";
-        auto indicatorVar = handler->property(IndicatorPropName);
-        bool firstWritePerformed = indicatorVar.isValid();
-
-        if (firstWritePerformed) {
-            handler->write(",\n");
-        }
-        else {
-            handler->setProperty(IndicatorPropName, true);
-        }
-
-        handler->write(data);
+        appendRecvSaveEntry(data, entry, handler->m_format);
+        handler->m_file.write(data);
     }
 
     if (flush) {
-        handler->flush();
+        handler->m_file.flush();
     }
 }
 
 void MsgFileMgr::flushRecvFile(FileSaveHandler handler)
 {
     assert(handler);
-    handler->flush();
+    handler->m_file.flush();
+}
+
+bool MsgFileMgr::snapshotRecvMsg(const Message& msg, RecvSaveEntry& entry)
+{
+    entry.m_id = msg.idAsString();
+    entry.m_data = getMsgData(msg);
+    if (entry.m_id.isEmpty() && entry.m_data.empty()) {
+        return false;
+    }
+
+    entry.m_timestamp = property::message::Timestamp().getFrom(msg);
+    entry.m_type = property::message::Type().getFrom(msg);
+    entry.m_extraInfo = Protocol::getExtraInfo(msg);
+    return true;
+}
+
+QByteArray MsgFileMgr::recvSavePrefix(Format format)
+{
+    if (format == Format::Binary) {
+        return MsgCaptureFile::header();
+    }
+
+    return QByteArray("[\n");
+}
+
+QByteArray MsgFileMgr::recvSaveSuffix(Format format)
+{
+    if (format == Format::Binary) {
+        return QByteArray();
+    }
+
+    return QByteArray("\n]\n");
+}
+
+QByteArray MsgFileMgr::recvSaveSeparator(Format format)
+{
+    if (format == Format::Binary) {
+        return QByteArray();
+    }
+
+    return QByteArray(",\n");
+}
+
+void MsgFileMgr::appendRecvSaveEntry(
+    QByteArray& buf,
+    const RecvSaveEntry& entry,
+    Format format)
+{
+    if (format == Format::Binary) {
+        QByteArray extraInfoData;
+        if (!entry.m_extraInfo.isEmpty()) {
+            extraInfoData =
+                QJsonDocument(QJsonObject::fromVariantMap(entry.m_extraInfo)).toJson(QJsonDocument::Compact);
+        }
+
+        MsgCaptureFile::appendRecord(
+            buf,
+            entry.m_timestamp,
+            entry.m_type,
+            entry.m_id.toUtf8(),
+            entry.m_data,
+            extraInfoData);
+        return;
+    }
+
+    auto jsonObj = QJsonObject::fromVariantMap(convertRecvMsg(entry));
+    QJsonDocument jsonDoc(jsonObj);
+    auto data = jsonDoc.toJson();
+    assert(!data.isEmpty());
+    if (data[data.size() - 1] == '\n') {
+        data.resize(data.size() - 1);
+    }
+    buf.append(data);
+}
+
+MessagePtr MsgFileMgr::createRecvMsg(const QVariantMap& msgMap, Protocol& protocol)
+{
+    return createRecvMsgObjectFrom(QVariant::fromValue(msgMap), protocol);
+}
+
+MessagePtr MsgFileMgr::createRecvMsg(
+    const MsgCaptureFile::Record& record,
+    Protocol& protocol)
+{
+    return createRecvMsgObjectFrom(record, protocol);
 }
 }  // namespace comms_champion
 
@@ -0,0 +1,379 @@
+//
+// Copyright 2016 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "comms_champion/MsgFileRecorder.h"
+
+#include <cassert>
+#include <algorithm>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <iostream>
+
+#include "comms_champion/MsgCaptureIndex.h"
+
+CC_DISABLE_WARNINGS()
+#include <QtCore/QFile>
+#include <QtCore/QByteArray>
+CC_ENABLE_WARNINGS()
+
+#ifdef Q_OS_UNIX
+#include <unistd.h>
+#endif
+
+namespace comms_champion
+{
+
+namespace
+{
+
+const std::size_t WriteBatchSize = 256U;
+const int WriteBufSize = 256 * 1024;
+
+}  // namespace
+
+class MsgFileRecorderImpl
+{
+public:
+    typedef MsgFileRecorder::Format Format;
+
+    ~MsgFileRecorderImpl()
+    {
+        stop();
+    }
+
+    bool start(const QString& filename, Format format)
+    {
+        stop();
+
+        std::unique_ptr<QFile> file(new QFile(filename));
+        if (!file->open(QIODevice::WriteOnly)) {
+            std::cerr << "ERROR: Failed to open " << filename.toStdString() <<
+                " for recording: " << file->errorString().toStdString() << std::endl;
+            return false;
+        }
+
+        m_file = std::move(file);
+        m_format = format;
+        m_fileOffset = 0U;
+        if ((format == Format::Binary) && (!m_index.create(filename))) {
+            std::cerr << "WARNING: Failed to create index of " <<
+                filename.toStdString() << std::endl;
+        }
+
+        m_buf = MsgFileMgr::recvSavePrefix(format);
+        m_buf.reserve(WriteBufSize + WriteBufSize / 4);
+        m_firstWritten = false;
+        m_running = m_config;
+        m_queue.clear();
+        m_queue.reserve(m_running.m_queueCapacity);
+        m_stopRequested = false;
+        m_flushRequested = false;
+        m_thread = std::thread(
+            [this]()
+            {
+                run();
+            });
+        return true;
+    }
+
+    void stop()
+    {
+        if (!m_thread.joinable()) {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            m_stopRequested = true;
+        }
+        m_dataCond.notify_all();
+        m_spaceCond.notify_all();
+        m_thread.join();
+        m_file.reset();
+        m_index.close();
+    }
+
+    bool isRunning() const
+    {
+        return m_thread.joinable();
+    }
+
+    void record(MessagePtr msg)
+    {
+        if (!msg) {
+            return;
+        }
+
+        bool notify = false;
+        {
+            std::unique_lock<std::mutex> guard(m_lock);
+            if (!m_thread.joinable()) {
+                return;
+            }
+
+            m_spaceCond.wait(
+                guard,
+                [this]() -> bool
+                {
+                    return (m_queue.size() < m_running.m_queueCapacity) || m_stopRequested;
+                });
+
+            if (m_stopRequested) {
+                return;
+            }
+
+            m_queue.push_back(std::move(msg));
+            notify =
+                (m_running.m_flushInterval == 0U) ||
+                (m_queue.size() == WriteBatchSize) ||
+                (m_queue.size() == m_running.m_queueCapacity);
+        }
+
+        if (notify) {
+            m_dataCond.notify_one();
+        }
+    }
+
+    void flush()
+    {
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            m_flushRequested = true;
+        }
+        m_dataCond.notify_one();
+    }
+
+    struct Config
+    {
+        std::size_t m_queueCapacity = MsgFileRecorder::DefaultQueueCapacity;
+        unsigned m_flushInterval = MsgFileRecorder::DefaultFlushInterval;
+        unsigned m_syncInterval = MsgFileRecorder::DefaultSyncInterval;
+    };
+
+    Config m_config;
+
+private:
+    typedef std::vector<MessagePtr> MessagesList;
+    typedef std::chrono::steady_clock Clock;
+    typedef Clock::time_point Timestamp;
+    typedef MsgCaptureIndex::Position Position;
+
+    void run()
+    {
+        auto now = Clock::now();
+        auto flushInterval = m_running.m_flushInterval;
+        auto syncInterval = m_running.m_syncInterval;
+        auto nextFlush = now + std::chrono::milliseconds(flushInterval);
+        auto nextSync = now + std::chrono::milliseconds(syncInterval);
+        MessagesList msgs;
+        msgs.reserve(m_running.m_queueCapacity);
+        MsgFileMgr::RecvSaveEntry entry;
+
+        while (true) {
+            bool stopRequested = false;
+            bool flushRequested = false;
+            {
+                std::unique_lock<std::mutex> guard(m_lock);
+                auto ready =
+                    [this, flushInterval]() -> bool
+                    {
+                        return
+                            m_stopRequested ||
+                            m_flushRequested ||
+                            (WriteBatchSize <= m_queue.size()) ||
+                            ((flushInterval == 0U) && (!m_queue.empty()));
+                    };
+
+                if (flushInterval == 0U) {
+                    m_dataCond.wait(guard, ready);
+                }
+                else {
+                    m_dataCond.wait_until(guard, nextFlush, ready);
+                }
+
+                msgs.swap(m_queue);
+                stopRequested = m_stopRequested;
+                flushRequested = m_flushRequested;
+                m_flushRequested = false;
+            }
+
+            if (!msgs.empty()) {
+                m_spaceCond.notify_all();
+            }
+
+            for (auto& msg : msgs) {
+                if (!MsgFileMgr::snapshotRecvMsg(*msg, entry)) {
+                    continue;
+                }
+
+                if (m_firstWritten) {
+                    m_buf.append(MsgFileMgr::recvSaveSeparator(m_format));
+                }
+                auto pos = m_fileOffset + static_cast<Position>(m_buf.size());
+                MsgFileMgr::appendRecvSaveEntry(m_buf, entry, m_format);
+                m_firstWritten = true;
+                if (m_index.isOpen()) {
+                    auto id = entry.m_id.toUtf8();
+                    m_index.addRecord(
+                        pos,
+                        m_fileOffset + static_cast<Position>(m_buf.size()),
+                        entry.m_timestamp,
+                        id.constData(),
+                        static_cast<std::size_t>(id.size()));
+                }
+
+                if (WriteBufSize <= m_buf.size()) {
+                    writeBuf();
+                }
+            }
+            msgs.clear();
+
+            if (stopRequested) {
+                m_buf.append(MsgFileMgr::recvSaveSuffix(m_format));
+            }
+
+            now = Clock::now();
+            if (stopRequested ||
+                flushRequested ||
+                (flushInterval == 0U) ||
+                (nextFlush <= now)) {
+                writeBuf();
+                m_file->flush();
+                nextFlush = now + std::chrono::milliseconds(flushInterval);
+            }
+
+            if ((0U < syncInterval) &&
+                (stopRequested || (nextSync <= now))) {
+                sync();
+                nextSync = now + std::chrono::milliseconds(syncInterval);
+            }
+
+            if (stopRequested) {
+                break;
+            }
+        }
+    }
+
+    void writeBuf()
+    {
+        if (m_buf.isEmpty()) {
+            return;
+        }
+
+        auto written = m_file->write(m_buf);
+        if (written != m_buf.size()) {
+            std::cerr << "ERROR: Failed to write recorded messages: " <<
+                m_file->errorString().toStdString() << std::endl;
+        }
+
+        if (0 < written) {
+            m_fileOffset += static_cast<Position>(written);
+        }
+        m_buf.resize(0);
+    }
+
+    void sync()
+    {
+#ifdef Q_OS_UNIX
+        ::fsync(m_file->handle());
+#endif
+    }
+
+    std::thread m_thread;
+    std::mutex m_lock;
+    std::condition_variable m_dataCond;
+    std::condition_variable m_spaceCond;
+    MessagesList m_queue;
+    Config m_running;
+    bool m_stopRequested = false;
+    bool m_flushRequested = false;
+
+    std::unique_ptr<QFile> m_file;
+    Format m_format = Format::Json;
+    QByteArray m_buf;
+    bool m_firstWritten = false;
+    MsgCaptureIndex m_index;
+    Position m_fileOffset = 0U;
+};
+
+MsgFileRecorder::MsgFileRecorder()
+  : m_impl(new MsgFileRecorderImpl())
+{
+}
+
+MsgFileRecorder::~MsgFileRecorder() = default;
+
+void MsgFileRecorder::setQueueCapacity(std::size_t value)
+{
+    m_impl->m_config.m_queueCapacity = std::max(value, WriteBatchSize);
+}
+
+std::size_t MsgFileRecorder::getQueueCapacity() const
+{
+    return m_impl->m_config.m_queueCapacity;
+}
+
+void MsgFileRecorder::setFlushInterval(unsigned value)
+{
+    m_impl->m_config.m_flushInterval = value;
+}
+
+unsigned MsgFileRecorder::getFlushInterval() const
+{
+    return m_impl->m_config.m_flushInterval;
+}
+
+void MsgFileRecorder::setSyncInterval(unsigned value)
+{
+    m_impl->m_config.m_syncInterval = value;
+}
+
+unsigned MsgFileRecorder::getSyncInterval() const
+{
+    return m_impl->m_config.m_syncInterval;
+}
+
+bool MsgFileRecorder::start(const QString& filename, Format format)
+{
+    return m_impl->start(filename, format);
+}
+
+void MsgFileRecorder::stop()
+{
+    m_impl->stop();
+}
+
+bool MsgFileRecorder::isRunning() const
+{
+    return m_impl->isRunning();
+}
+
+void MsgFileRecorder::record(MessagePtr msg)
+{
+    m_impl->record(std::move(msg));
+}
+
+void MsgFileRecorder::flush()
+{
+    m_impl->flush();
+}
+
+}  // namespace comms_champion
@@ -0,0 +1,248 @@
+//
+// Copyright 2016 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "comms_champion/MsgFileStreamReader.h"
+
+#include <cassert>
+
+CC_DISABLE_WARNINGS()
+#include <QtCore/QFile>
+#include <QtCore/QByteArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QJsonParseError>
+CC_ENABLE_WARNINGS()
+
+namespace comms_champion
+{
+
+namespace
+{
+
+const qint64 ReadChunkSize = 64 * 1024;
+
+bool isWhiteSpace(char ch)
+{
+    return (ch == ' ') || (ch == '\n') || (ch == '\r') || (ch == '\t');
+}
+
+}  // namespace
+
+class MsgFileStreamReaderImpl
+{
+public:
+    bool readElement(QByteArray& element);
+    void reset();
+
+    QFile m_file;
+    QByteArray m_buf;
+    QString m_error;
+    int m_pos = 0;
+    int m_elemStart = -1;
+    unsigned m_depth = 0U;
+    bool m_arrayStarted = false;
+    bool m_arrayEnded = false;
+    bool m_inString = false;
+    bool m_escaped = false;
+};
+
+bool MsgFileStreamReaderImpl::readElement(QByteArray& element)
+{
+    if (m_arrayEnded || (!m_error.isEmpty())) {
+        return false;
+    }
+
+    while (true) {
+        while (m_pos < m_buf.size()) {
+            auto ch = m_buf.at(m_pos);
+            ++m_pos;
+
+            if (m_depth == 0U) {
+                if (isWhiteSpace(ch)) {
+                    continue;
+                }
+
+                if (!m_arrayStarted) {
+                    if (ch == '[') {
+                        m_arrayStarted = true;
+                        continue;
+                    }
+
+                    m_error = QObject::tr("Messages file doesn't contain JSON array.");
+                    return false;
+                }
+
+                if (ch == ',') {
+                    continue;
+                }
+
+                if (ch == ']') {
+                    m_arrayEnded = true;
+                    return false;
+                }
+
+                if (ch != '{') {
+                    m_error = QObject::tr("Unexpected contents of messages file.");
+                    return false;
+                }
+
+                m_elemStart = m_pos - 1;
+                m_depth = 1U;
+                continue;
+            }
+
+            if (m_inString) {
+                if (m_escaped) {
+                    m_escaped = false;
+                }
+                else if (ch == '\\') {
+                    m_escaped = true;
+                }
+                else if (ch == '"') {
+                    m_inString = false;
+                }
+                continue;
+            }
+
+            if (ch == '"') {
+                m_inString = true;
+                continue;
+            }
+
+            if ((ch == '{') || (ch == '[')) {
+                ++m_depth;
+                continue;
+            }
+
+            if ((ch != '}') && (ch != ']')) {
+                continue;
+            }
+
+            --m_depth;
+            if (m_depth == 0U) {
+                assert(0 <= m_elemStart);
+                element = m_buf.mid(m_elemStart, m_pos - m_elemStart);
+                m_elemStart = -1;
+                return true;
+            }
+        }
+
+        // Drop consumed data, keep partial element
+        auto keepFrom = m_pos;
+        if (0 <= m_elemStart) {
+            keepFrom = m_elemStart;
+            m_elemStart = 0;
+        }
+        m_buf.remove(0, keepFrom);
+        m_pos -= keepFrom;
+
+        auto chunk = m_file.read(ReadChunkSize);
+        if (chunk.isEmpty()) {
+            if (!m_arrayStarted) {
+                m_error = QObject::tr("Messages file doesn't contain JSON array.");
+            }
+            else {
+                m_error = QObject::tr("Messages file is truncated.");
+            }
+            return false;
+        }
+        m_buf.append(chunk);
+    }
+}
+
+void MsgFileStreamReaderImpl::reset()
+{
+    m_buf.clear();
+    m_error.clear();
+    m_pos = 0;
+    m_elemStart = -1;
+    m_depth = 0U;
+    m_arrayStarted = false;
+    m_arrayEnded = false;
+    m_inString = false;
+    m_escaped = false;
+}
+
+MsgFileStreamReader::MsgFileStreamReader()
+  : m_impl(new MsgFileStreamReaderImpl())
+{
+}
+
+MsgFileStreamReader::~MsgFileStreamReader() = default;
+
+bool MsgFileStreamReader::open(const QString& filename)
+{
+    close();
+    auto& file = m_impl->m_file;
+    file.setFileName(filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        m_impl->m_error = QObject::tr("Failed to open messages file: ") + filename;
+        return false;
+    }
+    return true;
+}
+
+void MsgFileStreamReader::close()
+{
+    if (m_impl->m_file.isOpen()) {
+        m_impl->m_file.close();
+    }
+    m_impl->reset();
+}
+
+bool MsgFileStreamReader::isOpen() const
+{
+    return m_impl->m_file.isOpen();
+}
+
+bool MsgFileStreamReader::readNext(QVariantMap& msgMap)
+{
+    if (!isOpen()) {
+        return false;
+    }
+
+    QByteArray element;
+    while (m_impl->readElement(element)) {
+        QJsonParseError parseError;
+        auto doc = QJsonDocument::fromJson(element, &parseError);
+        if (parseError.error != QJsonParseError::NoError) {
+            m_impl->m_error = QObject::tr("Invalid messages file element: ") + parseError.errorString();
+            return false;
+        }
+
+        if (!doc.isObject()) {
+            continue;
+        }
+
+        msgMap = doc.object().toVariantMap();
+        return true;
+    }
+    return false;
+}
+
+bool MsgFileStreamReader::hasError() const
+{
+    return !m_impl->m_error.isEmpty();
+}
+
+const QString& MsgFileStreamReader::errorString() const
+{
+    return m_impl->m_error;
+}
+
+}  // namespace comms_champion
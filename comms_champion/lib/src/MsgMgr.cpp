@@ -60,6 +60,16 @@ void MsgMgr::setRecvEnabled(bool enabled)
     m_impl->setRecvEnabled(enabled);
 }
 
+void MsgMgr::setMsgsRetained(bool retained)
+{
+    m_impl->setMsgsRetained(retained);
+}
+
+const MsgMgr::Stats& MsgMgr::getStats() const
+{
+    return m_impl->getStats();
+}
+
 void MsgMgr::deleteMsg(MessagePtr msg)
 {
     m_impl->deleteMsg(std::move(msg));
@@ -75,6 +85,11 @@ void MsgMgr::sendMsgs(MessagesList&& msgs)
     m_impl->sendMsgs(std::move(msgs));
 }
 
+void MsgMgr::sendFrame(const DataInfoPtr& frame, MessagePtr msg)
+{
+    m_impl->sendFrame(frame, std::move(msg));
+}
+
 const MsgMgr::AllMessages& MsgMgr::getAllMsgs() const
 {
     return m_impl->getAllMsgs();
@@ -29,6 +29,7 @@ CC_DISABLE_WARNINGS()
 CC_ENABLE_WARNINGS()
 
 #include "comms/util/ScopeGuard.h"
+#include "comms_champion/EndpointRegistry.h"
 #include "comms_champion/property/message.h"
 
 namespace comms_champion
@@ -59,6 +60,21 @@ void updateMsgTimestamp(Message& msg, const DataInfo::Timestamp& timestamp)
     property::message::Timestamp().setTo(milliseconds.count(), msg);
 }
 
+// Endpoint names of the retained messages must remain resolvable
+void pinEndpoints(const Message& msg)
+{
+    EndpointRegistry::instanceRef().pin(
+        property::message::FromEndpoint().getFrom(msg, DataInfo::NoEndpoint),
+        property::message::ToEndpoint().getFrom(msg, DataInfo::NoEndpoint));
+}
+
+void unpinEndpoints(const Message& msg)
+{
+    EndpointRegistry::instanceRef().unpin(
+        property::message::FromEndpoint().getFrom(msg, DataInfo::NoEndpoint),
+        property::message::ToEndpoint().getFrom(msg, DataInfo::NoEndpoint));
+}
+
 }  // namespace
 
 MsgMgrImpl::MsgMgrImpl()
@@ -66,7 +82,10 @@ MsgMgrImpl::MsgMgrImpl()
     m_allMsgs.reserve(1024);
 }
 
-MsgMgrImpl::~MsgMgrImpl() = default;
+MsgMgrImpl::~MsgMgrImpl()
+{
+    deleteAllMsgs();
+}
 
 void MsgMgrImpl::start()
 {
@@ -153,9 +172,18 @@ void MsgMgrImpl::deleteMsg(MessagePtr msg)
     }
 
     assert(msg.get() == iter->get()); // Make sure that the right message is found
+    unpinEndpoints(**iter);
     m_allMsgs.erase(iter);
 }
 
+void MsgMgrImpl::deleteAllMsgs()
+{
+    for (auto& m : m_allMsgs) {
+        unpinEndpoints(*m);
+    }
+    m_allMsgs.clear();
+}
+
 void MsgMgrImpl::sendMsgs(MessagesList&& msgs)
 {
     if (msgs.empty() || (!m_socket) || (!m_protocol)) {
@@ -167,60 +195,91 @@ void MsgMgrImpl::sendMsgs(MessagesList&& msgs)
             continue;
         }
 
-        auto updateMsgGuard =
-            comms::util::makeScopeGuard(
-                [this, &msgPtr]()
-                {
-                    updateInternalId(*msgPtr);
-                    property::message::Type().setTo(MsgType::Sent, *msgPtr);
-                    auto now = DataInfo::TimestampClock::now();
-                    updateMsgTimestamp(*msgPtr, now);
-                    m_allMsgs.push_back(msgPtr);
-                    reportMsgAdded(msgPtr);
-                });
-
-        auto dataInfoPtr = m_protocol->write(*msgPtr);
-        if (!dataInfoPtr) {
-            continue;
-        }
+        sendData(m_protocol->write(*msgPtr), msgPtr);
+        m_socket->flushSendData();
+    }
+}
 
-        QList <DataInfoPtr> data;
-        data.append(std::move(dataInfoPtr));
-        for (auto& filter : m_filters) {
-            if (data.isEmpty()) {
-                break;
-            }
+void MsgMgrImpl::sendFrame(const DataInfoPtr& frame, MessagePtr msg)
+{
+    if ((!m_socket) || (!m_protocol)) {
+        return;
+    }
 
-            QList <DataInfoPtr> dataTmp;
-            for (auto& d : data) {
-                dataTmp.append(filter->sendData(d));
-            }
+    if (!frame) {
+        sendData(DataInfoPtr(), msg);
+        return;
+    }
 
-            data.swap(dataTmp);
-        }
+    // Filters and sockets may modify or keep the data
+    auto dataInfoPtr = makeDataInfo();
+    *dataInfoPtr = *frame;
+    dataInfoPtr->m_timestamp = DataInfo::TimestampClock::now();
+    sendData(std::move(dataInfoPtr), msg);
+    m_socket->flushSendData();
+}
+
+void MsgMgrImpl::sendData(DataInfoPtr dataInfoPtr, const MessagePtr& msgPtr)
+{
+    auto updateMsgGuard =
+        comms::util::makeScopeGuard(
+            [this, &msgPtr]()
+            {
+                updateInternalId(*msgPtr);
+                property::message::Type().setTo(MsgType::Sent, *msgPtr);
+                auto now = DataInfo::TimestampClock::now();
+                updateMsgTimestamp(*msgPtr, now);
+                retainMsg(msgPtr);
+                reportMsgAdded(msgPtr);
+            });
+
+    if (!msgPtr) {
+        updateMsgGuard.release();
+    }
+
+    if (!dataInfoPtr) {
+        return;
+    }
+
+    ++m_stats.m_sentMsgs;
+
+    auto buffers = acquireFilterBuffers();
+    auto releaseGuard =
+        comms::util::makeScopeGuard(
+            [this, &buffers]()
+            {
+                releaseFilterBuffers(std::move(buffers));
+            });
 
-        if (data.isEmpty()) {
+    auto& data = buffers->m_data;
+    data.push_back(std::move(dataInfoPtr));
+    filterSendData(*buffers, m_filters.rbegin());
+
+    for (auto& d : data) {
+        m_stats.m_sentBytes += d->m_data.size();
+        m_socket->sendData(d);
+        if (!msgPtr) {
             continue;
         }
 
-        for (auto& d : data) {
-            m_socket->sendData(d);
-
-            if (!d->m_extraProperties.isEmpty()) {
-                auto map = property::message::ExtraInfo().getFrom(*msgPtr);
-                for (auto& key : d->m_extraProperties.keys()) {
-                    map.insert(key, d->m_extraProperties.value(key));
-                }
-                property::message::ExtraInfo().setTo(std::move(map), *msgPtr);
-                m_protocol->updateMessage(*msgPtr);
+        Protocol::setEndpointsToMessageProperties(*d, *msgPtr);
+        auto& props = d->m_extraProperties;
+        if (!props.isEmpty()) {
+            auto map = property::message::ExtraInfo().getFrom(*msgPtr);
+            for (auto iter = props.begin(); iter != props.end(); ++iter) {
+                map.insert(iter.key(), iter.value());
             }
+            property::message::ExtraInfo().setTo(std::move(map), *msgPtr);
+            m_protocol->updateMessage(*msgPtr);
         }
     }
 }
 
 void MsgMgrImpl::addMsgs(const MessagesList& msgs, bool reportAdded)
 {
-    m_allMsgs.reserve(m_allMsgs.size() + msgs.size());
+    if (m_msgsRetained) {
+        m_allMsgs.reserve(m_allMsgs.size() + msgs.size());
+    }
 
     for (auto& m : msgs) {
         if (!m) {
@@ -242,7 +301,7 @@ void MsgMgrImpl::addMsgs(const MessagesList& msgs, bool reportAdded)
         if (reportAdded) {
             reportMsgAdded(m);
         }
-        m_allMsgs.push_back(m);
+        retainMsg(m);
     }
 }
 
@@ -271,12 +330,22 @@ void MsgMgrImpl::setSocket(SocketPtr socket)
             reportSocketDisconnected();
         });
 
+    socket->setStreamClosedReportCallback(
+        [this](DataInfo::StreamId streamId)
+        {
+            socketStreamClosed(streamId);
+        });
+
+    socket->setProtocol(m_protocol);
     m_socket = std::move(socket);
 }
 
 void MsgMgrImpl::setProtocol(ProtocolPtr protocol)
 {
     m_protocol = std::move(protocol);
+    if (m_socket) {
+        m_socket->setProtocol(m_protocol);
+    }
 }
 
 void MsgMgrImpl::addFilter(FilterPtr filter)
@@ -296,31 +365,26 @@ void MsgMgrImpl::addFilter(FilterPtr filter)
             assert(filterIdx < m_filters.size());
             auto revIdx = m_filters.size() - filterIdx;
 
-            QList<DataInfoPtr> data;
-            data.append(std::move(dataPtr));
-            for (auto iter = m_filters.rbegin() + revIdx; iter != m_filters.rend(); ++iter) {
+            auto buffers = acquireFilterBuffers();
+            auto releaseGuard =
+                comms::util::makeScopeGuard(
+                    [this, &buffers]()
+                    {
+                        releaseFilterBuffers(std::move(buffers));
+                    });
 
-                if (!data.isEmpty()) {
-                    break;
-                }
-
-                auto nextFilter = *iter;
-
-                QList<DataInfoPtr> dataTmp;
-                for (auto& d : data) {
-                    dataTmp.append(nextFilter->sendData(d));
-                }
-
-                data.swap(dataTmp);
-            }
+            buffers->m_data.push_back(std::move(dataPtr));
+            filterSendData(*buffers, m_filters.rbegin() + revIdx);
 
             if (!m_socket) {
                 return;
             }
 
-            for (auto& d : data) {
-                m_socket->sendData(std::move(d));
+            for (auto& d : buffers->m_data) {
+                m_stats.m_sentBytes += d->m_data.size();
+                m_socket->sendData(d);
             }
+            m_socket->flushSendData();
         });
 
     filter->setErrorReportCallback(
@@ -332,67 +396,131 @@ void MsgMgrImpl::addFilter(FilterPtr filter)
     m_filters.push_back(std::move(filter));
 }
 
+MsgMgrImpl::FilterBuffersPtr MsgMgrImpl::acquireFilterBuffers()
+{
+    if (m_freeFilterBuffers.empty()) {
+        return FilterBuffersPtr(new FilterBuffers());
+    }
+
+    auto buffers = std::move(m_freeFilterBuffers.back());
+    m_freeFilterBuffers.pop_back();
+    return buffers;
+}
+
+void MsgMgrImpl::releaseFilterBuffers(FilterBuffersPtr buffers)
+{
+    assert(buffers);
+    buffers->m_data.clear();
+    buffers->m_scratch.clear();
+    m_freeFilterBuffers.push_back(std::move(buffers));
+}
+
+void MsgMgrImpl::filterSendData(
+    FilterBuffers& buffers,
+    FiltersList::reverse_iterator from)
+{
+    auto& data = buffers.m_data;
+    auto& scratch = buffers.m_scratch;
+    for (auto iter = from; iter != m_filters.rend(); ++iter) {
+        if (data.empty()) {
+            break;
+        }
+
+        auto& filter = *iter;
+        assert(filter);
+        scratch.clear();
+        filter->sendDataBatch(data.data(), data.size(), scratch);
+        data.swap(scratch);
+    }
+}
+
 void MsgMgrImpl::socketDataReceived(DataInfoPtr dataInfoPtr)
 {
     if ((!m_recvEnabled) || !(m_protocol) || (!dataInfoPtr)) {
         return;
     }
 
-    QList<DataInfoPtr> data;
-    data.append(std::move(dataInfoPtr));
-    for (auto filt : m_filters) {
+    auto buffers = acquireFilterBuffers();
+    auto releaseGuard =
+        comms::util::makeScopeGuard(
+            [this, &buffers]()
+            {
+                releaseFilterBuffers(std::move(buffers));
+            });
+
+    m_stats.m_recvBytes += dataInfoPtr->m_data.size();
+
+    auto& data = buffers->m_data;
+    auto& scratch = buffers->m_scratch;
+    data.push_back(std::move(dataInfoPtr));
+    for (auto& filt : m_filters) {
         assert(filt);
 
-        if (data.isEmpty()) {
+        if (data.empty()) {
             return;
         }
 
-        QList<DataInfoPtr> dataTmp;
-        for (auto& d : data) {
-            dataTmp.append(filt->recvData(d));
+        scratch.clear();
+        filt->recvDataBatch(data.data(), data.size(), scratch);
+        data.swap(scratch);
+    }
+
+    MessagesList msgsList;
+    for (auto& d : data) {
+        assert(d);
+        auto msgs = m_protocol->read(*d);
+        if (msgs.empty()) {
+            continue;
         }
 
-        data.swap(dataTmp);
-    }
+        static const DataInfo::Timestamp DefaultTimestamp;
+        auto timestamp = d->m_timestamp;
+        if (timestamp == DefaultTimestamp) {
+            timestamp = DataInfo::TimestampClock::now();
+        }
 
-    if (data.isEmpty()) {
-        return;
-    }
+        for (auto& m : msgs) {
+            assert(m);
+            // Same check as the one used to display invalid messages
+            if (m->idAsString().isEmpty()) {
+                ++m_stats.m_invalidMsgs;
+            }
 
-    MessagesList msgsList;
-    while (!data.isEmpty()) {
-        auto nextDataPtr = data.front();
-        data.pop_front();
+            updateInternalId(*m);
+            property::message::Type().setTo(MsgType::Received, *m);
+            updateMsgTimestamp(*m, timestamp);
+        }
 
-        auto msgs = m_protocol->read(*nextDataPtr);
-        msgsList.insert(msgsList.end(), msgs.begin(), msgs.end());
+        msgsList.splice(msgsList.end(), msgs);
     }
 
     if (msgsList.empty()) {
         return;
     }
 
+    m_stats.m_recvMsgs += msgsList.size();
     for (auto& m : msgsList) {
-        assert(m);
-        updateInternalId(*m);
-        property::message::Type().setTo(MsgType::Received, *m);
-
-        static const DataInfo::Timestamp DefaultTimestamp;
-        if (dataInfoPtr->m_timestamp != DefaultTimestamp) {
-            updateMsgTimestamp(*m, dataInfoPtr->m_timestamp);
-        }
-        else {
-            auto now = DataInfo::TimestampClock::now();
-            updateMsgTimestamp(*m, now);
-        }
-
         reportMsgAdded(m);
     }
 
+    if (!m_msgsRetained) {
+        return;
+    }
+
     m_allMsgs.reserve(m_allMsgs.size() + msgsList.size());
+    for (auto& m : msgsList) {
+        pinEndpoints(*m);
+    }
     std::move(msgsList.begin(), msgsList.end(), std::back_inserter(m_allMsgs));
 }
 
+void MsgMgrImpl::socketStreamClosed(DataInfo::StreamId streamId)
+{
+    if (m_protocol) {
+        m_protocol->closeStream(streamId);
+    }
+}
+
 void MsgMgrImpl::updateInternalId(Message& msg)
 {
     SeqNumber().setTo(m_nextMsgNum, msg);
@@ -400,6 +528,14 @@ void MsgMgrImpl::updateInternalId(Message& msg)
     assert(0 < m_nextMsgNum); // wrap around is not supported
 }
 
+void MsgMgrImpl::retainMsg(MessagePtr msg)
+{
+    if (m_msgsRetained) {
+        pinEndpoints(*msg);
+        m_allMsgs.push_back(std::move(msg));
+    }
+}
+
 void MsgMgrImpl::reportMsgAdded(MessagePtr msg)
 {
     if (m_msgAddedCallback) {
@@ -409,6 +545,7 @@ void MsgMgrImpl::reportMsgAdded(MessagePtr msg)
 
 void MsgMgrImpl::reportError(const QString& error)
 {
+    ++m_stats.m_errors;
     if (m_errorReportCallback) {
         m_errorReportCallback(error);
     }
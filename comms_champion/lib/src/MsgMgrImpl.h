@@ -19,6 +19,7 @@
 #pragma once
 
 #include <vector>
+#include <memory>
 
 #include "comms_champion/MsgMgr.h"
 
@@ -32,6 +33,7 @@ public:
     typedef MsgMgr::MessagesList MessagesList;
 
     typedef MsgMgr::MsgType MsgType;
+    typedef MsgMgr::Stats Stats;
 
     MsgMgrImpl();
     ~MsgMgrImpl();
@@ -44,13 +46,21 @@ public:
     ProtocolPtr getProtocol() const;
     void setRecvEnabled(bool enabled);
 
-    void deleteMsg(MessagePtr msg);
-    void deleteAllMsgs()
+    void setMsgsRetained(bool retained)
     {
-        m_allMsgs.clear();
+        m_msgsRetained = retained;
     }
 
+    const Stats& getStats() const
+    {
+        return m_stats;
+    }
+
+    void deleteMsg(MessagePtr msg);
+    void deleteAllMsgs();
+
     void sendMsgs(MessagesList&& msgs);
+    void sendFrame(const DataInfoPtr& frame, MessagePtr msg);
 
     const AllMessages& getAllMsgs() const
     {
@@ -88,19 +98,38 @@ public:
 private:
     typedef unsigned long long MsgNumberType;
     typedef std::vector<FilterPtr> FiltersList;
+    typedef Filter::DataInfosList DataInfosList;
+
+    struct FilterBuffers
+    {
+        DataInfosList m_data;
+        DataInfosList m_scratch;
+    };
+
+    typedef std::unique_ptr<FilterBuffers> FilterBuffersPtr;
+    typedef std::vector<FilterBuffersPtr> FilterBuffersList;
 
+    FilterBuffersPtr acquireFilterBuffers();
+    void releaseFilterBuffers(FilterBuffersPtr buffers);
+    void filterSendData(FilterBuffers& buffers, FiltersList::reverse_iterator from);
+    void sendData(DataInfoPtr dataInfoPtr, const MessagePtr& msgPtr);
     void socketDataReceived(DataInfoPtr dataInfoPtr);
+    void socketStreamClosed(DataInfo::StreamId streamId);
     void updateInternalId(Message& msg);
+    void retainMsg(MessagePtr msg);
     void reportMsgAdded(MessagePtr msg);
     void reportError(const QString& error);
     void reportSocketDisconnected();
 
     AllMessages m_allMsgs;
     bool m_recvEnabled = false;
+    bool m_msgsRetained = true;
+    Stats m_stats;
 
     SocketPtr m_socket;
     ProtocolPtr m_protocol;
     FiltersList m_filters;
+    FilterBuffersList m_freeFilterBuffers;
     MsgNumberType m_nextMsgNum = 1;
     bool m_running = false;
 
@@ -39,6 +39,16 @@ void MsgSendMgr::setSendCompeteCallbackFunc(SendCompleteCallbackFunc&& func)
     m_impl->setSendCompleteCallbackFunc(std::move(func));
 }
 
+void MsgSendMgr::setSendFrameCallbackFunc(SendFrameCallbackFunc&& func)
+{
+    m_impl->setSendFrameCallbackFunc(std::move(func));
+}
+
+void MsgSendMgr::setSentMsgsRequired(bool value)
+{
+    m_impl->setSentMsgsRequired(value);
+}
+
 void MsgSendMgr::start(ProtocolPtr protocol, const MessagesList& msgs)
 {
     m_impl->start(std::move(protocol), msgs);
@@ -49,5 +59,10 @@ void MsgSendMgr::stop()
     m_impl->stop();
 }
 
+const LatencyRecorder& MsgSendMgr::getJitter() const
+{
+    return m_impl->getJitter();
+}
+
 }  // namespace comms_champion
 
@@ -18,26 +18,44 @@
 #include "MsgSendMgrImpl.h"
 
 #include <cassert>
+#include <algorithm>
+
+CC_DISABLE_WARNINGS()
+#include <QtCore/QMetaObject>
+CC_ENABLE_WARNINGS()
 
 #include "comms_champion/property/message.h"
 
 namespace comms_champion
 {
 
+namespace
+{
+
+// The OS timers may overshoot, the rest of the wait is busy
+const auto SpinInterval = std::chrono::microseconds(200);
+const std::size_t JitterCapacity = 10000U;
+
+}  // namespace
+
 MsgSendMgrImpl::MsgSendMgrImpl()
-  : m_timer(this)
+  : m_jitter(LatencyRecorder::Mode::KeepLast, JitterCapacity)
 {
-    connect(
-        &m_timer, SIGNAL(timeout()),
-        this, SLOT(sendPendingAndWait()));
 }
 
-MsgSendMgrImpl::~MsgSendMgrImpl() = default;
+MsgSendMgrImpl::~MsgSendMgrImpl()
+{
+    stopTimingThread();
+}
 
 void MsgSendMgrImpl::start(ProtocolPtr protocol, const MessagesList& msgs)
 {
-    assert(m_msgsToSend.empty() || !"The previous sending must be stopped first.");
+    assert(m_pending.empty() || !"The previous sending must be stopped first.");
     m_protocol = std::move(protocol);
+    m_pending.reserve(msgs.size());
+    m_jitter.clear();
+
+    auto deadline = Clock::now();
     for (auto& m : msgs) {
         auto clonedMsg = m_protocol->cloneMessage(*m);
         property::message::Delay().copyFromTo(*m, *clonedMsg);
@@ -46,102 +64,203 @@ void MsgSendMgrImpl::start(ProtocolPtr protocol, const MessagesList& msgs)
         property::message::RepeatDurationUnits().copyFromTo(*m, *clonedMsg);
         property::message::RepeatCount().copyFromTo(*m, *clonedMsg);
 
+        // Delays are relative to the previous message
+        deadline += std::chrono::milliseconds(property::message::Delay().getFrom(*clonedMsg));
+
+        Entry entry;
+        entry.m_deadline = deadline;
+        entry.m_repeat = std::chrono::milliseconds(property::message::RepeatDuration().getFrom(*clonedMsg));
+        entry.m_repeatCount = property::message::RepeatCount().getFrom(*clonedMsg);
+
+        if (m_sendFrameCallback) {
+            entry.m_frame = m_protocol->write(*clonedMsg);
+        }
+
         // TODO: copy custom properties
-        m_msgsToSend.push_back(std::move(clonedMsg));
+        entry.m_msg = std::move(clonedMsg);
+        push(std::move(entry));
     }
+
+    m_running = true;
+    startTimingThread();
     sendPendingAndWait();
 }
 
 void MsgSendMgrImpl::stop()
 {
-    m_timer.stop();
+    m_running = false;
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_deadlinePending = false;
+    }
     m_protocol.reset();
-    m_msgsToSend.clear();
+    m_pending.clear();
 }
 
 void MsgSendMgrImpl::sendPendingAndWait()
 {
-    m_timer.stop();
-    auto iter = m_msgsToSend.begin();
-    for (; iter != m_msgsToSend.end(); ++iter) {
-        auto& msg = *iter;
-        assert(msg);
-        auto delay = property::message::Delay().getFrom(*msg);
-        if (delay != 0U) {
-            break;
-        }
+    if (!m_running) {
+        return;
     }
 
-    decltype(m_msgsToSend) nextMsgsToSend;
-    nextMsgsToSend.splice(
-        nextMsgsToSend.end(), m_msgsToSend, m_msgsToSend.begin(), iter);
+    auto now = Clock::now();
+    while ((!m_pending.empty()) && (m_pending.front().m_deadline <= now)) {
+        std::pop_heap(m_pending.begin(), m_pending.end(), EntryLater());
+        m_due.push_back(std::move(m_pending.back()));
+        m_pending.pop_back();
+    }
+
+    bool framesMode = static_cast<bool>(m_sendFrameCallback);
+    MessagesList nextMsgsToSend;
+    for (auto& entry : m_due) {
+        m_jitter.record(
+            std::chrono::duration_cast<LatencyRecorder::Duration>(now - entry.m_deadline));
 
-    for (auto& msgToSend : nextMsgsToSend) {
-        auto repeatMs = property::message::RepeatDuration().getFrom(*msgToSend);
-        auto repeatCount = property::message::RepeatCount().getFrom(*msgToSend);
+        MessagePtr sentMsg;
+        if ((!framesMode) || m_sentMsgsRequired) {
+            sentMsg = entry.m_msg;
+        }
 
         bool reinsert =
-            (0U < repeatMs) &&
-            ((repeatCount == 0U) || (1U < repeatCount));
+            (std::chrono::milliseconds::zero() < entry.m_repeat) &&
+            ((entry.m_repeatCount == 0U) || (1U < entry.m_repeatCount));
 
         if (reinsert) {
-            if (!m_protocol) {
+            Entry nextEntry;
+            if (!sentMsg) {
+                // Never handed out, no need to clone
+                nextEntry.m_msg = std::move(entry.m_msg);
+            }
+            else if (m_protocol) {
+                // TODO copy extra properties
+                nextEntry.m_msg = m_protocol->cloneMessage(*entry.m_msg);
+            }
+            else {
                 assert(!"Expecting protocol to be valid");
                 continue;
             }
 
-            auto newDelay = repeatMs;
-            auto reinsertIter =
-                std::find_if(
-                    m_msgsToSend.begin(), m_msgsToSend.end(),
-                    [&newDelay](MessagePtr mPtr) mutable -> bool
-                    {
-                        assert(mPtr);
-                        auto mDelay = property::message::Delay().getFrom(*mPtr);
-                        if (newDelay < mDelay) {
-                            return true;
-                        }
-                        newDelay -= mDelay;
-                        return false;
-                    });
-
-            if (reinsertIter != m_msgsToSend.end()) {
-                auto& msgToUpdate = *reinsertIter;
-                assert(msgToUpdate);
-                auto mDelay = property::message::Delay().getFrom(*msgToUpdate);
-                property::message::Delay().setTo(mDelay - newDelay, *msgToUpdate);
+            // Keep the period when falling behind, but don't send bursts
+            nextEntry.m_deadline = std::max(entry.m_deadline + entry.m_repeat, now);
+            nextEntry.m_repeat = entry.m_repeat;
+            nextEntry.m_repeatCount = entry.m_repeatCount;
+            if (nextEntry.m_repeatCount != 0U) {
+                --nextEntry.m_repeatCount;
             }
 
-            auto clonedMsg = m_protocol->cloneMessage(*msgToSend);
-            // TODO copy extra properties
+            nextEntry.m_frame = entry.m_frame;
+            push(std::move(nextEntry));
+        }
 
-            std::swap(clonedMsg, msgToSend);
-            property::message::Delay().setTo(newDelay, *clonedMsg);
+        if (framesMode) {
+            SentFrame sentFrame;
+            sentFrame.m_frame = std::move(entry.m_frame);
+            sentFrame.m_msg = std::move(sentMsg);
+            m_sentFrames.push_back(std::move(sentFrame));
+            continue;
+        }
 
-            if (repeatCount != 0) {
-                property::message::RepeatCount().setTo(repeatCount - 1, *clonedMsg);
-            }
+        nextMsgsToSend.push_back(std::move(sentMsg));
+    }
+    m_due.clear();
+
+    scheduleNext();
 
-            m_msgsToSend.insert(reinsertIter, std::move(clonedMsg));
+    if ((!nextMsgsToSend.empty()) && m_sendCallback) {
+        m_sendCallback(std::move(nextMsgsToSend));
+    }
+
+    for (auto& sentFrame : m_sentFrames) {
+        m_sendFrameCallback(sentFrame.m_frame, std::move(sentFrame.m_msg));
+    }
+    m_sentFrames.clear();
+
+    if (m_running && m_pending.empty()) {
+        m_running = false;
+        if (m_sendCompleteCallback) {
+            m_sendCompleteCallback();
         }
     }
+}
+
+void MsgSendMgrImpl::push(Entry&& entry)
+{
+    entry.m_seq = m_nextSeq;
+    ++m_nextSeq;
+    m_pending.push_back(std::move(entry));
+    std::push_heap(m_pending.begin(), m_pending.end(), EntryLater());
+}
 
-    if (!m_msgsToSend.empty()) {
-        auto& msg = m_msgsToSend.front();
-        assert(msg);
-        auto delay = property::message::Delay().getFrom(*msg);
-        assert(0 < delay);
-        property::message::Delay().setTo(0, *msg);
-        m_timer.setSingleShot(true);
-        m_timer.start(static_cast<int>(delay));
+void MsgSendMgrImpl::scheduleNext()
+{
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_deadlinePending = !m_pending.empty();
+        if (m_deadlinePending) {
+            m_nextDeadline = m_pending.front().m_deadline;
+        }
     }
+    m_cond.notify_one();
+}
 
-    if ((!nextMsgsToSend.empty()) && m_sendCallback) {
-        m_sendCallback(std::move(nextMsgsToSend));
+void MsgSendMgrImpl::startTimingThread()
+{
+    if (m_thread.joinable()) {
+        return;
     }
 
-    if (m_msgsToSend.empty() && m_sendCompleteCallback) {
-        m_sendCompleteCallback();
+    m_stopRequested = false;
+    m_thread = std::thread(
+        [this]()
+        {
+            timingLoop();
+        });
+}
+
+void MsgSendMgrImpl::stopTimingThread()
+{
+    if (!m_thread.joinable()) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        m_stopRequested = true;
+    }
+    m_cond.notify_one();
+    m_thread.join();
+}
+
+void MsgSendMgrImpl::timingLoop()
+{
+    std::unique_lock<std::mutex> guard(m_lock);
+    while (!m_stopRequested) {
+        if (!m_deadlinePending) {
+            m_cond.wait(guard);
+            continue;
+        }
+
+        auto deadline = m_nextDeadline;
+        if (Clock::now() < (deadline - SpinInterval)) {
+            // The deadline may get updated while waiting
+            m_cond.wait_until(guard, deadline - SpinInterval);
+            continue;
+        }
+
+        guard.unlock();
+        while (Clock::now() < deadline) {
+            std::this_thread::yield();
+        }
+        guard.lock();
+
+        if ((!m_deadlinePending) || (m_nextDeadline != deadline)) {
+            continue;
+        }
+
+        // Rescheduled by the dispatch
+        m_deadlinePending = false;
+        QMetaObject::invokeMethod(this, "sendPendingAndWait", Qt::QueuedConnection);
     }
 }
+
 }  // namespace comms_champion
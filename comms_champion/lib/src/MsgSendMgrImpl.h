@@ -18,26 +18,36 @@
 #pragma once
 
 #include <memory>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 #include "comms/CompileControl.h"
 
 CC_DISABLE_WARNINGS()
 #include <QtCore/QObject>
-#include <QtCore/QTimer>
 CC_ENABLE_WARNINGS()
 
 #include "comms_champion/MsgSendMgr.h"
 #include "comms_champion/Protocol.h"
+#include "comms_champion/LatencyRecorder.h"
 
 namespace comms_champion
 {
 
+// The pending sends are kept in a heap ordered by absolute deadlines.
+// The dedicated timing thread sleeps until shortly before the earliest
+// deadline, spins for the rest and then invokes the dispatch on the
+// thread owning this object (the sockets are not thread safe).
 class MsgSendMgrImpl : public QObject
 {
     Q_OBJECT
 public:
     typedef MsgSendMgr::MessagesList MessagesList;
     typedef MsgSendMgr::SendMsgsCallbackFunc SendMsgsCallbackFunc;
+    typedef MsgSendMgr::SendFrameCallbackFunc SendFrameCallbackFunc;
     typedef MsgSendMgr::SendCompleteCallbackFunc SendCompleteCallbackFunc;
 
     MsgSendMgrImpl();
@@ -49,6 +59,17 @@ public:
         m_sendCallback = std::forward<TFunc>(func);
     }
 
+    template <typename TFunc>
+    void setSendFrameCallbackFunc(TFunc&& func)
+    {
+        m_sendFrameCallback = std::forward<TFunc>(func);
+    }
+
+    void setSentMsgsRequired(bool value)
+    {
+        m_sentMsgsRequired = value;
+    }
+
     template <typename TFunc>
     void setSendCompleteCallbackFunc(TFunc&& func)
     {
@@ -59,15 +80,72 @@ public:
 
     void stop();
 
+    const LatencyRecorder& getJitter() const
+    {
+        return m_jitter;
+    }
+
 private slots:
     void sendPendingAndWait();
 
 private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct Entry
+    {
+        Clock::time_point m_deadline;
+        unsigned long long m_seq = 0U;
+        MessagePtr m_msg;
+        DataInfoPtr m_frame;
+        std::chrono::milliseconds m_repeat;
+        unsigned m_repeatCount = 0U; // 0 means forever
+    };
+
+    struct EntryLater
+    {
+        bool operator()(const Entry& first, const Entry& second) const
+        {
+            if (first.m_deadline != second.m_deadline) {
+                return second.m_deadline < first.m_deadline;
+            }
+            return second.m_seq < first.m_seq;
+        }
+    };
+
+    typedef std::vector<Entry> EntriesList;
+
+    struct SentFrame
+    {
+        DataInfoPtr m_frame;
+        MessagePtr m_msg;
+    };
+
+    typedef std::vector<SentFrame> SentFramesList;
+
+    void push(Entry&& entry);
+    void scheduleNext();
+    void startTimingThread();
+    void stopTimingThread();
+    void timingLoop();
+
     SendMsgsCallbackFunc m_sendCallback;
+    SendFrameCallbackFunc m_sendFrameCallback;
     SendCompleteCallbackFunc m_sendCompleteCallback;
     ProtocolPtr m_protocol;
-    MessagesList m_msgsToSend;
-    QTimer m_timer;
+    EntriesList m_pending;
+    EntriesList m_due;
+    SentFramesList m_sentFrames;
+    unsigned long long m_nextSeq = 0U;
+    bool m_running = false;
+    bool m_sentMsgsRequired = true;
+    LatencyRecorder m_jitter;
+
+    std::thread m_thread;
+    std::mutex m_lock;
+    std::condition_variable m_cond;
+    Clock::time_point m_nextDeadline;
+    bool m_deadlinePending = false;
+    bool m_stopRequested = false;
 };
 
 }  // namespace comms_champion
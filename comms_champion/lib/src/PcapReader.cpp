@@ -0,0 +1,1147 @@
+//
+// Copyright 2016 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "comms_champion/PcapReader.h"
+
+#include <cassert>
+#include <cstring>
+#include <algorithm>
+#include <vector>
+#include <limits>
+#include <map>
+#include <unordered_map>
+
+CC_DISABLE_WARNINGS()
+#include <QtCore/QObject>
+#include <QtCore/QFile>
+CC_ENABLE_WARNINGS()
+
+namespace comms_champion
+{
+
+namespace
+{
+
+const std::uint32_t PcapMagicUs = 0xa1b2c3d4;
+const std::uint32_t PcapMagicNs = 0xa1b23c4d;
+const std::uint32_t PcapngShbType = 0x0a0d0d0a;
+const std::uint32_t PcapngByteOrderMagic = 0x1a2b3c4d;
+const std::uint32_t PcapngIdbType = 0x00000001;
+const std::uint32_t PcapngPbType = 0x00000002;
+const std::uint32_t PcapngSpbType = 0x00000003;
+const std::uint32_t PcapngEpbType = 0x00000006;
+const std::uint16_t PcapngTsResolOption = 9U;
+
+const std::size_t PcapHeaderSize = 24U;
+const std::size_t PcapRecordHeaderSize = 16U;
+const std::size_t PcapngBlockMinSize = 12U;
+
+const unsigned LinkTypeNull = 0U;
+const unsigned LinkTypeEthernet = 1U;
+const unsigned LinkTypeRaw = 101U;
+const unsigned LinkTypeLoop = 108U;
+const unsigned LinkTypeLinuxSll = 113U;
+const unsigned LinkTypeIpv4 = 228U;
+const unsigned LinkTypeIpv6 = 229U;
+const unsigned LinkTypeLinuxSll2 = 276U;
+
+const unsigned EtherTypeIpv4 = 0x0800;
+const unsigned EtherTypeIpv6 = 0x86dd;
+const unsigned EtherTypeVlan = 0x8100;
+const unsigned EtherTypeQinQ = 0x88a8;
+const unsigned EtherTypeQinQOld = 0x9100;
+
+const unsigned IpProtoTcp = 6U;
+const unsigned IpProtoUdp = 17U;
+const unsigned Ipv6HopByHop = 0U;
+const unsigned Ipv6Routing = 43U;
+const unsigned Ipv6Fragment = 44U;
+const unsigned Ipv6Auth = 51U;
+const unsigned Ipv6DestOpts = 60U;
+
+const std::uint8_t TcpFin = 0x01;
+const std::uint8_t TcpSyn = 0x02;
+const std::uint8_t TcpRst = 0x04;
+
+const unsigned long long MicrosecondsPerSec = 1000000ULL;
+
+std::uint16_t readBe16(const uchar* pos)
+{
+    return static_cast<std::uint16_t>((static_cast<unsigned>(pos[0]) << 8) | pos[1]);
+}
+
+std::uint32_t readBe32(const uchar* pos)
+{
+    return
+        (static_cast<std::uint32_t>(pos[0]) << 24) |
+        (static_cast<std::uint32_t>(pos[1]) << 16) |
+        (static_cast<std::uint32_t>(pos[2]) << 8) |
+        static_cast<std::uint32_t>(pos[3]);
+}
+
+std::uint16_t readLe16(const uchar* pos)
+{
+    return static_cast<std::uint16_t>((static_cast<unsigned>(pos[1]) << 8) | pos[0]);
+}
+
+std::uint32_t readLe32(const uchar* pos)
+{
+    return
+        (static_cast<std::uint32_t>(pos[3]) << 24) |
+        (static_cast<std::uint32_t>(pos[2]) << 16) |
+        (static_cast<std::uint32_t>(pos[1]) << 8) |
+        static_cast<std::uint32_t>(pos[0]);
+}
+
+struct FlowKey
+{
+    PcapReader::AddressBytes m_src;
+    PcapReader::AddressBytes m_dst;
+    std::uint16_t m_srcPort = 0U;
+    std::uint16_t m_dstPort = 0U;
+
+    bool operator==(const FlowKey& other) const
+    {
+        return
+            (m_srcPort == other.m_srcPort) &&
+            (m_dstPort == other.m_dstPort) &&
+            (m_src == other.m_src) &&
+            (m_dst == other.m_dst);
+    }
+};
+
+struct FlowKeyHash
+{
+    std::size_t operator()(const FlowKey& key) const
+    {
+        // FNV-1a
+        std::size_t hash = static_cast<std::size_t>(14695981039346656037ULL);
+        auto addByte =
+            [&hash](std::uint8_t byte)
+            {
+                hash ^= byte;
+                hash *= static_cast<std::size_t>(1099511628211ULL);
+            };
+
+        for (auto byte : key.m_src) {
+            addByte(byte);
+        }
+
+        for (auto byte : key.m_dst) {
+            addByte(byte);
+        }
+
+        addByte(static_cast<std::uint8_t>(key.m_srcPort));
+        addByte(static_cast<std::uint8_t>(key.m_srcPort >> 8));
+        addByte(static_cast<std::uint8_t>(key.m_dstPort));
+        addByte(static_cast<std::uint8_t>(key.m_dstPort >> 8));
+        return hash;
+    }
+};
+
+struct TcpFlow
+{
+    typedef std::map<std::uint32_t, std::vector<std::uint8_t> > PendingMap;
+
+    FlowKey m_key;
+    unsigned long long m_timestampUs = 0U;
+    unsigned m_streamId = 0U;
+    std::uint32_t m_nextSeq = 0U;
+    bool m_synced = false;
+    PendingMap m_pending;
+    std::size_t m_pendingBytes = 0U;
+};
+
+struct Interface
+{
+    unsigned m_linkType = LinkTypeEthernet;
+    unsigned long long m_unitsPerSec = MicrosecondsPerSec;
+};
+
+// Section and interface description state valid from the offset
+// up to the next checkpoint
+struct Checkpoint
+{
+    unsigned long long m_offset = 0U;
+    bool m_bigEndian = false;
+    std::vector<Interface> m_interfaces;
+};
+
+struct Packet
+{
+    unsigned long long m_timestampUs = 0U;
+    unsigned m_linkType = LinkTypeEthernet;
+    const uchar* m_data = nullptr;
+    std::size_t m_len = 0U;
+};
+
+unsigned long long toMicroseconds(unsigned long long timestamp, unsigned long long unitsPerSec)
+{
+    if (unitsPerSec == MicrosecondsPerSec) {
+        return timestamp;
+    }
+
+    auto secs = timestamp / unitsPerSec;
+    auto frac = timestamp % unitsPerSec;
+
+    // frac * 1000000 / unitsPerSec one decimal digit at a time, so the
+    // intermediate value never exceeds 10 * unitsPerSec
+    while ((std::numeric_limits<unsigned long long>::max() / 10U) < unitsPerSec) {
+        unitsPerSec >>= 1;
+        frac >>= 1;
+    }
+
+    unsigned long long fracUs = 0U;
+    for (auto idx = 0U; idx < 6U; ++idx) {
+        frac *= 10U;
+        fracUs = (fracUs * 10U) + (frac / unitsPerSec);
+        frac %= unitsPerSec;
+    }
+
+    return (secs * MicrosecondsPerSec) + fracUs;
+}
+
+}  // namespace
+
+class PcapReaderImpl
+{
+public:
+    typedef PcapReader::Record Record;
+    typedef PcapReader::Position Position;
+
+    ~PcapReaderImpl()
+    {
+        close();
+    }
+
+    bool open(const QString& filename)
+    {
+        close();
+        m_error.clear();
+        m_file.setFileName(filename);
+        if (!m_file.open(QIODevice::ReadOnly)) {
+            return reportError(QObject::tr("Failed to open ") + filename);
+        }
+
+        auto size = m_file.size();
+        if (size < static_cast<qint64>(PcapReader::MagicSize)) {
+            close();
+            return reportError(QObject::tr("Not a pcap file: ") + filename);
+        }
+
+        m_begin = m_file.map(0, size);
+        if (m_begin == nullptr) {
+            close();
+            return reportError(QObject::tr("Failed to map ") + filename);
+        }
+
+        m_end = m_begin + size;
+        if (!readFileHeader()) {
+            close();
+            return false;
+        }
+
+        m_dataStart = m_pos;
+        return true;
+    }
+
+    void close()
+    {
+        if (m_begin != nullptr) {
+            m_file.unmap(m_begin);
+        }
+        m_file.close();
+        m_begin = nullptr;
+        m_end = nullptr;
+        m_pos = nullptr;
+        m_dataStart = nullptr;
+        m_checkpoints.clear();
+        m_scannedEnd = 0U;
+        resetFlows();
+    }
+
+    bool isOpen() const
+    {
+        return m_begin != nullptr;
+    }
+
+    bool readNext(Record& record)
+    {
+        if (m_begin == nullptr) {
+            return false;
+        }
+
+        if ((m_drainFlow != nullptr) && drainPending(*m_drainFlow, record)) {
+            return true;
+        }
+        m_drainFlow = nullptr;
+
+        Packet packet;
+        while (readPacket(packet)) {
+            if (processPacket(packet, record)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    Position position() const
+    {
+        if (m_begin == nullptr) {
+            return 0U;
+        }
+        return static_cast<Position>(m_pos - m_begin);
+    }
+
+    bool seek(Position pos)
+    {
+        if (m_begin == nullptr) {
+            return false;
+        }
+
+        auto fileSize = static_cast<Position>(m_end - m_begin);
+        auto dataStart = static_cast<Position>(m_dataStart - m_begin);
+        if ((pos < dataStart) || (fileSize < pos)) {
+            return false;
+        }
+
+        resetFlows();
+        if (!m_pcapng) {
+            m_pos = m_begin + pos;
+            return true;
+        }
+
+        // Section and interfaces description blocks before the position
+        // need to be known, only the blocks beyond the scanned area are read
+        if (pos <= m_scannedEnd) {
+            restoreCheckpoint(pos);
+            m_pos = m_begin + pos;
+            return (pos == m_scannedEnd) || isBlockStart(m_pos);
+        }
+
+        restoreCheckpoint(m_scannedEnd);
+        m_pos = m_begin + m_scannedEnd;
+        while (m_pos < (m_begin + pos)) {
+            std::uint32_t type = 0U;
+            const uchar* body = nullptr;
+            std::size_t bodyLen = 0U;
+            if (!readBlock(type, body, bodyLen)) {
+                return false;
+            }
+        }
+
+        return m_pos == (m_begin + pos);
+    }
+
+    void rewind()
+    {
+        if (m_begin == nullptr) {
+            return;
+        }
+
+        seek(static_cast<Position>(m_dataStart - m_begin));
+    }
+
+    const QString& errorString() const
+    {
+        return m_error;
+    }
+
+    std::uint16_t m_portFilter = 0U;
+    std::size_t m_maxPendingBytes = PcapReader::DefaultMaxPendingBytes;
+
+private:
+    typedef std::unordered_map<FlowKey, TcpFlow, FlowKeyHash> TcpFlowsMap;
+    typedef std::unordered_map<FlowKey, unsigned, FlowKeyHash> UdpFlowsMap;
+    typedef std::vector<Checkpoint> CheckpointsList;
+
+    bool reportError(const QString& msg)
+    {
+        m_error = msg;
+        return false;
+    }
+
+    std::uint16_t read16(const uchar* pos) const
+    {
+        if (m_bigEndian) {
+            return readBe16(pos);
+        }
+        return readLe16(pos);
+    }
+
+    std::uint32_t read32(const uchar* pos) const
+    {
+        if (m_bigEndian) {
+            return readBe32(pos);
+        }
+        return readLe32(pos);
+    }
+
+    void resetFlows()
+    {
+        m_tcpFlows.clear();
+        m_udpFlows.clear();
+        m_drainFlow = nullptr;
+        m_drainBuf.clear();
+    }
+
+    bool readFileHeader()
+    {
+        m_pos = m_begin;
+        auto magic = readLe32(m_begin);
+        if (magic == PcapngShbType) {
+            m_pcapng = true;
+            m_interfaces.clear();
+            m_checkpoints.clear();
+            m_scannedEnd = 0U;
+            addCheckpoint(0U);
+            std::uint32_t type = 0U;
+            const uchar* body = nullptr;
+            std::size_t bodyLen = 0U;
+            if (!readBlock(type, body, bodyLen)) {
+                return reportError(QObject::tr("Invalid pcapng section header."));
+            }
+
+            // Data reading starts from the section header to process
+            // it again after rewind.
+            m_pos = m_begin;
+            return true;
+        }
+
+        m_pcapng = false;
+        if ((magic == PcapMagicUs) || (magic == PcapMagicNs)) {
+            m_bigEndian = false;
+        }
+        else if ((readBe32(m_begin) == PcapMagicUs) || (readBe32(m_begin) == PcapMagicNs)) {
+            m_bigEndian = true;
+        }
+        else {
+            return reportError(QObject::tr("Unknown capture file format."));
+        }
+
+        if (static_cast<std::size_t>(m_end - m_begin) < PcapHeaderSize) {
+            return reportError(QObject::tr("Truncated pcap file header."));
+        }
+
+        Interface iface;
+        iface.m_linkType = read32(m_begin + 20) & 0xffff;
+        if (read32(m_begin) == PcapMagicNs) {
+            iface.m_unitsPerSec = 1000000000ULL;
+        }
+        m_interfaces.assign(1U, iface);
+        m_pos = m_begin + PcapHeaderSize;
+        return true;
+    }
+
+    // Reads next pcapng block, processes section and interface description
+    // blocks, returns false at the end or on error
+    bool readBlock(std::uint32_t& type, const uchar*& body, std::size_t& bodyLen)
+    {
+        auto remaining = static_cast<std::size_t>(m_end - m_pos);
+        if (remaining < PcapngBlockMinSize) {
+            return false;
+        }
+
+        type = readLe32(m_pos);
+        if (type == PcapngShbType) {
+            auto byteOrder = readLe32(m_pos + 8);
+            if (byteOrder == PcapngByteOrderMagic) {
+                m_bigEndian = false;
+            }
+            else if (readBe32(m_pos + 8) == PcapngByteOrderMagic) {
+                m_bigEndian = true;
+            }
+            else {
+                return reportError(QObject::tr("Invalid pcapng byte order magic."));
+            }
+            m_interfaces.clear();
+        }
+        else {
+            type = read32(m_pos);
+        }
+
+        std::size_t blockLen = read32(m_pos + 4);
+        if ((blockLen < PcapngBlockMinSize) ||
+            ((blockLen & 0x3) != 0U) ||
+            (remaining < blockLen)) {
+            // Truncated capture is treated as its end
+            return false;
+        }
+
+        body = m_pos + 8;
+        bodyLen = blockLen - PcapngBlockMinSize;
+        m_pos += blockLen;
+
+        if (type == PcapngIdbType) {
+            readInterface(body, bodyLen);
+        }
+
+        auto offset = static_cast<Position>(m_pos - m_begin);
+        if (((type == PcapngShbType) || (type == PcapngIdbType)) &&
+            (m_checkpoints.back().m_offset < offset)) {
+            addCheckpoint(offset);
+        }
+        m_scannedEnd = std::max(m_scannedEnd, offset);
+        return true;
+    }
+
+    // Cheap check of the block boundary, the block total length
+    // is repeated at its end
+    bool isBlockStart(const uchar* pos) const
+    {
+        auto remaining = static_cast<std::size_t>(m_end - pos);
+        if (remaining < PcapngBlockMinSize) {
+            return false;
+        }
+
+        if (readLe32(pos) == PcapngShbType) {
+            return true;
+        }
+
+        std::size_t blockLen = read32(pos + 4);
+        return
+            (PcapngBlockMinSize <= blockLen) &&
+            ((blockLen & 0x3) == 0U) &&
+            (blockLen <= remaining) &&
+            (read32(pos + blockLen - 4) == blockLen);
+    }
+
+    void addCheckpoint(Position offset)
+    {
+        Checkpoint checkpoint;
+        checkpoint.m_offset = offset;
+        checkpoint.m_bigEndian = m_bigEndian;
+        checkpoint.m_interfaces = m_interfaces;
+        m_checkpoints.push_back(std::move(checkpoint));
+    }
+
+    void restoreCheckpoint(Position pos)
+    {
+        auto iter =
+            std::upper_bound(
+                m_checkpoints.begin(), m_checkpoints.end(), pos,
+                [](Position value, const Checkpoint& checkpoint) -> bool
+                {
+                    return value < checkpoint.m_offset;
+                });
+
+        assert(iter != m_checkpoints.begin());
+        --iter;
+        m_bigEndian = iter->m_bigEndian;
+        m_interfaces = iter->m_interfaces;
+    }
+
+    void readInterface(const uchar* body, std::size_t bodyLen)
+    {
+        Interface iface;
+        if (bodyLen < 8U) {
+            m_interfaces.push_back(iface);
+            return;
+        }
+
+        iface.m_linkType = read16(body);
+        auto* opt = body + 8;
+        auto* optEnd = body + bodyLen;
+        while (static_cast<std::size_t>(optEnd - opt) >= 4U) {
+            auto code = read16(opt);
+            std::size_t len = read16(opt + 2);
+            opt += 4;
+            if ((code == 0U) || (static_cast<std::size_t>(optEnd - opt) < len)) {
+                break;
+            }
+
+            if ((code == PcapngTsResolOption) && (len == 1U)) {
+                auto resol = static_cast<unsigned>(opt[0]);
+                unsigned long long units = 1U;
+                auto exp = resol & 0x7f;
+                if ((resol & 0x80) != 0U) {
+                    units <<= std::min(exp, 63U);
+                }
+                else {
+                    for (auto idx = 0U; idx < std::min(exp, 19U); ++idx) {
+                        units *= 10U;
+                    }
+                }
+                iface.m_unitsPerSec = units;
+            }
+
+            auto paddedLen = (len + 3U) & ~static_cast<std::size_t>(0x3);
+            if (static_cast<std::size_t>(optEnd - opt) < paddedLen) {
+                break;
+            }
+            opt += paddedLen;
+        }
+        m_interfaces.push_back(iface);
+    }
+
+    bool readPacket(Packet& packet)
+    {
+        if (!m_pcapng) {
+            auto remaining = static_cast<std::size_t>(m_end - m_pos);
+            if (remaining < PcapRecordHeaderSize) {
+                return false;
+            }
+
+            std::size_t capLen = read32(m_pos + 8);
+            if ((remaining - PcapRecordHeaderSize) < capLen) {
+                return false;
+            }
+
+            assert(!m_interfaces.empty());
+            auto& iface = m_interfaces.front();
+            auto secs = static_cast<unsigned long long>(read32(m_pos));
+            auto frac = static_cast<unsigned long long>(read32(m_pos + 4));
+            packet.m_timestampUs =
+                (secs * MicrosecondsPerSec) + toMicroseconds(frac, iface.m_unitsPerSec);
+            packet.m_linkType = iface.m_linkType;
+            packet.m_data = m_pos + PcapRecordHeaderSize;
+            packet.m_len = capLen;
+            m_pos += PcapRecordHeaderSize + capLen;
+            return true;
+        }
+
+        std::uint32_t type = 0U;
+        const uchar* body = nullptr;
+        std::size_t bodyLen = 0U;
+        while (readBlock(type, body, bodyLen)) {
+            unsigned ifaceIdx = 0U;
+            unsigned long long timestamp = 0U;
+            std::size_t capLen = 0U;
+            const uchar* data = nullptr;
+            if ((type == PcapngEpbType) && (20U <= bodyLen)) {
+                ifaceIdx = read32(body);
+                timestamp =
+                    (static_cast<unsigned long long>(read32(body + 4)) << 32) |
+                    read32(body + 8);
+                capLen = std::min(static_cast<std::size_t>(read32(body + 12)), bodyLen - 20U);
+                data = body + 20;
+            }
+            else if ((type == PcapngSpbType) && (4U <= bodyLen)) {
+                capLen = std::min(static_cast<std::size_t>(read32(body)), bodyLen - 4U);
+                data = body + 4;
+            }
+            else if ((type == PcapngPbType) && (20U <= bodyLen)) {
+                ifaceIdx = read16(body);
+                timestamp =
+                    (static_cast<unsigned long long>(read32(body + 4)) << 32) |
+                    read32(body + 8);
+                capLen = std::min(static_cast<std::size_t>(read32(body + 12)), bodyLen - 20U);
+                data = body + 20;
+            }
+            else {
+                continue;
+            }
+
+            if (m_interfaces.size() <= ifaceIdx) {
+                continue;
+            }
+
+            auto& iface = m_interfaces[ifaceIdx];
+            packet.m_timestampUs = toMicroseconds(timestamp, iface.m_unitsPerSec);
+            packet.m_linkType = iface.m_linkType;
+            packet.m_data = data;
+            packet.m_len = capLen;
+            return true;
+        }
+        return false;
+    }
+
+    bool processPacket(const Packet& packet, Record& record)
+    {
+        auto* data = packet.m_data;
+        auto len = packet.m_len;
+        unsigned etherType = 0U;
+        switch (packet.m_linkType) {
+        case LinkTypeEthernet:
+            if (len < 14U) {
+                return false;
+            }
+            etherType = readBe16(data + 12);
+            data += 14;
+            len -= 14;
+            while ((etherType == EtherTypeVlan) ||
+                   (etherType == EtherTypeQinQ) ||
+                   (etherType == EtherTypeQinQOld)) {
+                if (len < 4U) {
+                    return false;
+                }
+                etherType = readBe16(data + 2);
+                data += 4;
+                len -= 4;
+            }
+            break;
+
+        case LinkTypeLinuxSll:
+            if (len < 16U) {
+                return false;
+            }
+            etherType = readBe16(data + 14);
+            data += 16;
+            len -= 16;
+            break;
+
+        case LinkTypeLinuxSll2:
+            if (len < 20U) {
+                return false;
+            }
+            etherType = readBe16(data);
+            data += 20;
+            len -= 20;
+            break;
+
+        case LinkTypeNull:
+        case LinkTypeLoop:
+            // Address family is in byte order of the capturing host,
+            // version of IP header is checked instead.
+            if (len < 4U) {
+                return false;
+            }
+            data += 4;
+            len -= 4;
+            break;
+
+        case LinkTypeRaw:
+        case LinkTypeIpv4:
+        case LinkTypeIpv6:
+            break;
+
+        default:
+            return false;
+        }
+
+        if ((etherType == 0U) && (0U < len)) {
+            auto version = static_cast<unsigned>(data[0] >> 4);
+            if (version == 4U) {
+                etherType = EtherTypeIpv4;
+            }
+            else if (version == 6U) {
+                etherType = EtherTypeIpv6;
+            }
+        }
+
+        unsigned proto = 0U;
+        if (etherType == EtherTypeIpv4) {
+            if (!parseIpv4(data, len, proto, record)) {
+                return false;
+            }
+        }
+        else if (etherType == EtherTypeIpv6) {
+            if (!parseIpv6(data, len, proto, record)) {
+                return false;
+            }
+        }
+        else {
+            return false;
+        }
+
+        record.m_timestampUs = packet.m_timestampUs;
+        if (proto == IpProtoUdp) {
+            return processUdp(data, len, record);
+        }
+
+        if (proto == IpProtoTcp) {
+            return processTcp(data, len, record);
+        }
+
+        return false;
+    }
+
+    static bool parseIpv4(const uchar*& data, std::size_t& len, unsigned& proto, Record& record)
+    {
+        if ((len < 20U) || ((data[0] >> 4) != 4U)) {
+            return false;
+        }
+
+        std::size_t hdrLen = static_cast<std::size_t>(data[0] & 0xf) * 4U;
+        std::size_t totalLen = readBe16(data + 2);
+        if ((hdrLen < 20U) || (totalLen < hdrLen) || (len < hdrLen)) {
+            return false;
+        }
+
+        if ((readBe16(data + 6) & 0x3fff) != 0U) {
+            // Fragmented
+            return false;
+        }
+
+        proto = data[9];
+        mapIpv4(data + 12, record.m_srcAddress);
+        mapIpv4(data + 16, record.m_dstAddress);
+
+        // Ethernet padding is excluded by the total length
+        len = std::min(len, totalLen) - hdrLen;
+        data += hdrLen;
+        return true;
+    }
+
+    static bool parseIpv6(const uchar*& data, std::size_t& len, unsigned& proto, Record& record)
+    {
+        static const std::size_t HdrLen = 40U;
+        if ((len < HdrLen) || ((data[0] >> 4) != 6U)) {
+            return false;
+        }
+
+        std::size_t payloadLen = readBe16(data + 4);
+        unsigned nextHdr = data[6];
+        std::copy_n(data + 8, record.m_srcAddress.size(), record.m_srcAddress.begin());
+        std::copy_n(data + 24, record.m_dstAddress.size(), record.m_dstAddress.begin());
+
+        len -= HdrLen;
+        if (payloadLen != 0U) {
+            len = std::min(len, payloadLen);
+        }
+        data += HdrLen;
+
+        while ((nextHdr == Ipv6HopByHop) ||
+               (nextHdr == Ipv6Routing) ||
+               (nextHdr == Ipv6DestOpts) ||
+               (nextHdr == Ipv6Auth)) {
+            if (len < 8U) {
+                return false;
+            }
+
+            std::size_t extLen = (static_cast<std::size_t>(data[1]) + 1U) * 8U;
+            if (nextHdr == Ipv6Auth) {
+                extLen = (static_cast<std::size_t>(data[1]) + 2U) * 4U;
+            }
+
+            if (len < extLen) {
+                return false;
+            }
+
+            nextHdr = data[0];
+            data += extLen;
+            len -= extLen;
+        }
+
+        if (nextHdr == Ipv6Fragment) {
+            return false;
+        }
+
+        proto = nextHdr;
+        return true;
+    }
+
+    static void mapIpv4(const uchar* addr, PcapReader::AddressBytes& mapped)
+    {
+        std::fill(mapped.begin(), mapped.begin() + 10, std::uint8_t(0));
+        mapped[10] = 0xff;
+        mapped[11] = 0xff;
+        std::copy_n(addr, 4, mapped.begin() + 12);
+    }
+
+    bool portsAccepted(const Record& record) const
+    {
+        return
+            (m_portFilter == 0U) ||
+            (record.m_srcPort == m_portFilter) ||
+            (record.m_dstPort == m_portFilter);
+    }
+
+    FlowKey flowKey(const Record& record) const
+    {
+        FlowKey key;
+        key.m_src = record.m_srcAddress;
+        key.m_dst = record.m_dstAddress;
+        key.m_srcPort = record.m_srcPort;
+        key.m_dstPort = record.m_dstPort;
+        return key;
+    }
+
+    bool processUdp(const uchar* data, std::size_t len, Record& record)
+    {
+        if (len < 8U) {
+            return false;
+        }
+
+        record.m_transport = PcapReader::Transport::Udp;
+        record.m_srcPort = readBe16(data);
+        record.m_dstPort = readBe16(data + 2);
+        if (!portsAccepted(record)) {
+            return false;
+        }
+
+        std::size_t udpLen = readBe16(data + 4);
+        if (udpLen < 8U) {
+            // Jumbogram or broken header, use captured length
+            udpLen = len;
+        }
+
+        auto payloadLen = std::min(len, udpLen) - 8U;
+        if (payloadLen == 0U) {
+            return false;
+        }
+
+        auto iter = m_udpFlows.find(flowKey(record));
+        if (iter == m_udpFlows.end()) {
+            iter = m_udpFlows.insert(std::make_pair(flowKey(record), m_nextStreamId)).first;
+            ++m_nextStreamId;
+        }
+
+        record.m_streamId = iter->second;
+        record.m_data = data + 8;
+        record.m_dataLen = payloadLen;
+        return true;
+    }
+
+    bool processTcp(const uchar* data, std::size_t len, Record& record)
+    {
+        if (len < 20U) {
+            return false;
+        }
+
+        std::size_t hdrLen = static_cast<std::size_t>(data[12] >> 4) * 4U;
+        if ((hdrLen < 20U) || (len < hdrLen)) {
+            return false;
+        }
+
+        record.m_transport = PcapReader::Transport::Tcp;
+        record.m_srcPort = readBe16(data);
+        record.m_dstPort = readBe16(data + 2);
+        if (!portsAccepted(record)) {
+            return false;
+        }
+
+        auto seq = readBe32(data + 4);
+        auto flags = data[13];
+        auto key = flowKey(record);
+        if ((flags & TcpRst) != 0U) {
+            m_tcpFlows.erase(key);
+            return false;
+        }
+
+        auto iter = m_tcpFlows.find(key);
+        if (iter == m_tcpFlows.end()) {
+            iter = m_tcpFlows.insert(std::make_pair(key, TcpFlow())).first;
+            iter->second.m_key = key;
+            iter->second.m_streamId = m_nextStreamId;
+            ++m_nextStreamId;
+        }
+
+        auto& flow = iter->second;
+        flow.m_timestampUs = record.m_timestampUs;
+        if ((flags & TcpSyn) != 0U) {
+            if (flow.m_synced && (flow.m_nextSeq != (seq + 1U))) {
+                // New connection reusing the same ports
+                flow = TcpFlow();
+                flow.m_key = key;
+                flow.m_timestampUs = record.m_timestampUs;
+                flow.m_streamId = m_nextStreamId;
+                ++m_nextStreamId;
+            }
+            ++seq;
+            flow.m_nextSeq = seq;
+            flow.m_synced = true;
+        }
+
+        auto* payload = data + hdrLen;
+        auto payloadLen = len - hdrLen;
+        if (payloadLen == 0U) {
+            return false;
+        }
+
+        if (!flow.m_synced) {
+            flow.m_nextSeq = seq;
+            flow.m_synced = true;
+        }
+
+        record.m_streamId = flow.m_streamId;
+        auto offset = static_cast<std::int32_t>(seq - flow.m_nextSeq);
+        if (0 < offset) {
+            storePending(flow, seq, payload, payloadLen);
+            if (flow.m_pendingBytes <= m_maxPendingBytes) {
+                return false;
+            }
+
+            skipGap(flow);
+            return drainPending(flow, record);
+        }
+
+        auto skip = static_cast<std::size_t>(-static_cast<std::int64_t>(offset));
+        if (payloadLen <= skip) {
+            // Retransmission
+            return false;
+        }
+
+        record.m_data = payload + skip;
+        record.m_dataLen = payloadLen - skip;
+        flow.m_nextSeq += static_cast<std::uint32_t>(record.m_dataLen);
+        if ((flags & TcpFin) != 0U) {
+            ++flow.m_nextSeq;
+        }
+
+        if (!flow.m_pending.empty()) {
+            m_drainFlow = &flow;
+        }
+        return true;
+    }
+
+    static void storePending(TcpFlow& flow, std::uint32_t seq, const uchar* data, std::size_t len)
+    {
+        auto& stored = flow.m_pending[seq];
+        if (len <= stored.size()) {
+            return;
+        }
+
+        flow.m_pendingBytes += len - stored.size();
+        stored.assign(data, data + len);
+    }
+
+    static void skipGap(TcpFlow& flow)
+    {
+        assert(!flow.m_pending.empty());
+        auto closest = flow.m_pending.begin();
+        for (auto iter = flow.m_pending.begin(); iter != flow.m_pending.end(); ++iter) {
+            if ((iter->first - flow.m_nextSeq) < (closest->first - flow.m_nextSeq)) {
+                closest = iter;
+            }
+        }
+        flow.m_nextSeq = closest->first;
+    }
+
+    bool drainPending(TcpFlow& flow, Record& record)
+    {
+        auto iter = flow.m_pending.begin();
+        while (iter != flow.m_pending.end()) {
+            auto offset = static_cast<std::int32_t>(iter->first - flow.m_nextSeq);
+            if (0 < offset) {
+                ++iter;
+                continue;
+            }
+
+            auto skip = static_cast<std::size_t>(-static_cast<std::int64_t>(offset));
+            auto& segment = iter->second;
+            flow.m_pendingBytes -= segment.size();
+            if (segment.size() <= skip) {
+                iter = flow.m_pending.erase(iter);
+                continue;
+            }
+
+            m_drainBuf.swap(segment);
+            flow.m_pending.erase(iter);
+            record.m_timestampUs = flow.m_timestampUs;
+            record.m_transport = PcapReader::Transport::Tcp;
+            record.m_srcAddress = flow.m_key.m_src;
+            record.m_dstAddress = flow.m_key.m_dst;
+            record.m_srcPort = flow.m_key.m_srcPort;
+            record.m_dstPort = flow.m_key.m_dstPort;
+            record.m_streamId = flow.m_streamId;
+            record.m_data = m_drainBuf.data() + skip;
+            record.m_dataLen = m_drainBuf.size() - skip;
+            flow.m_nextSeq += static_cast<std::uint32_t>(record.m_dataLen);
+            m_drainFlow = &flow;
+            return true;
+        }
+        return false;
+    }
+
+    QFile m_file;
+    uchar* m_begin = nullptr;
+    const uchar* m_end = nullptr;
+    const uchar* m_pos = nullptr;
+    const uchar* m_dataStart = nullptr;
+    bool m_pcapng = false;
+    bool m_bigEndian = false;
+    std::vector<Interface> m_interfaces;
+    CheckpointsList m_checkpoints;
+    Position m_scannedEnd = 0U;
+    TcpFlowsMap m_tcpFlows;
+    UdpFlowsMap m_udpFlows;
+    TcpFlow* m_drainFlow = nullptr;
+    std::vector<std::uint8_t> m_drainBuf;
+    unsigned m_nextStreamId = 1U;
+    QString m_error;
+};
+
+PcapReader::PcapReader()
+  : m_impl(new PcapReaderImpl())
+{
+}
+
+PcapReader::~PcapReader() = default;
+
+bool PcapReader::open(const QString& filename)
+{
+    return m_impl->open(filename);
+}
+
+void PcapReader::close()
+{
+    m_impl->close();
+}
+
+bool PcapReader::isOpen() const
+{
+    return m_impl->isOpen();
+}
+
+void PcapReader::setPortFilter(std::uint16_t port)
+{
+    m_impl->m_portFilter = port;
+}
+
+void PcapReader::setMaxPendingBytes(std::size_t value)
+{
+    m_impl->m_maxPendingBytes = value;
+}
+
+bool PcapReader::readNext(Record& record)
+{
+    return m_impl->readNext(record);
+}
+
+PcapReader::Position PcapReader::position() const
+{
+    return m_impl->position();
+}
+
+bool PcapReader::seek(Position pos)
+{
+    return m_impl->seek(pos);
+}
+
+void PcapReader::rewind()
+{
+    m_impl->rewind();
+}
+
+bool PcapReader::hasError() const
+{
+    return !m_impl->errorString().isEmpty();
+}
+
+const QString& PcapReader::errorString() const
+{
+    return m_impl->errorString();
+}
+
+bool PcapReader::isPcapHeader(const QByteArray& data)
+{
+    if (data.size() < static_cast<int>(MagicSize)) {
+        return false;
+    }
+
+    auto* bytes = reinterpret_cast<const uchar*>(data.constData());
+    auto le = readLe32(bytes);
+    auto be = readBe32(bytes);
+    return
+        (le == PcapngShbType) ||
+        (le == PcapMagicUs) || (le == PcapMagicNs) ||
+        (be == PcapMagicUs) || (be == PcapMagicNs);
+}
+
+}  // namespace comms_champion
@@ -0,0 +1,236 @@
+//
+// Copyright 2016 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "comms_champion/PcapWriter.h"
+
+#include <cassert>
+#include <algorithm>
+
+CC_DISABLE_WARNINGS()
+#include <QtCore/QFile>
+#include <QtCore/QByteArray>
+CC_ENABLE_WARNINGS()
+
+namespace comms_champion
+{
+
+namespace
+{
+
+const std::uint32_t PcapMagicUs = 0xa1b2c3d4;
+const std::uint32_t LinkTypeRaw = 101U;
+const std::uint32_t SnapLen = 65535U;
+const std::size_t Ipv4HdrLen = 20U;
+const std::size_t UdpHdrLen = 8U;
+const std::size_t MaxDatagramPayload = 0xffff - Ipv4HdrLen - UdpHdrLen;
+const std::uint8_t IpProtoUdp = 17U;
+const std::uint8_t Loopback[] = {127, 0, 0, 1};
+const int FlushThreshold = 256 * 1024;
+
+void writeLe(QByteArray& buf, std::uint32_t value, std::size_t size)
+{
+    for (auto idx = 0U; idx < size; ++idx) {
+        buf.append(static_cast<char>(static_cast<std::uint8_t>(value >> (idx * 8U))));
+    }
+}
+
+void writeBe(QByteArray& buf, std::uint32_t value, std::size_t size)
+{
+    for (auto idx = 0U; idx < size; ++idx) {
+        buf.append(static_cast<char>(static_cast<std::uint8_t>(value >> ((size - idx - 1U) * 8U))));
+    }
+}
+
+std::uint16_t ipChecksum(const char* data, std::size_t len)
+{
+    std::uint32_t sum = 0U;
+    for (auto idx = 0U; (idx + 1U) < len; idx += 2U) {
+        sum +=
+            (static_cast<std::uint32_t>(static_cast<std::uint8_t>(data[idx])) << 8) |
+            static_cast<std::uint8_t>(data[idx + 1U]);
+    }
+
+    while ((sum >> 16) != 0U) {
+        sum = (sum & 0xffff) + (sum >> 16);
+    }
+    return static_cast<std::uint16_t>(~sum);
+}
+
+}  // namespace
+
+class PcapWriterImpl
+{
+public:
+    ~PcapWriterImpl()
+    {
+        close();
+    }
+
+    bool open(const QString& filename)
+    {
+        close();
+        m_file.setFileName(filename);
+        if (!m_file.open(QIODevice::WriteOnly)) {
+            return false;
+        }
+
+        m_buf.clear();
+        writeLe(m_buf, PcapMagicUs, 4);
+        writeLe(m_buf, 2U, 2); // version major
+        writeLe(m_buf, 4U, 2); // version minor
+        writeLe(m_buf, 0U, 4); // time zone
+        writeLe(m_buf, 0U, 4); // sigfigs
+        writeLe(m_buf, SnapLen, 4);
+        writeLe(m_buf, LinkTypeRaw, 4);
+        m_ipId = 0U;
+        return true;
+    }
+
+    void close()
+    {
+        if (!m_file.isOpen()) {
+            return;
+        }
+
+        flushBuf();
+        m_file.close();
+    }
+
+    bool isOpen() const
+    {
+        return m_file.isOpen();
+    }
+
+    bool write(
+        unsigned long long timestampUs,
+        const std::uint8_t* data,
+        std::size_t len,
+        bool outgoing)
+    {
+        if (!m_file.isOpen()) {
+            return false;
+        }
+
+        auto srcPort = m_remotePort;
+        auto dstPort = m_localPort;
+        if (outgoing) {
+            std::swap(srcPort, dstPort);
+        }
+
+        do {
+            auto chunkLen = std::min(len, MaxDatagramPayload);
+            auto packetLen = Ipv4HdrLen + UdpHdrLen + chunkLen;
+            auto capLen = std::min(packetLen, static_cast<std::size_t>(SnapLen));
+
+            writeLe(m_buf, static_cast<std::uint32_t>(timestampUs / 1000000ULL), 4);
+            writeLe(m_buf, static_cast<std::uint32_t>(timestampUs % 1000000ULL), 4);
+            writeLe(m_buf, static_cast<std::uint32_t>(capLen), 4);
+            writeLe(m_buf, static_cast<std::uint32_t>(packetLen), 4);
+
+            auto ipHdrPos = m_buf.size();
+            writeBe(m_buf, 0x45, 1); // version + header length
+            writeBe(m_buf, 0U, 1); // DSCP
+            writeBe(m_buf, static_cast<std::uint32_t>(packetLen), 2);
+            writeBe(m_buf, m_ipId, 2);
+            writeBe(m_buf, 0x4000, 2); // don't fragment
+            writeBe(m_buf, 64U, 1); // TTL
+            writeBe(m_buf, IpProtoUdp, 1);
+            writeBe(m_buf, 0U, 2); // checksum, updated below
+            m_buf.append(reinterpret_cast<const char*>(Loopback), sizeof(Loopback));
+            m_buf.append(reinterpret_cast<const char*>(Loopback), sizeof(Loopback));
+            auto checksum = ipChecksum(m_buf.constData() + ipHdrPos, Ipv4HdrLen);
+            m_buf[ipHdrPos + 10] = static_cast<char>(checksum >> 8);
+            m_buf[ipHdrPos + 11] = static_cast<char>(checksum & 0xff);
+            ++m_ipId;
+
+            writeBe(m_buf, srcPort, 2);
+            writeBe(m_buf, dstPort, 2);
+            writeBe(m_buf, static_cast<std::uint32_t>(UdpHdrLen + chunkLen), 2);
+            writeBe(m_buf, 0U, 2); // no checksum
+
+            auto payloadLen = capLen - (Ipv4HdrLen + UdpHdrLen);
+            m_buf.append(reinterpret_cast<const char*>(data), static_cast<int>(payloadLen));
+            data += chunkLen;
+            len -= chunkLen;
+        } while (0U < len);
+
+        if (FlushThreshold <= m_buf.size()) {
+            return flushBuf();
+        }
+        return true;
+    }
+
+    std::uint16_t m_localPort = PcapWriter::DefaultLocalPort;
+    std::uint16_t m_remotePort = PcapWriter::DefaultRemotePort;
+
+private:
+    bool flushBuf()
+    {
+        if (m_buf.isEmpty()) {
+            return true;
+        }
+
+        auto written = m_file.write(m_buf);
+        bool result = (written == m_buf.size());
+        m_buf.clear();
+        return result;
+    }
+
+    QFile m_file;
+    QByteArray m_buf;
+    std::uint16_t m_ipId = 0U;
+};
+
+PcapWriter::PcapWriter()
+  : m_impl(new PcapWriterImpl())
+{
+}
+
+PcapWriter::~PcapWriter() = default;
+
+bool PcapWriter::open(const QString& filename)
+{
+    return m_impl->open(filename);
+}
+
+void PcapWriter::close()
+{
+    m_impl->close();
+}
+
+bool PcapWriter::isOpen() const
+{
+    return m_impl->isOpen();
+}
+
+void PcapWriter::setPorts(std::uint16_t localPort, std::uint16_t remotePort)
+{
+    m_impl->m_localPort = localPort;
+    m_impl->m_remotePort = remotePort;
+}
+
+bool PcapWriter::write(
+    unsigned long long timestampUs,
+    const std::uint8_t* data,
+    std::size_t len,
+    bool outgoing)
+{
+    return m_impl->write(timestampUs, data, len, outgoing);
+}
+
+}  // namespace comms_champion
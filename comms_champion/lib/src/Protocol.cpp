@@ -26,6 +26,7 @@ CC_DISABLE_WARNINGS()
 CC_ENABLE_WARNINGS()
 
 #include "comms_champion/property/message.h"
+#include "comms_champion/EndpointRegistry.h"
 
 namespace comms_champion
 {
@@ -66,6 +67,11 @@ DataInfoPtr Protocol::write(Message& msg)
     return writeImpl(msg);
 }
 
+void Protocol::closeStream(DataInfo::StreamId streamId)
+{
+    closeStreamImpl(streamId);
+}
+
 Protocol::MessagesList Protocol::createAllMessages()
 {
     return createAllMessagesImpl();
@@ -145,6 +151,8 @@ MessagePtr Protocol::cloneMessage(const Message& msg)
         setNameToMessageProperties(*clonedMsg);
         updateMessage(*clonedMsg);
         property::message::ExtraInfo().copyFromTo(msg, *clonedMsg);
+        property::message::FromEndpoint().copyFromTo(msg, *clonedMsg);
+        property::message::ToEndpoint().copyFromTo(msg, *clonedMsg);
     }
     return clonedMsg;
 }
@@ -169,6 +177,47 @@ MessagePtr Protocol::createInvalidMessage(const MsgDataSeq& data)
     return invalidMsg;
 }
 
+void Protocol::setEndpointsToMessageProperties(const DataInfo& dataInfo, Message& msg)
+{
+    if (dataInfo.m_fromEndpoint != DataInfo::NoEndpoint) {
+        property::message::FromEndpoint().setTo(dataInfo.m_fromEndpoint, msg);
+    }
+
+    if (dataInfo.m_toEndpoint != DataInfo::NoEndpoint) {
+        property::message::ToEndpoint().setTo(dataInfo.m_toEndpoint, msg);
+    }
+}
+
+QVariantMap Protocol::getExtraInfo(const Message& msg)
+{
+    auto extraInfo = getExtraInfoFromMessageProperties(msg);
+    EndpointRegistry::instanceRef().addToProperties(
+        property::message::FromEndpoint().getFrom(msg, DataInfo::NoEndpoint),
+        property::message::ToEndpoint().getFrom(msg, DataInfo::NoEndpoint),
+        extraInfo);
+    return extraInfo;
+}
+
+void Protocol::resolveEndpoints(Message& msg)
+{
+    auto fromEndpoint = property::message::FromEndpoint().getFrom(msg, DataInfo::NoEndpoint);
+    auto toEndpoint = property::message::ToEndpoint().getFrom(msg, DataInfo::NoEndpoint);
+    if ((fromEndpoint == DataInfo::NoEndpoint) && (toEndpoint == DataInfo::NoEndpoint)) {
+        return;
+    }
+
+    auto extraInfo = getExtraInfoFromMessageProperties(msg);
+    // The ids are kept, they may pin the endpoints in the registry
+    EndpointRegistry::instanceRef().addToProperties(fromEndpoint, toEndpoint, extraInfo);
+    setExtraInfoToMessageProperties(extraInfo, msg);
+    updateMessage(msg);
+}
+
+void Protocol::closeStreamImpl(DataInfo::StreamId streamId)
+{
+    static_cast<void>(streamId);
+}
+
 void Protocol::setNameToMessageProperties(Message& msg)
 {
     property::message::ProtocolName().setTo(name(), msg);
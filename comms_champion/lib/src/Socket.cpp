@@ -62,11 +62,34 @@ void Socket::sendData(DataInfoPtr dataPtr)
     sendDataImpl(std::move(dataPtr));
 }
 
+void Socket::flushSendData()
+{
+    if (!isSocketConnected()) {
+        return;
+    }
+    flushSendDataImpl();
+}
+
 unsigned Socket::connectionProperties() const
 {
     return connectionPropertiesImpl();
 }
 
+std::size_t Socket::pendingBytes() const
+{
+    return pendingBytesImpl();
+}
+
+Socket::StatsList Socket::stats() const
+{
+    return statsImpl();
+}
+
+void Socket::setProtocol(ProtocolPtr protocol)
+{
+    m_protocol = protocol;
+}
+
 bool Socket::startImpl()
 {
     return true;
@@ -85,11 +108,25 @@ void Socket::socketDisconnectImpl()
 {
 }
 
+void Socket::flushSendDataImpl()
+{
+}
+
 unsigned Socket::connectionPropertiesImpl() const
 {
     return 0U;
 }
 
+std::size_t Socket::pendingBytesImpl() const
+{
+    return 0U;
+}
+
+Socket::StatsList Socket::statsImpl() const
+{
+    return StatsList();
+}
+
 void Socket::reportDataReceived(DataInfoPtr dataPtr)
 {
     if (m_dataReceivedCallback) {
@@ -112,4 +149,16 @@ void Socket::reportDisconnected()
     }
 }
 
+void Socket::reportStreamClosed(DataInfo::StreamId streamId)
+{
+    if (m_streamClosedReportCallback) {
+        m_streamClosedReportCallback(streamId);
+    }
+}
+
+ProtocolPtr Socket::getProtocol() const
+{
+    return m_protocol.lock();
+}
+
 }  // namespace comms_champion
@@ -20,6 +20,8 @@
 
 #include <cassert>
 
+#include "comms_champion/HexCodec.h"
+
 namespace comms_champion
 {
 
@@ -57,35 +59,13 @@ bool FieldWrapper::setSerialisedValue(const SerialisedSeq& value)
 
 QString FieldWrapper::getSerialisedString() const
 {
-    auto seq = getSerialisedValue();
-    QString str;
-    for (auto& byte : seq) {
-        str.append(QString("%1").arg((unsigned)byte, 2, 16, QChar('0')));
-    }
-    return str;
+    return encodeHex(getSerialisedValue());
 }
 
 bool FieldWrapper::setSerialisedString(const QString& str)
 {
     assert((str.size() & 0x1) == 0U);
-    SerialisedSeq seq;
-    seq.reserve(str.size() / 2);
-    QString byteStr;
-    for (auto ch : str) {
-        byteStr.append(ch);
-        if (byteStr.size() < 2) {
-            continue;
-        }
-
-        bool ok = false;
-        auto val = byteStr.toUInt(&ok, 16);
-        if (ok) {
-            seq.push_back(static_cast<SerialisedSeq::value_type>(val));
-        }
-        byteStr.clear();
-    }
-
-    return setSerialisedValue(seq);
+    return setSerialisedValue(decodeHex(str, HexDecodeMode::PadBack));
 }
 
 void FieldWrapper::dispatch(FieldWrapperHandler& handler)
@@ -62,6 +62,12 @@ const QByteArray RepeatDurationUnits::PropName = RepeatDurationUnits::Name.toUtf
 const QString RepeatCount::Name("cc.msg_repeat_count");
 const QByteArray RepeatCount::PropName = RepeatCount::Name.toUtf8();
 
+const QString FromEndpoint::Name("cc.msg_from_endpoint");
+const QByteArray FromEndpoint::PropName = FromEndpoint::Name.toUtf8();
+
+const QString ToEndpoint::Name("cc.msg_to_endpoint");
+const QByteArray ToEndpoint::PropName = ToEndpoint::Name.toUtf8();
+
 const QString ScrollPos::Name("cc.msg_scroll_pos");
 const QByteArray ScrollPos::PropName = ScrollPos::Name.toUtf8();
 
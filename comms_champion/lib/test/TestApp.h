@@ -0,0 +1,72 @@
+//
+// Copyright 2016 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <chrono>
+#include <memory>
+
+#include "comms/CompileControl.h"
+
+CC_DISABLE_WARNINGS()
+#include <QtCore/QCoreApplication>
+#include <QtCore/QEventLoop>
+CC_ENABLE_WARNINGS()
+
+namespace comms_champion
+{
+
+namespace test
+{
+
+// Creates the application object required by Qt sockets and timers
+class TestApp
+{
+public:
+    TestApp()
+    {
+        m_argv[0] = &m_name[0];
+        m_app.reset(new QCoreApplication(m_argc, &m_argv[0]));
+    }
+
+private:
+    char m_name[8] = "cc_test";
+    char* m_argv[1];
+    int m_argc = 1;
+    std::unique_ptr<QCoreApplication> m_app;
+};
+
+// Processes events until the condition is satisfied or the time is out
+template <typename TFunc>
+bool processEventsUntil(TFunc&& func, unsigned timeoutMs)
+{
+    auto deadline =
+        std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (!func()) {
+        if (deadline <= std::chrono::steady_clock::now()) {
+            return false;
+        }
+
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 10);
+    }
+    return true;
+}
+
+}  // namespace test
+
+}  // namespace comms_champion
@@ -51,6 +51,7 @@ void EchoSocket::stopImpl()
 
 void EchoSocket::sendDataImpl(DataInfoPtr dataPtr)
 {
+    // In synchronous mode the timer covers senders that don't flush
     m_pendingData.push_back(std::move(dataPtr));
     if (m_timerActive) {
         return;
@@ -60,6 +61,13 @@ void EchoSocket::sendDataImpl(DataInfoPtr dataPtr)
     m_timer->start(0);
 }
 
+void EchoSocket::flushSendDataImpl()
+{
+    if (m_synchronous && (!m_delivering)) {
+        deliverPending();
+    }
+}
+
 unsigned EchoSocket::connectionPropertiesImpl() const
 {
     return ConnectionProperty_Autoconnect | ConnectionProperty_NonDisconnectable;
@@ -68,16 +76,38 @@ unsigned EchoSocket::connectionPropertiesImpl() const
 void EchoSocket::sendDataPostponed()
 {
     m_timerActive = false;
+    if (!m_delivering) {
+        deliverPending();
+    }
+}
+
+void EchoSocket::deliverPending()
+{
+    // Data sent while reporting is delivered by the same loop
+    m_delivering = true;
     while (!m_pendingData.empty()) {
-        auto dataPtr = m_pendingData.front();
+        auto dataPtr = std::move(m_pendingData.front());
         m_pendingData.pop_front();
+        reportDataReceived(makeEchoData(std::move(dataPtr)));
+    }
+    m_delivering = false;
+}
 
-        auto inDataPtr = makeDataInfo();
-        inDataPtr->m_data = dataPtr->m_data;
-        inDataPtr->m_extraProperties = dataPtr->m_extraProperties;
-        inDataPtr->m_timestamp = DataInfo::TimestampClock::now();
-        reportDataReceived(std::move(inDataPtr));
+DataInfoPtr EchoSocket::makeEchoData(DataInfoPtr dataPtr)
+{
+    if (m_zeroCopy) {
+        dataPtr->m_timestamp = DataInfo::TimestampClock::now();
+        return dataPtr;
     }
+
+    auto inDataPtr = makeDataInfo();
+    inDataPtr->m_data = dataPtr->m_data;
+    inDataPtr->m_extraProperties = dataPtr->m_extraProperties;
+    inDataPtr->m_fromEndpoint = dataPtr->m_fromEndpoint;
+    inDataPtr->m_toEndpoint = dataPtr->m_toEndpoint;
+    inDataPtr->m_wholeFrame = dataPtr->m_wholeFrame;
+    inDataPtr->m_timestamp = DataInfo::TimestampClock::now();
+    return inDataPtr;
 }
 
 }  // namespace comms_champion
@@ -39,20 +39,50 @@ public:
     EchoSocket();
     ~EchoSocket();
 
+    // Report the sent buffer back as-is, only the timestamp is updated
+    void setZeroCopy(bool value)
+    {
+        m_zeroCopy = value;
+    }
+
+    bool getZeroCopy() const
+    {
+        return m_zeroCopy;
+    }
+
+    // Report the data back as soon as the sender is done with it, without
+    // returning to event loop
+    void setSynchronous(bool value)
+    {
+        m_synchronous = value;
+    }
+
+    bool getSynchronous() const
+    {
+        return m_synchronous;
+    }
+
 protected:
     virtual bool startImpl() override;
     virtual void stopImpl() override;
     virtual void sendDataImpl(DataInfoPtr dataPtr) override;
+    virtual void flushSendDataImpl() override;
     virtual unsigned connectionPropertiesImpl() const override;
 
 private slots:
     void sendDataPostponed();
 
 private:
+    void deliverPending();
+    DataInfoPtr makeEchoData(DataInfoPtr dataPtr);
+
     QTimer* m_timer = nullptr;
     bool m_running = false;
     std::list<DataInfoPtr> m_pendingData;
     bool m_timerActive = false;
+    bool m_zeroCopy = false;
+    bool m_synchronous = false;
+    bool m_delivering = false;
 };
 
 inline
@@ -0,0 +1,66 @@
+//
+// Copyright 2016 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "EchoSocketConfigWidget.h"
+
+namespace comms_champion
+{
+
+namespace plugin
+{
+
+namespace dummy_socket
+{
+
+EchoSocketConfigWidget::EchoSocketConfigWidget(
+    EchoSocket& socket,
+    QWidget* parentObj)
+  : Base(parentObj),
+    m_socket(socket)
+{
+    m_ui.setupUi(this);
+
+    m_ui.m_zeroCopyCheckBox->setChecked(m_socket.getZeroCopy());
+    m_ui.m_synchronousCheckBox->setChecked(m_socket.getSynchronous());
+
+    connect(
+        m_ui.m_zeroCopyCheckBox, SIGNAL(toggled(bool)),
+        this, SLOT(zeroCopyToggled(bool)));
+
+    connect(
+        m_ui.m_synchronousCheckBox, SIGNAL(toggled(bool)),
+        this, SLOT(synchronousToggled(bool)));
+}
+
+EchoSocketConfigWidget::~EchoSocketConfigWidget() = default;
+
+void EchoSocketConfigWidget::zeroCopyToggled(bool checked)
+{
+    m_socket.setZeroCopy(checked);
+}
+
+void EchoSocketConfigWidget::synchronousToggled(bool checked)
+{
+    m_socket.setSynchronous(checked);
+}
+
+}  // namespace dummy_socket
+
+}  // namespace plugin
+
+}  // namespace comms_champion
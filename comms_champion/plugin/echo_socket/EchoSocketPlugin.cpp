@@ -20,7 +20,7 @@
 #include <memory>
 #include <cassert>
 
-#include "EchoSocket.h"
+#include "EchoSocketConfigWidget.h"
 
 namespace comms_champion
 {
@@ -31,6 +31,15 @@ namespace plugin
 namespace dummy_socket
 {
 
+namespace
+{
+
+const QString MainConfigKey("cc_echo_socket");
+const QString ZeroCopySubKey("zero_copy");
+const QString SynchronousSubKey("synchronous");
+
+}  // namespace
+
 class EchoSocketPluginImpl
 {
 public:
@@ -43,14 +52,60 @@ EchoSocketPlugin::EchoSocketPlugin()
 {
     pluginProperties()
         .setSocketCreateFunc(
-            [this]()
+            [this]() -> SocketPtr
             {
-                return makeEchoSocket();
+                createSocketIfNeeded();
+                return m_socket;
+            })
+        .setConfigWidgetCreateFunc(
+            [this]() -> QWidget*
+            {
+                createSocketIfNeeded();
+                return new EchoSocketConfigWidget(*m_socket);
             });
 }
 
 EchoSocketPlugin::~EchoSocketPlugin() = default;
 
+void EchoSocketPlugin::getCurrentConfigImpl(QVariantMap& config)
+{
+    createSocketIfNeeded();
+
+    QVariantMap subConfig;
+    subConfig.insert(ZeroCopySubKey, m_socket->getZeroCopy());
+    subConfig.insert(SynchronousSubKey, m_socket->getSynchronous());
+    config.insert(MainConfigKey, QVariant::fromValue(subConfig));
+}
+
+void EchoSocketPlugin::reconfigureImpl(const QVariantMap& config)
+{
+    auto subConfigVar = config.value(MainConfigKey);
+    if ((!subConfigVar.isValid()) || (!subConfigVar.canConvert<QVariantMap>())) {
+        return;
+    }
+
+    createSocketIfNeeded();
+    assert(m_socket);
+
+    auto subConfig = subConfigVar.value<QVariantMap>();
+    auto zeroCopyVar = subConfig.value(ZeroCopySubKey);
+    if (zeroCopyVar.isValid() && zeroCopyVar.canConvert<bool>()) {
+        m_socket->setZeroCopy(zeroCopyVar.value<bool>());
+    }
+
+    auto synchronousVar = subConfig.value(SynchronousSubKey);
+    if (synchronousVar.isValid() && synchronousVar.canConvert<bool>()) {
+        m_socket->setSynchronous(synchronousVar.value<bool>());
+    }
+}
+
+void EchoSocketPlugin::createSocketIfNeeded()
+{
+    if (!m_socket) {
+        m_socket.reset(new EchoSocket());
+    }
+}
+
 }  // namespace dummy_socket
 
 }  // namespace plugin
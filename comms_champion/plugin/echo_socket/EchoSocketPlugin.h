@@ -21,7 +21,8 @@
 #include <memory>
 
 #include "comms_champion/Plugin.h"
-#include "comms_champion/Socket.h"
+
+#include "EchoSocket.h"
 
 namespace comms_champion
 {
@@ -42,8 +43,13 @@ public:
     EchoSocketPlugin();
     ~EchoSocketPlugin();
 
+    virtual void getCurrentConfigImpl(QVariantMap& config) override;
+    virtual void reconfigureImpl(const QVariantMap& config) override;
+
 private:
-    comms_champion::SocketPtr m_socket;
+    void createSocketIfNeeded();
+
+    std::shared_ptr<EchoSocket> m_socket;
 };
 
 }  // namespace dummy_socket
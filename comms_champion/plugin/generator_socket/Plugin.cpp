@@ -0,0 +1,126 @@
+//
+// Copyright 2016 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "Plugin.h"
+
+#include <memory>
+#include <cassert>
+
+#include "SocketConfigWidget.h"
+
+namespace comms_champion
+{
+
+namespace plugin
+{
+
+namespace generator_socket
+{
+
+namespace
+{
+
+const QString MainConfigKey("cc_generator_socket");
+const QString MessagesSubKey("messages");
+const QString VariantsSubKey("variants");
+const QString RateSubKey("rate");
+const QString BurstSubKey("burst");
+
+}  // namespace
+
+Plugin::Plugin()
+{
+    pluginProperties()
+        .setSocketCreateFunc(
+            [this]() -> SocketPtr
+            {
+                createSocketIfNeeded();
+                return m_socket;
+            })
+        .setConfigWidgetCreateFunc(
+            [this]() -> QWidget*
+            {
+                createSocketIfNeeded();
+                return new SocketConfigWidget(*m_socket);
+            });
+}
+
+Plugin::~Plugin() = default;
+
+void Plugin::getCurrentConfigImpl(QVariantMap& config)
+{
+    createSocketIfNeeded();
+
+    QVariantMap subConfig;
+    subConfig.insert(MessagesSubKey, m_socket->getMessages());
+    subConfig.insert(VariantsSubKey, m_socket->getVariants());
+    subConfig.insert(RateSubKey, m_socket->getRate());
+    subConfig.insert(BurstSubKey, m_socket->getBurst());
+    config.insert(MainConfigKey, QVariant::fromValue(subConfig));
+}
+
+void Plugin::reconfigureImpl(const QVariantMap& config)
+{
+    auto subConfigVar = config.value(MainConfigKey);
+    if ((!subConfigVar.isValid()) || (!subConfigVar.canConvert<QVariantMap>())) {
+        return;
+    }
+
+    createSocketIfNeeded();
+    assert(m_socket);
+
+    auto subConfig = subConfigVar.value<QVariantMap>();
+    auto messagesVar = subConfig.value(MessagesSubKey);
+    if (messagesVar.isValid() && messagesVar.canConvert<QString>()) {
+        m_socket->setMessages(messagesVar.value<QString>());
+    }
+
+    auto variantsVar = subConfig.value(VariantsSubKey);
+    if (variantsVar.isValid() && variantsVar.canConvert<unsigned>()) {
+        auto variants = variantsVar.value<unsigned>();
+        if (0U < variants) {
+            m_socket->setVariants(variants);
+        }
+    }
+
+    auto rateVar = subConfig.value(RateSubKey);
+    if (rateVar.isValid() && rateVar.canConvert<unsigned>()) {
+        m_socket->setRate(rateVar.value<unsigned>());
+    }
+
+    auto burstVar = subConfig.value(BurstSubKey);
+    if (burstVar.isValid() && burstVar.canConvert<unsigned>()) {
+        auto burst = burstVar.value<unsigned>();
+        if (0U < burst) {
+            m_socket->setBurst(burst);
+        }
+    }
+}
+
+void Plugin::createSocketIfNeeded()
+{
+    if (!m_socket) {
+        m_socket.reset(new Socket());
+    }
+}
+
+}  // namespace generator_socket
+
+}  // namespace plugin
+
+}  // namespace comms_champion
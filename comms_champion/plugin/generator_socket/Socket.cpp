@@ -0,0 +1,333 @@
+//
+// Copyright 2016 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "Socket.h"
+
+#include <cassert>
+#include <cstdint>
+#include <algorithm>
+#include <random>
+#include <iostream>
+
+CC_DISABLE_WARNINGS()
+#include <QtCore/QStringList>
+CC_ENABLE_WARNINGS()
+
+#include "comms_champion/Protocol.h"
+
+namespace comms_champion
+{
+
+namespace plugin
+{
+
+namespace generator_socket
+{
+
+namespace
+{
+
+// Maximal number of messages reported in a single event loop iteration
+const unsigned long long MaxBatchSize = 10000U;
+const std::uint32_t RandomSeed = 0x5eed;
+const auto ReportInterval = std::chrono::seconds(1);
+
+struct MixEntry
+{
+    MessagePtr m_msg;
+    unsigned m_weight = 1U;
+};
+
+typedef std::vector<MixEntry> MixList;
+
+double toSeconds(std::chrono::steady_clock::duration duration)
+{
+    return std::chrono::duration_cast<std::chrono::duration<double> >(duration).count();
+}
+
+}  // namespace
+
+Socket::Socket()
+{
+    m_timer.setTimerType(Qt::PreciseTimer);
+    connect(
+        &m_timer, SIGNAL(timeout()),
+        this, SLOT(generate()));
+}
+
+Socket::~Socket() = default;
+
+bool Socket::socketConnectImpl()
+{
+    if (m_running) {
+        assert(!"Already connected");
+        static const QString AlreadyConnectedError(
+            tr("Previous run of generator socket wasn't terminated properly."));
+        reportError(AlreadyConnectedError);
+        return false;
+    }
+
+    if (!prepareFrames()) {
+        return false;
+    }
+
+    m_nextScheduled = 0U;
+    m_sentCount = 0U;
+    m_sentBytes = 0U;
+    m_lastReportCount = 0U;
+    m_lastReportBytes = 0U;
+    m_rateBaseCount = 0U;
+    m_startTime = Clock::now();
+    m_lastReportTime = m_startTime;
+    m_running = true;
+
+    auto burst = std::max(m_burst, 1U);
+    int interval = 0;
+    if (m_rate != 0U) {
+        interval = std::max(1, static_cast<int>((burst * 1000ULL) / m_rate));
+    }
+    m_timer.start(interval);
+    return true;
+}
+
+void Socket::socketDisconnectImpl()
+{
+    m_timer.stop();
+    if (m_running) {
+        m_running = false;
+        reportRate(Clock::now(), true);
+    }
+
+    m_frames.clear();
+    m_schedule.clear();
+}
+
+void Socket::sendDataImpl(DataInfoPtr dataPtr)
+{
+    static_cast<void>(dataPtr);
+}
+
+void Socket::generate()
+{
+    if (!m_running) {
+        return;
+    }
+
+    auto now = Clock::now();
+    unsigned long long burst = std::max(m_burst, 1U);
+    auto count = burst;
+    if (m_rate != 0U) {
+        auto elapsedUs =
+            std::chrono::duration_cast<std::chrono::microseconds>(now - m_startTime).count();
+        auto expected = (static_cast<unsigned long long>(elapsedUs) * m_rate) / 1000000U;
+        auto sent = m_sentCount - m_rateBaseCount;
+        if (expected <= sent) {
+            return;
+        }
+
+        auto due = expected - sent;
+        if (m_rate < due) {
+            // More than a second behind, don't try to catch up
+            m_startTime = now;
+            m_rateBaseCount = m_sentCount;
+            due = burst;
+        }
+
+        auto maxBursts = std::max(MaxBatchSize / burst, 1ULL);
+        count = std::min(due / burst, maxBursts) * burst;
+        if (count == 0U) {
+            return;
+        }
+    }
+
+    if (!emitFrames(count)) {
+        return;
+    }
+
+    if (ReportInterval <= (now - m_lastReportTime)) {
+        reportRate(now, false);
+    }
+}
+
+bool Socket::prepareFrames()
+{
+    auto protocol = getProtocol();
+    if (!protocol) {
+        static const QString NoProtocolError(
+            tr("Generator socket requires protocol to be loaded."));
+        reportError(NoProtocolError);
+        return false;
+    }
+
+    MixList mix;
+    auto messages = m_messages.trimmed();
+    if (messages.isEmpty()) {
+        auto allMsgs = protocol->createAllMessages();
+        for (auto& msgPtr : allMsgs) {
+            MixEntry entry;
+            entry.m_msg = std::move(msgPtr);
+            mix.push_back(std::move(entry));
+        }
+    }
+    else {
+        auto entries = messages.split(',', QString::SkipEmptyParts);
+        for (auto& entryStr : entries) {
+            auto parts = entryStr.split(':');
+            MixEntry entry;
+            auto id = parts[0].trimmed();
+            entry.m_msg = protocol->createMessage(id);
+            if (!entry.m_msg) {
+                reportError(tr("Generator socket: unknown message ID: ") + id);
+                return false;
+            }
+
+            if (1 < parts.size()) {
+                bool ok = false;
+                entry.m_weight = parts[1].trimmed().toUInt(&ok);
+                if ((!ok) || (entry.m_weight == 0U)) {
+                    reportError(tr("Generator socket: invalid weight: ") + entryStr);
+                    return false;
+                }
+            }
+
+            mix.push_back(std::move(entry));
+        }
+    }
+
+    m_frames.clear();
+    m_schedule.clear();
+    std::mt19937 rng(RandomSeed);
+    auto variants = std::max(m_variants, 1U);
+    for (auto& entry : mix) {
+        auto firstFrameIdx = m_frames.size();
+        for (auto variant = 0U; variant < variants; ++variant) {
+            auto msg = protocol->cloneMessage(*entry.m_msg);
+            if (!msg) {
+                break;
+            }
+
+            if (0U < variant) {
+                // Randomise contents, keep default values if the
+                // random data cannot be decoded
+                auto data = msg->encodeData();
+                std::generate(
+                    data.begin(), data.end(),
+                    [&rng]() -> std::uint8_t
+                    {
+                        return static_cast<std::uint8_t>(rng());
+                    });
+
+                if ((!msg->decodeData(data)) || (!msg->isValid())) {
+                    msg = protocol->cloneMessage(*entry.m_msg);
+                }
+                else {
+                    msg->refreshMsg();
+                }
+            }
+
+            auto dataPtr = protocol->write(*msg);
+            if ((!dataPtr) || dataPtr->m_data.empty()) {
+                continue;
+            }
+
+            m_frames.push_back(std::move(dataPtr->m_data));
+        }
+
+        for (auto weight = 0U; weight < entry.m_weight; ++weight) {
+            for (auto idx = firstFrameIdx; idx < m_frames.size(); ++idx) {
+                m_schedule.push_back(idx);
+            }
+        }
+    }
+
+    if (m_schedule.empty()) {
+        static const QString NoFramesError(
+            tr("Generator socket: no messages to generate."));
+        reportError(NoFramesError);
+        return false;
+    }
+
+    std::shuffle(m_schedule.begin(), m_schedule.end(), rng);
+    return true;
+}
+
+bool Socket::emitFrames(unsigned long long count)
+{
+    assert(!m_schedule.empty());
+    auto timestamp = DataInfo::TimestampClock::now();
+    for (auto idx = 0ULL; idx < count; ++idx) {
+        auto& frame = m_frames[m_schedule[m_nextScheduled]];
+        ++m_nextScheduled;
+        if (m_schedule.size() <= m_nextScheduled) {
+            m_nextScheduled = 0U;
+        }
+
+        auto dataPtr = makeDataInfo();
+        dataPtr->m_timestamp = timestamp;
+        dataPtr->m_data = frame;
+        dataPtr->m_wholeFrame = true;
+        ++m_sentCount;
+        m_sentBytes += frame.size();
+        reportDataReceived(std::move(dataPtr));
+        if (!m_running) {
+            // Disconnected while reporting
+            return false;
+        }
+    }
+    return true;
+}
+
+void Socket::reportRate(Clock::time_point now, bool final)
+{
+    if (final) {
+        auto duration = toSeconds(now - m_startTime);
+        std::cerr << "INFO: Generator socket: generated " << m_sentCount <<
+            " messages (" << m_sentBytes << " bytes)";
+        if (0.0 < duration) {
+            std::cerr << ", average rate " <<
+                static_cast<unsigned long long>(m_sentCount / duration) << " msg/s";
+        }
+        std::cerr << std::endl;
+        return;
+    }
+
+    auto duration = toSeconds(now - m_lastReportTime);
+    if (duration <= 0.0) {
+        return;
+    }
+
+    auto msgRate = static_cast<double>(m_sentCount - m_lastReportCount) / duration;
+    auto bytesRate = static_cast<double>(m_sentBytes - m_lastReportBytes) / duration;
+    std::cerr << "INFO: Generator socket: achieved rate " <<
+        static_cast<unsigned long long>(msgRate) << " msg/s (" <<
+        static_cast<unsigned long long>(bytesRate) << " bytes/s)";
+    if (m_rate != 0U) {
+        std::cerr << ", target " << m_rate << " msg/s";
+    }
+    std::cerr << std::endl;
+
+    m_lastReportTime = now;
+    m_lastReportCount = m_sentCount;
+    m_lastReportBytes = m_sentBytes;
+}
+
+}  // namespace generator_socket
+
+}  // namespace plugin
+
+}  // namespace comms_champion
@@ -0,0 +1,136 @@
+//
+// Copyright 2016 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <chrono>
+#include <vector>
+
+#include "comms/CompileControl.h"
+
+CC_DISABLE_WARNINGS()
+#include <QtCore/QObject>
+#include <QtCore/QString>
+#include <QtCore/QTimer>
+CC_ENABLE_WARNINGS()
+
+#include "comms_champion/Socket.h"
+
+namespace comms_champion
+{
+
+namespace plugin
+{
+
+namespace generator_socket
+{
+
+class Socket : public QObject,
+               public comms_champion::Socket
+{
+    Q_OBJECT
+    using Base = comms_champion::Socket;
+
+public:
+    Socket();
+    ~Socket();
+
+    // Comma separated list of message IDs with optional weight,
+    // i.e. "1:10,2,5:3". Empty string stands for all the messages
+    // with equal weight.
+    void setMessages(const QString& value)
+    {
+        m_messages = value;
+    }
+
+    const QString& getMessages() const
+    {
+        return m_messages;
+    }
+
+    void setVariants(unsigned value)
+    {
+        m_variants = value;
+    }
+
+    unsigned getVariants() const
+    {
+        return m_variants;
+    }
+
+    // Messages per second, 0 means unlimited
+    void setRate(unsigned value)
+    {
+        m_rate = value;
+    }
+
+    unsigned getRate() const
+    {
+        return m_rate;
+    }
+
+    void setBurst(unsigned value)
+    {
+        m_burst = value;
+    }
+
+    unsigned getBurst() const
+    {
+        return m_burst;
+    }
+
+protected:
+    virtual bool socketConnectImpl() override;
+    virtual void socketDisconnectImpl() override;
+    virtual void sendDataImpl(DataInfoPtr dataPtr) override;
+
+private slots:
+    void generate();
+
+private:
+    typedef std::chrono::steady_clock Clock;
+    typedef std::vector<DataInfo::DataSeq> FramesList;
+    typedef std::vector<std::size_t> ScheduleList;
+
+    bool prepareFrames();
+    bool emitFrames(unsigned long long count);
+    void reportRate(Clock::time_point now, bool final);
+
+    QString m_messages;
+    unsigned m_variants = 16U;
+    unsigned m_rate = 1000U;
+    unsigned m_burst = 1U;
+    FramesList m_frames;
+    ScheduleList m_schedule;
+    std::size_t m_nextScheduled = 0U;
+    QTimer m_timer;
+    Clock::time_point m_startTime;
+    Clock::time_point m_lastReportTime;
+    unsigned long long m_sentCount = 0U;
+    unsigned long long m_sentBytes = 0U;
+    unsigned long long m_lastReportCount = 0U;
+    unsigned long long m_lastReportBytes = 0U;
+    unsigned long long m_rateBaseCount = 0U;
+    bool m_running = false;
+};
+
+}  // namespace generator_socket
+
+}  // namespace plugin
+
+}  // namespace comms_champion
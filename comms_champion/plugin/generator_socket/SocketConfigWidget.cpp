@@ -0,0 +1,86 @@
+//
+// Copyright 2016 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "SocketConfigWidget.h"
+
+namespace comms_champion
+{
+
+namespace plugin
+{
+
+namespace generator_socket
+{
+
+SocketConfigWidget::SocketConfigWidget(
+    Socket& socket,
+    QWidget* parentObj)
+  : Base(parentObj),
+    m_socket(socket)
+{
+    m_ui.setupUi(this);
+
+    m_ui.m_messagesLineEdit->setText(m_socket.getMessages());
+    m_ui.m_variantsSpinBox->setValue(static_cast<int>(m_socket.getVariants()));
+    m_ui.m_rateSpinBox->setValue(static_cast<int>(m_socket.getRate()));
+    m_ui.m_burstSpinBox->setValue(static_cast<int>(m_socket.getBurst()));
+
+    connect(
+        m_ui.m_messagesLineEdit, SIGNAL(textChanged(const QString&)),
+        this, SLOT(messagesValueChanged(const QString&)));
+
+    connect(
+        m_ui.m_variantsSpinBox, SIGNAL(valueChanged(int)),
+        this, SLOT(variantsValueChanged(int)));
+
+    connect(
+        m_ui.m_rateSpinBox, SIGNAL(valueChanged(int)),
+        this, SLOT(rateValueChanged(int)));
+
+    connect(
+        m_ui.m_burstSpinBox, SIGNAL(valueChanged(int)),
+        this, SLOT(burstValueChanged(int)));
+}
+
+SocketConfigWidget::~SocketConfigWidget() = default;
+
+void SocketConfigWidget::messagesValueChanged(const QString& value)
+{
+    m_socket.setMessages(value);
+}
+
+void SocketConfigWidget::variantsValueChanged(int value)
+{
+    m_socket.setVariants(static_cast<unsigned>(value));
+}
+
+void SocketConfigWidget::rateValueChanged(int value)
+{
+    m_socket.setRate(static_cast<unsigned>(value));
+}
+
+void SocketConfigWidget::burstValueChanged(int value)
+{
+    m_socket.setBurst(static_cast<unsigned>(value));
+}
+
+}  // namespace generator_socket
+
+}  // namespace plugin
+
+}  // namespace comms_champion
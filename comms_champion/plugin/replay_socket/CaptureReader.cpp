@@ -0,0 +1,76 @@
+//
+// Copyright 2016 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "CaptureReader.h"
+
+#include <cassert>
+
+#include "comms_champion/MsgFileMgr.h"
+
+namespace comms_champion
+{
+
+namespace plugin
+{
+
+namespace replay_socket
+{
+
+CaptureReader::CaptureReader(ProtocolPtr protocol)
+  : m_protocol(std::move(protocol))
+{
+    assert(m_protocol);
+}
+
+CaptureReader::~CaptureReader() = default;
+
+bool CaptureReader::open(const QString& filename)
+{
+    return m_capture.open(filename);
+}
+
+bool CaptureReader::readNextImpl(Record& record)
+{
+    MsgCaptureFile::Record capRecord;
+    while (m_capture.readNext(capRecord)) {
+        if (capRecord.m_type != Message::Type::Received) {
+            continue;
+        }
+
+        auto msg = MsgFileMgr::createRecvMsg(capRecord, *m_protocol);
+        if (!msg) {
+            continue;
+        }
+
+        auto dataPtr = frameReceivedMessage(*msg, *m_protocol);
+        if (!dataPtr) {
+            continue;
+        }
+
+        record.m_timestampUs = capRecord.m_timestamp * 1000U;
+        record.m_dataPtr = std::move(dataPtr);
+        return true;
+    }
+    return false;
+}
+
+}  // namespace replay_socket
+
+}  // namespace plugin
+
+}  // namespace comms_champion
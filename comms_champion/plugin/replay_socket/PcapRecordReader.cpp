@@ -0,0 +1,132 @@
+//
+// Copyright 2016 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "PcapRecordReader.h"
+
+#include "comms_champion/EndpointRegistry.h"
+
+namespace comms_champion
+{
+
+namespace plugin
+{
+
+namespace replay_socket
+{
+
+namespace
+{
+
+EndpointRegistry::TransportId transportId(PcapReader::Transport transport)
+{
+    static const auto UdpId = EndpointRegistry::instanceRef().registerTransport("udp");
+    static const auto TcpId = EndpointRegistry::instanceRef().registerTransport("tcp");
+    if (transport == PcapReader::Transport::Tcp) {
+        return TcpId;
+    }
+    return UdpId;
+}
+
+bool isIPv4Mapped(const PcapReader::AddressBytes& address)
+{
+    for (auto idx = 0U; idx < 10U; ++idx) {
+        if (address[idx] != 0U) {
+            return false;
+        }
+    }
+    return (address[10] == 0xff) && (address[11] == 0xff);
+}
+
+QString formatEndpoint(const PcapReader::AddressBytes& address, std::uint16_t port)
+{
+    QString result;
+    if (isIPv4Mapped(address)) {
+        result =
+            QString("%1.%2.%3.%4")
+                .arg(address[12])
+                .arg(address[13])
+                .arg(address[14])
+                .arg(address[15]);
+    }
+    else {
+        result.append('[');
+        for (auto idx = 0U; idx < address.size(); idx += 2) {
+            if (idx != 0U) {
+                result.append(':');
+            }
+            unsigned group = (static_cast<unsigned>(address[idx]) << 8) | address[idx + 1];
+            result.append(QString::number(group, 16));
+        }
+        result.append(']');
+    }
+    return result + ':' + QString::number(port);
+}
+
+DataInfo::EndpointId endpointId(
+    PcapReader::Transport transport,
+    const PcapReader::AddressBytes& address,
+    std::uint16_t port)
+{
+    return
+        EndpointRegistry::instanceRef().intern(
+            transportId(transport),
+            address,
+            port,
+            [address, port]() -> QString
+            {
+                return formatEndpoint(address, port);
+            });
+}
+
+}  // namespace
+
+PcapRecordReader::PcapRecordReader() = default;
+PcapRecordReader::~PcapRecordReader() = default;
+
+bool PcapRecordReader::open(const QString& filename)
+{
+    return m_reader.open(filename);
+}
+
+bool PcapRecordReader::readNextImpl(Record& record)
+{
+    PcapReader::Record pcapRecord;
+    if (!m_reader.readNext(pcapRecord)) {
+        if (m_reader.hasError()) {
+            setError(m_reader.errorString());
+        }
+        return false;
+    }
+
+    auto dataPtr = makeDataInfo();
+    dataPtr->m_data.assign(pcapRecord.m_data, pcapRecord.m_data + pcapRecord.m_dataLen);
+    dataPtr->m_streamId = pcapRecord.m_streamId;
+    dataPtr->m_fromEndpoint =
+        endpointId(pcapRecord.m_transport, pcapRecord.m_srcAddress, pcapRecord.m_srcPort);
+    dataPtr->m_toEndpoint =
+        endpointId(pcapRecord.m_transport, pcapRecord.m_dstAddress, pcapRecord.m_dstPort);
+
+    record.m_timestampUs = pcapRecord.m_timestampUs;
+    record.m_dataPtr = std::move(dataPtr);
+    return true;
+}
+
+}  // namespace replay_socket
+
+}  // namespace plugin
+
+}  // namespace comms_champion
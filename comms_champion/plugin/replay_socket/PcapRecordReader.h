@@ -0,0 +1,54 @@
+//
+// Copyright 2016 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#pragma once
+
+#include "comms_champion/PcapReader.h"
+
+#include "RecordReader.h"
+
+namespace comms_champion
+{
+
+namespace plugin
+{
+
+namespace replay_socket
+{
+
+// Replays UDP datagrams and reassembled TCP data of pcap and pcapng
+// captures, every flow direction is reported as separate stream.
+class PcapRecordReader : public RecordReader
+{
+public:
+    PcapRecordReader();
+    ~PcapRecordReader();
+
+    bool open(const QString& filename);
+
+protected:
+    virtual bool readNextImpl(Record& record) override;
+
+private:
+    PcapReader m_reader;
+};
+
+}  // namespace replay_socket
+
+}  // namespace plugin
+
+}  // namespace comms_champion
@@ -0,0 +1,116 @@
+//
+// Copyright 2016 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "Plugin.h"
+
+#include <memory>
+#include <cassert>
+
+#include "SocketConfigWidget.h"
+
+namespace comms_champion
+{
+
+namespace plugin
+{
+
+namespace replay_socket
+{
+
+namespace
+{
+
+const QString MainConfigKey("cc_replay_socket");
+const QString FileSubKey("file");
+const QString SpeedSubKey("speed");
+const QString MaxSpeedSubKey("max_speed");
+
+}  // namespace
+
+Plugin::Plugin()
+{
+    pluginProperties()
+        .setSocketCreateFunc(
+            [this]() -> SocketPtr
+            {
+                createSocketIfNeeded();
+                return m_socket;
+            })
+        .setConfigWidgetCreateFunc(
+            [this]() -> QWidget*
+            {
+                createSocketIfNeeded();
+                return new SocketConfigWidget(*m_socket);
+            });
+}
+
+Plugin::~Plugin() = default;
+
+void Plugin::getCurrentConfigImpl(QVariantMap& config)
+{
+    createSocketIfNeeded();
+
+    QVariantMap subConfig;
+    subConfig.insert(FileSubKey, m_socket->getFile());
+    subConfig.insert(SpeedSubKey, m_socket->getSpeed());
+    subConfig.insert(MaxSpeedSubKey, m_socket->getMaxSpeed());
+    config.insert(MainConfigKey, QVariant::fromValue(subConfig));
+}
+
+void Plugin::reconfigureImpl(const QVariantMap& config)
+{
+    auto subConfigVar = config.value(MainConfigKey);
+    if ((!subConfigVar.isValid()) || (!subConfigVar.canConvert<QVariantMap>())) {
+        return;
+    }
+
+    createSocketIfNeeded();
+    assert(m_socket);
+
+    auto subConfig = subConfigVar.value<QVariantMap>();
+    auto fileVar = subConfig.value(FileSubKey);
+    if (fileVar.isValid() && fileVar.canConvert<QString>()) {
+        m_socket->setFile(fileVar.value<QString>());
+    }
+
+    auto speedVar = subConfig.value(SpeedSubKey);
+    if (speedVar.isValid() && speedVar.canConvert<double>()) {
+        auto speed = speedVar.value<double>();
+        if (0.0 < speed) {
+            m_socket->setSpeed(speed);
+        }
+    }
+
+    auto maxSpeedVar = subConfig.value(MaxSpeedSubKey);
+    if (maxSpeedVar.isValid() && maxSpeedVar.canConvert<bool>()) {
+        m_socket->setMaxSpeed(maxSpeedVar.value<bool>());
+    }
+}
+
+void Plugin::createSocketIfNeeded()
+{
+    if (!m_socket) {
+        m_socket.reset(new Socket());
+    }
+}
+
+}  // namespace replay_socket
+
+}  // namespace plugin
+
+}  // namespace comms_champion
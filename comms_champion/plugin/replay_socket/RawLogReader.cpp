@@ -0,0 +1,128 @@
+//
+// Copyright 2016 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "RawLogReader.h"
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+
+namespace comms_champion
+{
+
+namespace plugin
+{
+
+namespace replay_socket
+{
+
+namespace
+{
+
+const char Magic[] = "CCRAWLOG";
+const std::size_t MagicSize = sizeof(Magic) - 1;
+const std::uint32_t SupportedVersion = 1U;
+const std::size_t RecordHeaderSize = 12U;
+const std::uint32_t MaxRecordSize = 64U * 1024U * 1024U;
+
+template <typename T>
+T readLittleEndian(const char* data, std::size_t size)
+{
+    T value = 0;
+    for (auto idx = 0U; idx < size; ++idx) {
+        auto byte = static_cast<T>(static_cast<std::uint8_t>(data[idx]));
+        value |= static_cast<T>(byte << (idx * 8U));
+    }
+    return value;
+}
+
+}  // namespace
+
+RawLogReader::RawLogReader(std::unique_ptr<QFile> file)
+  : m_file(std::move(file))
+{
+    assert(m_file);
+}
+
+RawLogReader::~RawLogReader() = default;
+
+bool RawLogReader::isRawLog(const QByteArray& header)
+{
+    return
+        (MagicSize <= static_cast<std::size_t>(header.size())) &&
+        (std::memcmp(header.constData(), Magic, MagicSize) == 0);
+}
+
+bool RawLogReader::readNextImpl(Record& record)
+{
+    if (!m_headerRead) {
+        char header[HeaderSize];
+        if (m_file->read(header, HeaderSize) != static_cast<qint64>(HeaderSize)) {
+            setError(QObject::tr("Raw log file is too short."));
+            return false;
+        }
+
+        if (std::memcmp(header, Magic, MagicSize) != 0) {
+            setError(QObject::tr("Invalid raw log file."));
+            return false;
+        }
+
+        auto version = readLittleEndian<std::uint32_t>(&header[MagicSize], sizeof(std::uint32_t));
+        if (version != SupportedVersion) {
+            setError(QObject::tr("Unsupported raw log version: ") + QString::number(version));
+            return false;
+        }
+
+        m_headerRead = true;
+    }
+
+    char recHeader[RecordHeaderSize];
+    auto headerLen = m_file->read(recHeader, RecordHeaderSize);
+    if (headerLen == 0) {
+        return false;
+    }
+
+    if (headerLen != static_cast<qint64>(RecordHeaderSize)) {
+        // Truncated recording, treat as end of capture
+        return false;
+    }
+
+    auto timestamp = readLittleEndian<std::uint64_t>(&recHeader[0], sizeof(std::uint64_t));
+    auto len = readLittleEndian<std::uint32_t>(&recHeader[sizeof(std::uint64_t)], sizeof(std::uint32_t));
+    if (MaxRecordSize < len) {
+        setError(QObject::tr("Invalid record length in raw log: ") + QString::number(len));
+        return false;
+    }
+
+    auto dataPtr = makeDataInfo();
+    dataPtr->m_data.resize(len);
+    if ((0U < len) &&
+        (m_file->read(reinterpret_cast<char*>(&dataPtr->m_data[0]), len) != static_cast<qint64>(len))) {
+        return false;
+    }
+
+    record.m_timestampUs = timestamp;
+    record.m_dataPtr = std::move(dataPtr);
+    return true;
+}
+
+}  // namespace replay_socket
+
+}  // namespace plugin
+
+}  // namespace comms_champion
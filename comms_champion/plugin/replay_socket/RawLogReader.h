@@ -0,0 +1,67 @@
+//
+// Copyright 2016 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <memory>
+
+#include "comms/CompileControl.h"
+
+CC_DISABLE_WARNINGS()
+#include <QtCore/QByteArray>
+#include <QtCore/QFile>
+CC_ENABLE_WARNINGS()
+
+#include "RecordReader.h"
+
+namespace comms_champion
+{
+
+namespace plugin
+{
+
+namespace replay_socket
+{
+
+// Raw timestamped byte log:
+//   header: "CCRAWLOG" magic, u32 version, u32 reserved
+//   record: u64 timestamp (microseconds), u32 data length, data
+// All the integral values are little endian.
+class RawLogReader : public RecordReader
+{
+public:
+    static const std::size_t HeaderSize = 16U;
+
+    explicit RawLogReader(std::unique_ptr<QFile> file);
+    ~RawLogReader();
+
+    static bool isRawLog(const QByteArray& header);
+
+protected:
+    virtual bool readNextImpl(Record& record) override;
+
+private:
+    std::unique_ptr<QFile> m_file;
+    bool m_headerRead = false;
+};
+
+}  // namespace replay_socket
+
+}  // namespace plugin
+
+}  // namespace comms_champion
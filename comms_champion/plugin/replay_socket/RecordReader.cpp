@@ -0,0 +1,116 @@
+//
+// Copyright 2016 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "RecordReader.h"
+
+#include "comms_champion/MsgCaptureFile.h"
+#include "comms_champion/PcapReader.h"
+#include "comms_champion/property/message.h"
+
+#include "RawLogReader.h"
+#include "JsonRecvReader.h"
+#include "CaptureReader.h"
+#include "PcapRecordReader.h"
+
+namespace comms_champion
+{
+
+namespace plugin
+{
+
+namespace replay_socket
+{
+
+RecordReader::~RecordReader() = default;
+
+RecordReader::Ptr RecordReader::open(
+    const QString& filename,
+    ProtocolPtr protocol,
+    QString& error)
+{
+    std::unique_ptr<QFile> file(new QFile(filename));
+    if (!file->open(QIODevice::ReadOnly)) {
+        error = QObject::tr("Failed to open capture file: ") + filename;
+        return Ptr();
+    }
+
+    auto header = file->peek(RawLogReader::HeaderSize);
+    if (RawLogReader::isRawLog(header)) {
+        return Ptr(new RawLogReader(std::move(file)));
+    }
+
+    if (PcapReader::isPcapHeader(header)) {
+        file.reset();
+        std::unique_ptr<PcapRecordReader> reader(new PcapRecordReader());
+        if (!reader->open(filename)) {
+            error = QObject::tr("Invalid pcap file: ") + filename;
+            return Ptr();
+        }
+        return Ptr(reader.release());
+    }
+
+    if (!protocol) {
+        error = QObject::tr("Protocol is required to replay recorded messages file.");
+        return Ptr();
+    }
+
+    if (MsgCaptureFile::isCaptureHeader(header)) {
+        file.reset();
+        std::unique_ptr<CaptureReader> reader(new CaptureReader(std::move(protocol)));
+        if (!reader->open(filename)) {
+            error = QObject::tr("Invalid capture file: ") + filename;
+            return Ptr();
+        }
+        return Ptr(reader.release());
+    }
+
+    file.reset();
+    std::unique_ptr<JsonRecvReader> reader(new JsonRecvReader(std::move(protocol)));
+    if (!reader->open(filename)) {
+        error = QObject::tr("Failed to open capture file: ") + filename;
+        return Ptr();
+    }
+    return Ptr(reader.release());
+}
+
+DataInfoPtr RecordReader::frameReceivedMessage(Message& msg, Protocol& protocol)
+{
+    if (property::message::Type().getFrom(msg) != Message::Type::Received) {
+        return DataInfoPtr();
+    }
+
+    if (!msg.idAsString().isEmpty()) {
+        return protocol.write(msg);
+    }
+
+    // Invalid message keeps the received bytes as they were
+    auto rawDataMsg = property::message::RawDataMsg().getFrom(msg);
+    if (!rawDataMsg) {
+        return DataInfoPtr();
+    }
+
+    auto dataPtr = makeDataInfo();
+    dataPtr->m_data = rawDataMsg->encodeData();
+    return dataPtr;
+}
+
+}  // namespace replay_socket
+
+}  // namespace plugin
+
+}  // namespace comms_champion
@@ -0,0 +1,93 @@
+//
+// Copyright 2016 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <memory>
+
+#include "comms/CompileControl.h"
+
+CC_DISABLE_WARNINGS()
+#include <QtCore/QString>
+CC_ENABLE_WARNINGS()
+
+#include "comms_champion/DataInfo.h"
+#include "comms_champion/Protocol.h"
+
+namespace comms_champion
+{
+
+namespace plugin
+{
+
+namespace replay_socket
+{
+
+class RecordReader
+{
+public:
+    struct Record
+    {
+        unsigned long long m_timestampUs = 0U;
+        DataInfoPtr m_dataPtr;
+    };
+
+    typedef std::unique_ptr<RecordReader> Ptr;
+
+    virtual ~RecordReader();
+
+    // Returns false on end of capture or error, errorString() is not empty
+    // in the latter case.
+    bool readNext(Record& record)
+    {
+        return readNextImpl(record);
+    }
+
+    const QString& errorString() const
+    {
+        return m_error;
+    }
+
+    // Detects the capture format by its contents. The protocol is required
+    // only for the recv-save files produced by MsgFileMgr, raw logs and
+    // pcap captures are replayed as is.
+    static Ptr open(const QString& filename, ProtocolPtr protocol, QString& error);
+
+protected:
+    RecordReader() = default;
+
+    virtual bool readNextImpl(Record& record) = 0;
+
+    // Returns wire frame of the received message, empty pointer for
+    // messages of other types.
+    static DataInfoPtr frameReceivedMessage(Message& msg, Protocol& protocol);
+
+    void setError(const QString& value)
+    {
+        m_error = value;
+    }
+
+private:
+    QString m_error;
+};
+
+}  // namespace replay_socket
+
+}  // namespace plugin
+
+}  // namespace comms_champion
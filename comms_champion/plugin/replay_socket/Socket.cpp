@@ -0,0 +1,163 @@
+//
+// Copyright 2016 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "Socket.h"
+
+#include <cassert>
+#include <algorithm>
+
+namespace comms_champion
+{
+
+namespace plugin
+{
+
+namespace replay_socket
+{
+
+namespace
+{
+
+// Maximal number of records reported in a single event loop iteration
+const unsigned MaxBatchSize = 1000U;
+const double MinSpeed = 0.001;
+
+}  // namespace
+
+Socket::Socket()
+{
+    m_timer.setSingleShot(true);
+    m_timer.setTimerType(Qt::PreciseTimer);
+    connect(
+        &m_timer, SIGNAL(timeout()),
+        this, SLOT(replayNext()));
+}
+
+Socket::~Socket() = default;
+
+bool Socket::socketConnectImpl()
+{
+    if (m_reader) {
+        assert(!"Already connected");
+        static const QString AlreadyConnectedError(
+            tr("Previous run of replay socket wasn't terminated properly."));
+        reportError(AlreadyConnectedError);
+        return false;
+    }
+
+    QString error;
+    m_reader = RecordReader::open(m_file, getProtocol(), error);
+    if (!m_reader) {
+        reportError(error);
+        return false;
+    }
+
+    m_pending = RecordReader::Record();
+    m_started = false;
+    m_timer.start(0);
+    return true;
+}
+
+void Socket::socketDisconnectImpl()
+{
+    m_timer.stop();
+    m_reader.reset();
+    m_pending = RecordReader::Record();
+}
+
+void Socket::sendDataImpl(DataInfoPtr dataPtr)
+{
+    static_cast<void>(dataPtr);
+}
+
+void Socket::replayNext()
+{
+    if (!m_reader) {
+        return;
+    }
+
+    auto now = Clock::now();
+    for (auto count = 0U; count < MaxBatchSize; ++count) {
+        if (!m_pending.m_dataPtr) {
+            if (!m_reader->readNext(m_pending)) {
+                finishReplay();
+                return;
+            }
+
+            assert(m_pending.m_dataPtr);
+            if (!m_started) {
+                m_firstTimestampUs = m_pending.m_timestampUs;
+                m_startTime = now;
+                m_started = true;
+            }
+        }
+
+        if (!m_maxSpeed) {
+            auto due = dueTime(m_pending.m_timestampUs);
+            if (now < due) {
+                auto waitMs =
+                    std::chrono::duration_cast<std::chrono::milliseconds>(due - now).count();
+                m_timer.start(static_cast<int>(waitMs));
+                return;
+            }
+        }
+
+        auto dataPtr = std::move(m_pending.m_dataPtr);
+        m_pending.m_dataPtr.reset();
+        dataPtr->m_timestamp = DataInfo::TimestampClock::now();
+        reportDataReceived(std::move(dataPtr));
+        if (!m_reader) {
+            // Disconnected while reporting
+            return;
+        }
+    }
+
+    m_timer.start(0);
+}
+
+Socket::Clock::time_point Socket::dueTime(unsigned long long timestampUs) const
+{
+    if (timestampUs <= m_firstTimestampUs) {
+        return m_startTime;
+    }
+
+    auto speed = std::max(m_speed, MinSpeed);
+    std::chrono::duration<double, std::micro> offset(
+        static_cast<double>(timestampUs - m_firstTimestampUs) / speed);
+    return m_startTime + std::chrono::duration_cast<Clock::duration>(offset);
+}
+
+void Socket::finishReplay()
+{
+    assert(m_reader);
+    auto error = m_reader->errorString();
+    m_reader.reset();
+    m_pending = RecordReader::Record();
+
+    if (!error.isEmpty()) {
+        reportError(error);
+    }
+
+    reportDisconnected();
+}
+
+}  // namespace replay_socket
+
+}  // namespace plugin
+
+}  // namespace comms_champion
@@ -0,0 +1,113 @@
+//
+// Copyright 2016 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <chrono>
+
+#include "comms/CompileControl.h"
+
+CC_DISABLE_WARNINGS()
+#include <QtCore/QObject>
+#include <QtCore/QString>
+#include <QtCore/QTimer>
+CC_ENABLE_WARNINGS()
+
+#include "comms_champion/Socket.h"
+
+#include "RecordReader.h"
+
+namespace comms_champion
+{
+
+namespace plugin
+{
+
+namespace replay_socket
+{
+
+class Socket : public QObject,
+               public comms_champion::Socket
+{
+    Q_OBJECT
+    using Base = comms_champion::Socket;
+
+public:
+    Socket();
+    ~Socket();
+
+    void setFile(const QString& value)
+    {
+        m_file = value;
+    }
+
+    const QString& getFile() const
+    {
+        return m_file;
+    }
+
+    void setSpeed(double value)
+    {
+        m_speed = value;
+    }
+
+    double getSpeed() const
+    {
+        return m_speed;
+    }
+
+    void setMaxSpeed(bool value)
+    {
+        m_maxSpeed = value;
+    }
+
+    bool getMaxSpeed() const
+    {
+        return m_maxSpeed;
+    }
+
+protected:
+    virtual bool socketConnectImpl() override;
+    virtual void socketDisconnectImpl() override;
+    virtual void sendDataImpl(DataInfoPtr dataPtr) override;
+
+private slots:
+    void replayNext();
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    Clock::time_point dueTime(unsigned long long timestampUs) const;
+    void finishReplay();
+
+    QString m_file;
+    double m_speed = 1.0;
+    bool m_maxSpeed = false;
+    RecordReader::Ptr m_reader;
+    RecordReader::Record m_pending;
+    QTimer m_timer;
+    Clock::time_point m_startTime;
+    unsigned long long m_firstTimestampUs = 0U;
+    bool m_started = false;
+};
+
+}  // namespace replay_socket
+
+}  // namespace plugin
+
+}  // namespace comms_champion
@@ -0,0 +1,99 @@
+//
+// Copyright 2016 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "SocketConfigWidget.h"
+
+CC_DISABLE_WARNINGS()
+#include <QtWidgets/QFileDialog>
+CC_ENABLE_WARNINGS()
+
+namespace comms_champion
+{
+
+namespace plugin
+{
+
+namespace replay_socket
+{
+
+SocketConfigWidget::SocketConfigWidget(
+    Socket& socket,
+    QWidget* parentObj)
+  : Base(parentObj),
+    m_socket(socket)
+{
+    m_ui.setupUi(this);
+
+    m_ui.m_fileLineEdit->setText(m_socket.getFile());
+    m_ui.m_speedSpinBox->setValue(m_socket.getSpeed());
+    m_ui.m_maxSpeedCheckBox->setChecked(m_socket.getMaxSpeed());
+    m_ui.m_speedSpinBox->setEnabled(!m_socket.getMaxSpeed());
+
+    connect(
+        m_ui.m_fileLineEdit, SIGNAL(textChanged(const QString&)),
+        this, SLOT(fileValueChanged(const QString&)));
+
+    connect(
+        m_ui.m_browsePushButton, SIGNAL(clicked()),
+        this, SLOT(browseClicked()));
+
+    connect(
+        m_ui.m_speedSpinBox, SIGNAL(valueChanged(double)),
+        this, SLOT(speedValueChanged(double)));
+
+    connect(
+        m_ui.m_maxSpeedCheckBox, SIGNAL(toggled(bool)),
+        this, SLOT(maxSpeedToggled(bool)));
+}
+
+SocketConfigWidget::~SocketConfigWidget() = default;
+
+void SocketConfigWidget::fileValueChanged(const QString& value)
+{
+    m_socket.setFile(value);
+}
+
+void SocketConfigWidget::browseClicked()
+{
+    auto filename =
+        QFileDialog::getOpenFileName(
+            this,
+            tr("Select Capture File"),
+            m_socket.getFile());
+
+    if (!filename.isEmpty()) {
+        m_ui.m_fileLineEdit->setText(filename);
+    }
+}
+
+void SocketConfigWidget::speedValueChanged(double value)
+{
+    m_socket.setSpeed(value);
+}
+
+void SocketConfigWidget::maxSpeedToggled(bool checked)
+{
+    m_socket.setMaxSpeed(checked);
+    m_ui.m_speedSpinBox->setEnabled(!checked);
+}
+
+}  // namespace replay_socket
+
+}  // namespace plugin
+
+}  // namespace comms_champion
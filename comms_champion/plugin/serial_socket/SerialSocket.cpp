@@ -93,6 +93,11 @@ void SerialSocket::sendDataImpl(DataInfoPtr dataPtr)
         dataPtr->m_data.size());
 }
 
+std::size_t SerialSocket::pendingBytesImpl() const
+{
+    return static_cast<std::size_t>(m_serial.bytesToWrite());
+}
+
 void SerialSocket::performRead()
 {
     assert(sender() == &m_serial);
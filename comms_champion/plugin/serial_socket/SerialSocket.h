@@ -89,6 +89,7 @@ protected:
     virtual bool socketConnectImpl() override;
     virtual void socketDisconnectImpl() override;
     virtual void sendDataImpl(DataInfoPtr dataPtr) override;
+    virtual std::size_t pendingBytesImpl() const override;
 
 private slots:
     void performRead();
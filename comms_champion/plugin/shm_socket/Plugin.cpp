@@ -0,0 +1,106 @@
+//
+// Copyright 2016 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "Plugin.h"
+
+#include <memory>
+#include <cassert>
+
+#include "SocketConfigWidget.h"
+
+namespace comms_champion
+{
+
+namespace plugin
+{
+
+namespace shm_socket
+{
+
+namespace
+{
+
+const QString MainConfigKey("cc_shm_socket");
+const QString NameSubKey("name");
+const QString CapacitySubKey("capacity");
+
+}  // namespace
+
+Plugin::Plugin()
+{
+    pluginProperties()
+        .setSocketCreateFunc(
+            [this]() -> SocketPtr
+            {
+                createSocketIfNeeded();
+                return m_socket;
+            })
+        .setConfigWidgetCreateFunc(
+            [this]() -> QWidget*
+            {
+                createSocketIfNeeded();
+                return new SocketConfigWidget(*m_socket);
+            });
+}
+
+Plugin::~Plugin() = default;
+
+void Plugin::getCurrentConfigImpl(QVariantMap& config)
+{
+    createSocketIfNeeded();
+
+    QVariantMap subConfig;
+    subConfig.insert(NameSubKey, m_socket->getName());
+    subConfig.insert(CapacitySubKey, static_cast<qulonglong>(m_socket->getCapacity()));
+    config.insert(MainConfigKey, QVariant::fromValue(subConfig));
+}
+
+void Plugin::reconfigureImpl(const QVariantMap& config)
+{
+    auto subConfigVar = config.value(MainConfigKey);
+    if ((!subConfigVar.isValid()) || (!subConfigVar.canConvert<QVariantMap>())) {
+        return;
+    }
+
+    createSocketIfNeeded();
+    assert(m_socket);
+
+    auto subConfig = subConfigVar.value<QVariantMap>();
+    auto nameVar = subConfig.value(NameSubKey);
+    if (nameVar.isValid() && nameVar.canConvert<QString>()) {
+        m_socket->setName(nameVar.value<QString>());
+    }
+
+    auto capacityVar = subConfig.value(CapacitySubKey);
+    if (capacityVar.isValid() && capacityVar.canConvert<qulonglong>()) {
+        m_socket->setCapacity(static_cast<std::size_t>(capacityVar.value<qulonglong>()));
+    }
+}
+
+void Plugin::createSocketIfNeeded()
+{
+    if (!m_socket) {
+        m_socket.reset(new Socket());
+    }
+}
+
+}  // namespace shm_socket
+
+}  // namespace plugin
+
+}  // namespace comms_champion
@@ -0,0 +1,269 @@
+//
+// Copyright 2016 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "Socket.h"
+
+#include <cassert>
+#include <algorithm>
+#include <iterator>
+
+namespace comms_champion
+{
+
+namespace plugin
+{
+
+namespace shm_socket
+{
+
+namespace
+{
+
+const QString DefaultName("/cc_shm");
+const std::size_t ReadBatchSize = 256U;
+const std::size_t MaxQueuedCount = 64U * 1024U;
+const unsigned WaitTimeoutMs = 100U;
+
+std::string rxRingName(const QString& name)
+{
+    return name.toStdString() + "_rx";
+}
+
+std::string txRingName(const QString& name)
+{
+    return name.toStdString() + "_tx";
+}
+
+}  // namespace
+
+Socket::Socket()
+  : m_name(DefaultName),
+    m_stopRequested(false)
+{
+}
+
+Socket::~Socket()
+{
+    stopThread();
+}
+
+bool Socket::socketConnectImpl()
+{
+    if (m_thread.joinable()) {
+        assert(!"Already connected");
+        static const QString AlreadyConnectedError(
+            tr("Previous run of shared memory socket wasn't terminated properly."));
+        reportError(AlreadyConnectedError);
+        return false;
+    }
+
+    if ((!m_rxRing.create(rxRingName(m_name), m_capacity)) ||
+        (!m_txRing.create(txRingName(m_name), m_capacity))) {
+        static const QString FailedToCreateError(
+            tr("Failed to create shared memory ring: "));
+        auto& ring = m_rxRing.isOpen() ? m_txRing : m_rxRing;
+        reportError(FailedToCreateError + QString::fromStdString(ring.errorString()));
+        m_rxRing.close();
+        m_txRing.close();
+        return false;
+    }
+
+    m_stopRequested = false;
+    m_thread = std::thread(
+        [this]()
+        {
+            run();
+        });
+    return true;
+}
+
+void Socket::socketDisconnectImpl()
+{
+    stopThread();
+}
+
+void Socket::sendDataImpl(DataInfoPtr dataPtr)
+{
+    assert(dataPtr);
+    auto& data = dataPtr->m_data;
+    bool written = m_txRing.write(data.data(), data.size());
+
+    std::lock_guard<std::mutex> guard(m_lock);
+    if (!written) {
+        ++m_stats.m_droppedCount;
+        return;
+    }
+
+    ++m_stats.m_sentCount;
+    m_stats.m_sentBytesCount += data.size();
+}
+
+unsigned Socket::connectionPropertiesImpl() const
+{
+    return ConnectionProperty_Autoconnect;
+}
+
+std::size_t Socket::pendingBytesImpl() const
+{
+    // Records the peer hasn't consumed yet, new ones are dropped when
+    // the ring is full
+    return m_txRing.usedBytes();
+}
+
+Socket::StatsList Socket::statsImpl() const
+{
+    Stats stats;
+    std::size_t queuedCount = 0U;
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        stats = m_stats;
+        queuedCount = m_received.size();
+    }
+
+    StatsList result;
+    result.emplace_back("rx_records", stats.m_receivedCount);
+    result.emplace_back("rx_bytes", stats.m_receivedBytesCount);
+    result.emplace_back("rx_batches", stats.m_batchesCount);
+    result.emplace_back("rx_max_batch", static_cast<qulonglong>(stats.m_maxBatchSize));
+    result.emplace_back("rx_queued", static_cast<qulonglong>(queuedCount));
+    result.emplace_back("tx_records", stats.m_sentCount);
+    result.emplace_back("tx_bytes", stats.m_sentBytesCount);
+    result.emplace_back("tx_dropped", stats.m_droppedCount);
+    result.emplace_back("tx_ring_used_bytes", static_cast<qulonglong>(m_txRing.usedBytes()));
+    return result;
+}
+
+void Socket::processReceived()
+{
+    // Reuse the cached storage while staying safe against reentrant calls
+    DataInfosList received;
+    received.swap(m_pending);
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        received.swap(m_received);
+    }
+    m_queueCond.notify_one();
+
+    for (auto& dataPtr : received) {
+        if (!m_thread.joinable()) {
+            break;
+        }
+
+        reportDataReceived(std::move(dataPtr));
+    }
+
+    received.clear();
+    m_pending.swap(received);
+}
+
+void Socket::run()
+{
+    DataInfosList batch;
+    batch.reserve(ReadBatchSize);
+    while (true) {
+        // Leave the data in the ring while the queue is full,
+        // the producer gets backpressure from the full ring
+        auto space = waitForQueueSpace();
+        if (m_stopRequested) {
+            break;
+        }
+
+        auto timestamp = DataInfo::TimestampClock::now();
+        auto count =
+            m_rxRing.read(
+                [&batch, timestamp](const std::uint8_t* data, std::size_t size)
+                {
+                    auto dataPtr = makeDataInfo();
+                    dataPtr->m_timestamp = timestamp;
+                    dataPtr->m_data.assign(data, data + size);
+                    batch.push_back(std::move(dataPtr));
+                },
+                std::min(ReadBatchSize, space));
+
+        if (count == 0U) {
+            m_rxRing.waitForData(WaitTimeoutMs);
+            continue;
+        }
+
+        postReceived(batch);
+    }
+}
+
+std::size_t Socket::waitForQueueSpace()
+{
+    std::unique_lock<std::mutex> guard(m_lock);
+    m_queueCond.wait(
+        guard,
+        [this]() -> bool
+        {
+            return m_stopRequested || (m_received.size() < MaxQueuedCount);
+        });
+
+    if (m_stopRequested) {
+        return 0U;
+    }
+
+    return MaxQueuedCount - m_received.size();
+}
+
+void Socket::postReceived(DataInfosList& batch)
+{
+    bool notify = false;
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        ++m_stats.m_batchesCount;
+        m_stats.m_maxBatchSize = std::max(m_stats.m_maxBatchSize, batch.size());
+        m_stats.m_receivedCount += batch.size();
+        for (auto& dataPtr : batch) {
+            m_stats.m_receivedBytesCount += dataPtr->m_data.size();
+        }
+
+        notify = m_received.empty();
+        std::move(batch.begin(), batch.end(), std::back_inserter(m_received));
+    }
+
+    batch.clear();
+    if (notify) {
+        QMetaObject::invokeMethod(this, "processReceived", Qt::QueuedConnection);
+    }
+}
+
+void Socket::stopThread()
+{
+    if (m_thread.joinable()) {
+        {
+            std::lock_guard<std::mutex> guard(m_lock);
+            m_stopRequested = true;
+        }
+        m_queueCond.notify_all();
+        m_rxRing.wakeConsumer();
+        m_thread.join();
+    }
+
+    m_rxRing.close();
+    m_txRing.close();
+
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_received.clear();
+}
+
+}  // namespace shm_socket
+
+}  // namespace plugin
+
+}  // namespace comms_champion
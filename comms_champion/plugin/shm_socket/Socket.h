@@ -0,0 +1,127 @@
+//
+// Copyright 2016 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+#include "comms/CompileControl.h"
+
+CC_DISABLE_WARNINGS()
+#include <QtCore/QObject>
+#include <QtCore/QString>
+CC_ENABLE_WARNINGS()
+
+#include "comms_champion/Socket.h"
+#include "comms_champion/ShmRing.h"
+
+
+namespace comms_champion
+{
+
+namespace plugin
+{
+
+namespace shm_socket
+{
+
+class Socket : public QObject,
+               public comms_champion::Socket
+{
+    Q_OBJECT
+    using Base = comms_champion::Socket;
+
+public:
+    Socket();
+    ~Socket();
+
+    void setName(const QString& value)
+    {
+        m_name = value;
+    }
+
+    const QString& getName() const
+    {
+        return m_name;
+    }
+
+    void setCapacity(std::size_t value)
+    {
+        m_capacity = value;
+    }
+
+    std::size_t getCapacity() const
+    {
+        return m_capacity;
+    }
+
+protected:
+    virtual bool socketConnectImpl() override;
+    virtual void socketDisconnectImpl() override;
+    virtual void sendDataImpl(DataInfoPtr dataPtr) override;
+    virtual unsigned connectionPropertiesImpl() const override;
+    virtual std::size_t pendingBytesImpl() const override;
+    virtual StatsList statsImpl() const override;
+
+private slots:
+    void processReceived();
+
+private:
+    struct Stats
+    {
+        unsigned long long m_receivedCount = 0U;
+        unsigned long long m_receivedBytesCount = 0U;
+        unsigned long long m_sentCount = 0U;
+        unsigned long long m_sentBytesCount = 0U;
+        unsigned long long m_droppedCount = 0U;
+        unsigned long long m_batchesCount = 0U;
+        std::size_t m_maxBatchSize = 0U;
+    };
+
+    typedef std::vector<DataInfoPtr> DataInfosList;
+
+    void run();
+    std::size_t waitForQueueSpace();
+    void postReceived(DataInfosList& batch);
+    void stopThread();
+
+    QString m_name;
+    std::size_t m_capacity = ShmRing::DefaultCapacity;
+    ShmRing m_rxRing;
+    ShmRing m_txRing;
+    std::thread m_thread;
+    std::atomic<bool> m_stopRequested;
+
+    mutable std::mutex m_lock;
+    std::condition_variable m_queueCond;
+    DataInfosList m_received;
+    Stats m_stats;
+
+    DataInfosList m_pending;
+};
+
+}  // namespace shm_socket
+
+}  // namespace plugin
+
+}  // namespace comms_champion
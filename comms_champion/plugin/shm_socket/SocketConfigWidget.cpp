@@ -0,0 +1,78 @@
+//
+// Copyright 2016 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "SocketConfigWidget.h"
+
+namespace comms_champion
+{
+
+namespace plugin
+{
+
+namespace shm_socket
+{
+
+namespace
+{
+
+const std::size_t KiloByte = 1024U;
+const int MinCapacityKb = static_cast<int>(ShmRing::MinCapacity / KiloByte);
+const int MaxCapacityKb = 1024 * 1024;
+
+}  // namespace
+
+SocketConfigWidget::SocketConfigWidget(
+    Socket& socket,
+    QWidget* parentObj)
+  : Base(parentObj),
+    m_socket(socket)
+{
+    m_ui.setupUi(this);
+
+    m_ui.m_nameLineEdit->setText(m_socket.getName());
+
+    m_ui.m_capacitySpinBox->setRange(MinCapacityKb, MaxCapacityKb);
+    m_ui.m_capacitySpinBox->setValue(
+        static_cast<int>(m_socket.getCapacity() / KiloByte));
+
+    connect(
+        m_ui.m_nameLineEdit, SIGNAL(textChanged(const QString&)),
+        this, SLOT(nameValueChanged(const QString&)));
+
+    connect(
+        m_ui.m_capacitySpinBox, SIGNAL(valueChanged(int)),
+        this, SLOT(capacityValueChanged(int)));
+}
+
+SocketConfigWidget::~SocketConfigWidget() = default;
+
+void SocketConfigWidget::nameValueChanged(const QString& value)
+{
+    m_socket.setName(value);
+}
+
+void SocketConfigWidget::capacityValueChanged(int value)
+{
+    m_socket.setCapacity(static_cast<std::size_t>(value) * KiloByte);
+}
+
+}  // namespace shm_socket
+
+}  // namespace plugin
+
+}  // namespace comms_champion
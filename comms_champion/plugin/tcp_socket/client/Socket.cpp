@@ -23,6 +23,7 @@ CC_DISABLE_WARNINGS()
 #include <QtNetwork/QHostAddress>
 CC_ENABLE_WARNINGS()
 
+#include "comms_champion/EndpointRegistry.h"
 #include "Socket.h"
 
 namespace comms_champion
@@ -40,13 +41,22 @@ namespace client
 namespace
 {
 
-const QString FromPropName("tcp.from");
-const QString ToPropName("tcp.to");
+EndpointRegistry::TransportId transportId()
+{
+    static const auto Id = EndpointRegistry::instanceRef().registerTransport("tcp");
+    return Id;
+}
+
+DataInfo::EndpointId endpointId(const QHostAddress& address, quint16 port)
+{
+    return EndpointRegistry::instanceRef().internHost(transportId(), address, port);
+}
 
 }  // namespace
 
 
 Socket::Socket()
+  : m_txQueue(m_socket)
 {
     connect(
         &m_socket, SIGNAL(disconnected()),
@@ -62,6 +72,7 @@ Socket::Socket()
 Socket::~Socket()
 {
     m_socket.blockSignals(true);
+    m_txQueue.flush();
 }
 
 bool Socket::socketConnectImpl()
@@ -89,6 +100,7 @@ bool Socket::socketConnectImpl()
 void Socket::socketDisconnectImpl()
 {
     m_socket.blockSignals(true);
+    m_txQueue.flush();
     m_socket.flush();
     m_socket.disconnectFromHost();
     m_socket.close();
@@ -98,21 +110,21 @@ void Socket::socketDisconnectImpl()
 void Socket::sendDataImpl(DataInfoPtr dataPtr)
 {
     assert(dataPtr);
-    m_socket.write(
-        reinterpret_cast<const char*>(&dataPtr->m_data[0]),
-        dataPtr->m_data.size());
-
-    QString from =
-        m_socket.localAddress().toString() + ':' +
-                    QString("%1").arg(m_socket.localPort());
-    QString to =
-        m_socket.peerAddress().toString() + ':' +
-                    QString("%1").arg(m_socket.peerPort());
-
+    dataPtr->m_fromEndpoint = endpointId(m_socket.localAddress(), m_socket.localPort());
+    dataPtr->m_toEndpoint = endpointId(m_socket.peerAddress(), m_socket.peerPort());
+    m_txQueue.push(std::move(dataPtr));
+}
 
-    dataPtr->m_extraProperties.insert(FromPropName, from);
-    dataPtr->m_extraProperties.insert(ToPropName, to);
+std::size_t Socket::pendingBytesImpl() const
+{
+    return m_txQueue.pendingBytes();
+}
 
+Socket::StatsList Socket::statsImpl() const
+{
+    StatsList result;
+    m_txQueue.getStats().report(result);
+    return result;
 }
 
 void Socket::socketDisconnected()
@@ -121,6 +133,7 @@ void Socket::socketDisconnected()
 //        tr("Connection to TCP/IP Server was disconnected."));
 //    reportError(DisconnectedError);
 
+    m_txQueue.clear();
     reportDisconnected();
 }
 
@@ -140,15 +153,8 @@ void Socket::readFromSocket()
         dataPtr->m_data.resize(result);
     }
 
-    QString from =
-        m_socket.peerAddress().toString() + ':' +
-                    QString("%1").arg(m_socket.peerPort());
-    QString to =
-        m_socket.localAddress().toString() + ':' +
-                    QString("%1").arg(m_socket.localPort());
-
-    dataPtr->m_extraProperties.insert(FromPropName, from);
-    dataPtr->m_extraProperties.insert(ToPropName, to);
+    dataPtr->m_fromEndpoint = endpointId(m_socket.peerAddress(), m_socket.peerPort());
+    dataPtr->m_toEndpoint = endpointId(m_socket.localAddress(), m_socket.localPort());
     reportDataReceived(std::move(dataPtr));
 }
 
@@ -26,6 +26,7 @@ CC_DISABLE_WARNINGS()
 CC_ENABLE_WARNINGS()
 
 #include "comms_champion/Socket.h"
+#include "common/TransmitQueue.h"
 
 
 namespace comms_champion
@@ -72,11 +73,12 @@ public:
         return m_port;
     }
 
-
 protected:
     virtual bool socketConnectImpl() override;
     virtual void socketDisconnectImpl() override;
     virtual void sendDataImpl(DataInfoPtr dataPtr) override;
+    virtual std::size_t pendingBytesImpl() const override;
+    virtual StatsList statsImpl() const override;
 
 private slots:
     void socketDisconnected();
@@ -88,6 +90,7 @@ private:
     QString m_host;
     PortType m_port = DefaultPort;
     QTcpSocket m_socket;
+    TransmitQueue m_txQueue;
 };
 
 }  // namespace client
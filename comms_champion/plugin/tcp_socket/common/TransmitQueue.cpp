@@ -0,0 +1,227 @@
+//
+// Copyright 2016 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "TransmitQueue.h"
+
+#include <cassert>
+#include <algorithm>
+
+#ifdef Q_OS_UNIX
+#include <cerrno>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#endif
+
+namespace comms_champion
+{
+
+namespace plugin
+{
+
+namespace tcp_socket
+{
+
+namespace
+{
+
+#ifdef Q_OS_UNIX
+const std::size_t MaxIoVecCount = 64U;
+
+#ifdef MSG_NOSIGNAL
+const int SendFlags = MSG_NOSIGNAL;
+#else
+const int SendFlags = 0;
+#endif
+
+#endif
+
+}  // namespace
+
+const std::size_t TransmitQueue::DefaultFlushThreshold;
+
+void TransmitQueue::Stats::add(const Stats& other)
+{
+    m_framesCount += other.m_framesCount;
+    m_bytesCount += other.m_bytesCount;
+    m_flushesCount += other.m_flushesCount;
+    m_vectoredWritesCount += other.m_vectoredWritesCount;
+    m_bufferedWritesCount += other.m_bufferedWritesCount;
+    m_maxFramesPerFlush = std::max(m_maxFramesPerFlush, other.m_maxFramesPerFlush);
+}
+
+void TransmitQueue::Stats::report(comms_champion::Socket::StatsList& list) const
+{
+    list.emplace_back("tx_frames", m_framesCount);
+    list.emplace_back("tx_bytes", m_bytesCount);
+    list.emplace_back("tx_flushes", m_flushesCount);
+    list.emplace_back("tx_vectored_writes", m_vectoredWritesCount);
+    list.emplace_back("tx_buffered_writes", m_bufferedWritesCount);
+    list.emplace_back("tx_max_frames_per_flush", static_cast<qulonglong>(m_maxFramesPerFlush));
+}
+
+TransmitQueue::TransmitQueue(QTcpSocket& socket)
+  : m_socket(socket)
+{
+    m_timer.setSingleShot(true);
+    connect(
+        &m_timer, SIGNAL(timeout()),
+        this, SLOT(flush()));
+}
+
+TransmitQueue::~TransmitQueue() = default;
+
+void TransmitQueue::push(DataInfoPtr dataPtr)
+{
+    assert(dataPtr);
+    if (dataPtr->m_data.empty()) {
+        return;
+    }
+
+    m_pendingBytes += dataPtr->m_data.size();
+    m_frames.push_back(std::move(dataPtr));
+    ++m_stats.m_framesCount;
+
+    if (m_flushThreshold <= m_pendingBytes) {
+        flush();
+        return;
+    }
+
+    if (!m_timer.isActive()) {
+        m_timer.start(0);
+    }
+}
+
+void TransmitQueue::clear()
+{
+    m_timer.stop();
+    m_frames.clear();
+    m_pendingBytes = 0U;
+}
+
+void TransmitQueue::flush()
+{
+    m_timer.stop();
+    if (m_frames.empty()) {
+        return;
+    }
+
+    ++m_stats.m_flushesCount;
+    m_stats.m_maxFramesPerFlush = std::max(m_stats.m_maxFramesPerFlush, m_frames.size());
+    m_stats.m_bytesCount += m_pendingBytes;
+
+    std::size_t written = 0U;
+    if ((m_socket.state() == QAbstractSocket::ConnectedState) &&
+        (m_socket.bytesToWrite() == 0) &&
+        (1U < m_frames.size())) {
+        written = writeVectored();
+    }
+
+    if (written < m_pendingBytes) {
+        writeBuffered(written);
+    }
+
+    clear();
+}
+
+std::size_t TransmitQueue::writeVectored()
+{
+#ifdef Q_OS_UNIX
+    auto fd = m_socket.socketDescriptor();
+    if (fd < 0) {
+        return 0U;
+    }
+
+    std::size_t written = 0U;
+    std::size_t frameIdx = 0U;
+    while (frameIdx < m_frames.size()) {
+        struct iovec iov[MaxIoVecCount];
+        std::size_t iovCount = 0U;
+        std::size_t expected = 0U;
+        for (; (frameIdx < m_frames.size()) && (iovCount < MaxIoVecCount); ++frameIdx) {
+            auto& data = m_frames[frameIdx]->m_data;
+            iov[iovCount].iov_base = &data[0];
+            iov[iovCount].iov_len = data.size();
+            expected += data.size();
+            ++iovCount;
+        }
+
+        struct msghdr msg;
+        std::fill_n(reinterpret_cast<char*>(&msg), sizeof(msg), 0);
+        msg.msg_iov = &iov[0];
+        msg.msg_iovlen = static_cast<decltype(msg.msg_iovlen)>(iovCount);
+
+        ssize_t result = -1;
+        do {
+            result = ::sendmsg(static_cast<int>(fd), &msg, SendFlags);
+        } while ((result < 0) && (errno == EINTR));
+
+        ++m_stats.m_vectoredWritesCount;
+        if (result <= 0) {
+            break;
+        }
+
+        written += static_cast<std::size_t>(result);
+        if (static_cast<std::size_t>(result) < expected) {
+            break;
+        }
+    }
+
+    return written;
+#else
+    return 0U;
+#endif
+}
+
+void TransmitQueue::writeBuffered(std::size_t skipCount)
+{
+    assert(skipCount < m_pendingBytes);
+    if ((skipCount == 0U) && (m_frames.size() == 1U)) {
+        auto& data = m_frames.front()->m_data;
+        m_socket.write(
+            reinterpret_cast<const char*>(&data[0]),
+            data.size());
+        ++m_stats.m_bufferedWritesCount;
+        return;
+    }
+
+    QByteArray buf;
+    buf.reserve(static_cast<int>(m_pendingBytes - skipCount));
+    for (auto& dataPtr : m_frames) {
+        auto& data = dataPtr->m_data;
+        if (data.size() <= skipCount) {
+            skipCount -= data.size();
+            continue;
+        }
+
+        buf.append(
+            reinterpret_cast<const char*>(&data[skipCount]),
+            static_cast<int>(data.size() - skipCount));
+        skipCount = 0U;
+    }
+
+    m_socket.write(buf);
+    ++m_stats.m_bufferedWritesCount;
+}
+
+}  // namespace tcp_socket
+
+} // namespace plugin
+
+} // namespace comms_champion
+
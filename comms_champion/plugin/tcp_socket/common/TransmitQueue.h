@@ -0,0 +1,114 @@
+//
+// Copyright 2016 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "comms/CompileControl.h"
+
+CC_DISABLE_WARNINGS()
+#include <QtCore/QObject>
+#include <QtCore/QTimer>
+#include <QtNetwork/QTcpSocket>
+CC_ENABLE_WARNINGS()
+
+#include "comms_champion/DataInfo.h"
+#include "comms_champion/Socket.h"
+
+
+namespace comms_champion
+{
+
+namespace plugin
+{
+
+namespace tcp_socket
+{
+
+class TransmitQueue : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Stats
+    {
+        unsigned long long m_framesCount = 0U;
+        unsigned long long m_bytesCount = 0U;
+        unsigned long long m_flushesCount = 0U;
+        unsigned long long m_vectoredWritesCount = 0U;
+        unsigned long long m_bufferedWritesCount = 0U;
+        std::size_t m_maxFramesPerFlush = 0U;
+
+        void add(const Stats& other);
+        void report(comms_champion::Socket::StatsList& list) const;
+    };
+
+    static const std::size_t DefaultFlushThreshold = 64U * 1024U;
+
+    explicit TransmitQueue(QTcpSocket& socket);
+    ~TransmitQueue();
+
+    void push(DataInfoPtr dataPtr);
+
+    void clear();
+
+    void setFlushThreshold(std::size_t value)
+    {
+        m_flushThreshold = value;
+    }
+
+    std::size_t getFlushThreshold() const
+    {
+        return m_flushThreshold;
+    }
+
+    // Queued bytes and the ones buffered by the socket
+    std::size_t pendingBytes() const
+    {
+        return m_pendingBytes + static_cast<std::size_t>(m_socket.bytesToWrite());
+    }
+
+    const Stats& getStats() const
+    {
+        return m_stats;
+    }
+
+public slots:
+    void flush();
+
+private:
+    std::size_t writeVectored();
+    void writeBuffered(std::size_t skipCount);
+
+    QTcpSocket& m_socket;
+    std::vector<DataInfoPtr> m_frames;
+    std::size_t m_pendingBytes = 0U;
+    std::size_t m_flushThreshold = DefaultFlushThreshold;
+    QTimer m_timer;
+    Stats m_stats;
+};
+
+}  // namespace tcp_socket
+
+} // namespace plugin
+
+} // namespace comms_champion
+
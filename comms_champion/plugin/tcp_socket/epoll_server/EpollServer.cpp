@@ -0,0 +1,832 @@
+//
+// Copyright 2016 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "EpollServer.h"
+
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+#include <iterator>
+#include <initializer_list>
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+CC_DISABLE_WARNINGS()
+#include <QtNetwork/QHostAddress>
+CC_ENABLE_WARNINGS()
+
+#include "comms_champion/EndpointRegistry.h"
+
+namespace comms_champion
+{
+
+namespace plugin
+{
+
+namespace tcp_socket
+{
+
+namespace epoll_server
+{
+
+namespace
+{
+
+const int MaxEpollEvents = 256;
+const std::size_t ReadBufSize = 64U * 1024U;
+const std::size_t MaxWriteIovs = 64U;
+
+// Received data not taken by the GUI thread yet, reading of the connections
+// is paused above it
+const std::size_t MaxPendingEventBytes = 16U * 1024U * 1024U;
+
+// Per connection write backlog, reading of the connection is paused above
+// the first limit and the connection is closed above the second one
+const std::size_t PausePendingWriteBytes = 2U * 1024U * 1024U;
+const std::size_t MaxPendingWriteBytes = 4U * 1024U * 1024U;
+
+// Data sent by the GUI thread and not taken by the worker yet, the rest is
+// dropped
+const std::size_t MaxOutgoingBytes = 16U * 1024U * 1024U;
+
+const std::uint32_t ConnEpollEvents = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+const std::uint32_t PausedConnEpollEvents = EPOLLOUT | EPOLLET;
+
+// Connections are tagged by stream id, which never exceeds 32 bits
+const std::uint64_t ListenTag = 0x100000000ULL;
+const std::uint64_t WakeTag = ListenTag + 1U;
+
+QString lastErrorString()
+{
+    return QString::fromLocal8Bit(std::strerror(errno));
+}
+
+bool wouldBlock(int err)
+{
+#if EAGAIN == EWOULDBLOCK
+    return err == EAGAIN;
+#else
+    return (err == EAGAIN) || (err == EWOULDBLOCK);
+#endif
+}
+
+EndpointRegistry::TransportId transportId()
+{
+    static const auto Id = EndpointRegistry::instanceRef().registerTransport("tcp");
+    return Id;
+}
+
+DataInfo::EndpointId endpointId(const struct sockaddr_storage& addr)
+{
+    QHostAddress address(reinterpret_cast<const struct sockaddr*>(&addr));
+    bool mappedIpv4 = false;
+    auto ipv4 = address.toIPv4Address(&mappedIpv4);
+    if (mappedIpv4) {
+        address = QHostAddress(ipv4);
+    }
+
+    quint16 port = 0U;
+    if (addr.ss_family == AF_INET6) {
+        port = ntohs(reinterpret_cast<const struct sockaddr_in6*>(&addr)->sin6_port);
+    }
+    else {
+        port = ntohs(reinterpret_cast<const struct sockaddr_in*>(&addr)->sin_port);
+    }
+
+    return EndpointRegistry::instanceRef().internHost(transportId(), address, port);
+}
+
+// Every connection requires a descriptor, use the whole allowed range,
+// the default soft limit of 1024 is too low for thousands of clients
+std::size_t raiseFilesLimit()
+{
+    struct rlimit limit;
+    if (::getrlimit(RLIMIT_NOFILE, &limit) != 0) {
+        return 0U;
+    }
+
+    if ((limit.rlim_cur != RLIM_INFINITY) && (limit.rlim_cur < limit.rlim_max)) {
+        auto prevCur = limit.rlim_cur;
+        limit.rlim_cur = limit.rlim_max;
+        if (::setrlimit(RLIMIT_NOFILE, &limit) != 0) {
+            limit.rlim_cur = prevCur;
+        }
+    }
+
+    return static_cast<std::size_t>(limit.rlim_cur);
+}
+
+bool addToEpoll(int epollFd, int fd, std::uint32_t events, std::uint64_t tag)
+{
+    struct epoll_event ev;
+    std::memset(&ev, 0, sizeof(ev));
+    ev.events = events;
+    ev.data.u64 = tag;
+    return ::epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev) == 0;
+}
+
+}  // namespace
+
+EpollServer::EpollServer()
+  : m_stopRequested(false)
+{
+}
+
+EpollServer::~EpollServer()
+{
+    stop();
+}
+
+bool EpollServer::start(PortType port, QString& error)
+{
+    if (isRunning()) {
+        error = "Epoll server is already running.";
+        return false;
+    }
+
+    auto filesLimit = raiseFilesLimit();
+
+    bool ipv6 = true;
+    m_listenFd = ::socket(AF_INET6, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (m_listenFd < 0) {
+        ipv6 = false;
+        m_listenFd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    }
+
+    if (m_listenFd < 0) {
+        error = "Failed to create TCP socket: " + lastErrorString();
+        return false;
+    }
+
+    int enabled = 1;
+    ::setsockopt(m_listenFd, SOL_SOCKET, SO_REUSEADDR, &enabled, sizeof(enabled));
+
+    struct sockaddr_storage addr;
+    std::memset(&addr, 0, sizeof(addr));
+    socklen_t addrLen = 0;
+    if (ipv6) {
+        int disabled = 0;
+        ::setsockopt(m_listenFd, IPPROTO_IPV6, IPV6_V6ONLY, &disabled, sizeof(disabled));
+
+        auto* addr6 = reinterpret_cast<struct sockaddr_in6*>(&addr);
+        addr6->sin6_family = AF_INET6;
+        addr6->sin6_addr = in6addr_any;
+        addr6->sin6_port = htons(port);
+        addrLen = sizeof(struct sockaddr_in6);
+    }
+    else {
+        auto* addr4 = reinterpret_cast<struct sockaddr_in*>(&addr);
+        addr4->sin_family = AF_INET;
+        addr4->sin_addr.s_addr = htonl(INADDR_ANY);
+        addr4->sin_port = htons(port);
+        addrLen = sizeof(struct sockaddr_in);
+    }
+
+    if (::bind(m_listenFd, reinterpret_cast<struct sockaddr*>(&addr), addrLen) != 0) {
+        error =
+            "Failed to bind TCP socket to port " + QString("%1").arg(port) +
+            ": " + lastErrorString();
+        closeAll();
+        return false;
+    }
+
+    if (::listen(m_listenFd, SOMAXCONN) != 0) {
+        error = "Failed to listen on TCP socket: " + lastErrorString();
+        closeAll();
+        return false;
+    }
+
+    addrLen = sizeof(addr);
+    if (::getsockname(m_listenFd, reinterpret_cast<struct sockaddr*>(&addr), &addrLen) == 0) {
+        m_localEndpoint = endpointId(addr);
+        if (addr.ss_family == AF_INET6) {
+            m_localPort = ntohs(reinterpret_cast<const struct sockaddr_in6*>(&addr)->sin6_port);
+        }
+        else {
+            m_localPort = ntohs(reinterpret_cast<const struct sockaddr_in*>(&addr)->sin_port);
+        }
+    }
+
+    m_epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+    m_wakeFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    m_spareFd = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+    if ((m_epollFd < 0) || (m_wakeFd < 0) || (m_spareFd < 0)) {
+        error = "Failed to create epoll instance: " + lastErrorString();
+        closeAll();
+        return false;
+    }
+
+    if ((!addToEpoll(m_epollFd, m_listenFd, EPOLLIN | EPOLLET, ListenTag)) ||
+        (!addToEpoll(m_epollFd, m_wakeFd, EPOLLIN | EPOLLET, WakeTag))) {
+        error = "Failed to register with epoll: " + lastErrorString();
+        closeAll();
+        return false;
+    }
+
+    m_readBuf.resize(ReadBufSize);
+    m_workerStats = Stats();
+    m_workerStats.m_filesLimit = filesLimit;
+    m_maxPendingWritesDirty = false;
+    m_stopRequested = false;
+    m_thread = std::thread(
+        [this]()
+        {
+            run();
+        });
+    return true;
+}
+
+void EpollServer::stop()
+{
+    if (isRunning()) {
+        m_stopRequested = true;
+        wakeup();
+        m_thread.join();
+    }
+
+    closeAll();
+
+    m_pausedStreams.clear();
+    m_localEventBytes = 0U;
+    m_queuedEventBytes = 0U;
+
+    std::lock_guard<std::mutex> guard(m_lock);
+    m_events.clear();
+    m_pendingEventBytes = 0U;
+    m_resumeRequired = false;
+    m_outgoing.clear();
+    m_outgoingBytes = 0U;
+    m_droppedSendsCount = 0U;
+    m_stats.m_connectionsCount = 0U;
+    m_stats.m_maxPendingWriteBytes = 0U;
+}
+
+void EpollServer::takeEvents(EventsList& events)
+{
+    events.clear();
+    bool resume = false;
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        events.swap(m_events);
+        m_pendingEventBytes = 0U;
+        resume = m_resumeRequired;
+        m_resumeRequired = false;
+    }
+
+    if (resume) {
+        wakeup();
+    }
+}
+
+bool EpollServer::send(DataInfoPtr dataPtr)
+{
+    assert(dataPtr);
+    if ((!isRunning()) || dataPtr->m_data.empty()) {
+        return true;
+    }
+
+    bool wasEmpty = false;
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        if (MaxOutgoingBytes < (m_outgoingBytes + dataPtr->m_data.size())) {
+            ++m_droppedSendsCount;
+            return false;
+        }
+
+        wasEmpty = m_outgoing.empty();
+        m_outgoingBytes += dataPtr->m_data.size();
+        m_outgoing.push_back(std::move(dataPtr));
+    }
+
+    if (wasEmpty) {
+        wakeup();
+    }
+    return true;
+}
+
+EpollServer::Stats EpollServer::getStats() const
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    auto result = m_stats;
+    result.m_droppedSendsCount = m_droppedSendsCount;
+    return result;
+}
+
+std::size_t EpollServer::pendingBytes() const
+{
+    std::lock_guard<std::mutex> guard(m_lock);
+    return m_outgoingBytes + m_stats.m_maxPendingWriteBytes;
+}
+
+void EpollServer::run()
+{
+    struct epoll_event readyEvents[MaxEpollEvents];
+    EventsList events;
+
+    while (!m_stopRequested) {
+        auto count = ::epoll_wait(m_epollFd, &readyEvents[0], MaxEpollEvents, -1);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            Event event;
+            event.m_error = "Epoll wait failed: " + lastErrorString();
+            events.push_back(std::move(event));
+            postEvents(events);
+            break;
+        }
+
+        ++m_workerStats.m_wakeupsCount;
+        for (auto idx = 0; idx < count; ++idx) {
+            auto tag = readyEvents[idx].data.u64;
+            auto flags = readyEvents[idx].events;
+            if (tag == ListenTag) {
+                acceptConnections(events);
+                continue;
+            }
+
+            if (tag == WakeTag) {
+                std::uint64_t value = 0U;
+                auto result = ::read(m_wakeFd, &value, sizeof(value));
+                static_cast<void>(result);
+                sendOutgoing(events);
+                continue;
+            }
+
+            auto streamId = static_cast<DataInfo::StreamId>(tag);
+            auto iter = m_connections.find(streamId);
+            if (iter == m_connections.end()) {
+                continue;
+            }
+
+            auto& conn = iter->second;
+            bool alive = true;
+            if (conn.m_recvPaused) {
+                alive = ((flags & (EPOLLHUP | EPOLLERR)) == 0);
+            }
+            else if ((flags & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) != 0) {
+                alive = readConnection(conn, events);
+            }
+
+            if (alive && ((flags & EPOLLOUT) != 0)) {
+                alive = flushConnection(conn);
+            }
+
+            if (!alive) {
+                closeConnection(streamId, events);
+            }
+        }
+
+        resumePaused(events);
+        postEvents(events);
+    }
+}
+
+void EpollServer::acceptConnections(EventsList& events)
+{
+    while (true) {
+        struct sockaddr_storage addr;
+        socklen_t addrLen = sizeof(addr);
+        int fd =
+            ::accept4(
+                m_listenFd,
+                reinterpret_cast<struct sockaddr*>(&addr),
+                &addrLen,
+                SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+        if (fd < 0) {
+            if ((errno == EINTR) || (errno == ECONNABORTED)) {
+                continue;
+            }
+
+            if ((errno == EMFILE) || (errno == ENFILE)) {
+                // Edge triggered listening socket won't report the pending
+                // connections again, reject them instead of leaving hanging
+                Event event;
+                event.m_error =
+                    "Failed to accept TCP connection: " + lastErrorString() +
+                    " (limit " + QString::number(static_cast<qulonglong>(m_workerStats.m_filesLimit)) +
+                    "), rejecting pending connections.";
+                events.push_back(std::move(event));
+                while (rejectConnection()) {
+                    ++m_workerStats.m_rejectedCount;
+                }
+                break;
+            }
+
+            if (!wouldBlock(errno)) {
+                Event event;
+                event.m_error = "Failed to accept TCP connection: " + lastErrorString();
+                events.push_back(std::move(event));
+            }
+            break;
+        }
+
+        int enabled = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enabled, sizeof(enabled));
+
+        ++m_lastStreamId;
+        if (m_lastStreamId == DataInfo::DefaultStreamId) {
+            ++m_lastStreamId;
+        }
+
+        if (!addToEpoll(m_epollFd, fd, ConnEpollEvents, m_lastStreamId)) {
+            Event event;
+            event.m_error = "Failed to register TCP connection: " + lastErrorString();
+            events.push_back(std::move(event));
+            ::close(fd);
+            continue;
+        }
+
+        Connection conn;
+        conn.m_fd = fd;
+        conn.m_streamId = m_lastStreamId;
+        conn.m_endpoint = endpointId(addr);
+
+        Event event;
+        event.m_type = EventType::Connected;
+        event.m_streamId = conn.m_streamId;
+        event.m_endpoint = conn.m_endpoint;
+        events.push_back(std::move(event));
+
+        m_connections.insert(std::make_pair(conn.m_streamId, std::move(conn)));
+        ++m_workerStats.m_acceptedCount;
+        m_workerStats.m_connectionsCount = m_connections.size();
+        m_workerStats.m_peakConnectionsCount =
+            std::max(m_workerStats.m_peakConnectionsCount, m_workerStats.m_connectionsCount);
+    }
+}
+
+bool EpollServer::rejectConnection()
+{
+    // Release the reserved descriptor to be able to accept and close
+    if (m_spareFd < 0) {
+        return false;
+    }
+
+    ::close(m_spareFd);
+    int fd = ::accept4(m_listenFd, nullptr, nullptr, SOCK_CLOEXEC);
+    if (0 <= fd) {
+        ::close(fd);
+    }
+    m_spareFd = ::open("/dev/null", O_RDONLY | O_CLOEXEC);
+    return 0 <= fd;
+}
+
+bool EpollServer::readConnection(Connection& conn, EventsList& events)
+{
+    assert(m_readBuf.size() == ReadBufSize);
+    while (true) {
+        if (!recvAllowed()) {
+            // The rest stays in the kernel buffer, so the peer is throttled by TCP
+            return setRecvPaused(conn, true);
+        }
+
+        auto result = ::read(conn.m_fd, &m_readBuf[0], m_readBuf.size());
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            if (wouldBlock(errno)) {
+                return true;
+            }
+
+            if (errno != ECONNRESET) {
+                Event event;
+                event.m_streamId = conn.m_streamId;
+                event.m_error = "Failed to read TCP connection: " + lastErrorString();
+                events.push_back(std::move(event));
+            }
+            return false;
+        }
+
+        if (result == 0) {
+            return false;
+        }
+
+        auto size = static_cast<std::size_t>(result);
+        auto dataPtr = makeDataInfo();
+        dataPtr->m_timestamp = DataInfo::TimestampClock::now();
+        dataPtr->m_streamId = conn.m_streamId;
+        dataPtr->m_fromEndpoint = conn.m_endpoint;
+        dataPtr->m_toEndpoint = m_localEndpoint;
+        dataPtr->m_data.assign(m_readBuf.begin(), m_readBuf.begin() + size);
+
+        Event event;
+        event.m_type = EventType::DataReceived;
+        event.m_streamId = conn.m_streamId;
+        event.m_data = std::move(dataPtr);
+        events.push_back(std::move(event));
+
+        m_localEventBytes += size;
+        m_workerStats.m_receivedBytesCount += size;
+        ++m_workerStats.m_receivedChunksCount;
+    }
+}
+
+bool EpollServer::flushConnection(Connection& conn)
+{
+    while (!conn.m_pendingWrites.empty()) {
+        struct iovec iovs[MaxWriteIovs];
+        std::size_t count = 0U;
+        auto offset = conn.m_pendingOffset;
+        for (auto& dataPtr : conn.m_pendingWrites) {
+            if (MaxWriteIovs <= count) {
+                break;
+            }
+
+            auto& data = dataPtr->m_data;
+            assert(offset < data.size());
+            iovs[count].iov_base = &data[offset];
+            iovs[count].iov_len = data.size() - offset;
+            offset = 0U;
+            ++count;
+        }
+
+        struct msghdr msg;
+        std::memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iovs[0];
+        msg.msg_iovlen = count;
+
+        auto result = ::sendmsg(conn.m_fd, &msg, MSG_NOSIGNAL);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            return wouldBlock(errno);
+        }
+
+        auto written = static_cast<std::size_t>(result);
+        m_workerStats.m_sentBytesCount += written;
+        assert(written <= conn.m_pendingBytes);
+        if (conn.m_pendingBytes == m_workerStats.m_maxPendingWriteBytes) {
+            m_maxPendingWritesDirty = true;
+        }
+
+        conn.m_pendingBytes -= written;
+        while (0U < written) {
+            assert(!conn.m_pendingWrites.empty());
+            auto remaining = conn.m_pendingWrites.front()->m_data.size() - conn.m_pendingOffset;
+            if (written < remaining) {
+                conn.m_pendingOffset += written;
+                break;
+            }
+
+            written -= remaining;
+            conn.m_pendingWrites.pop_front();
+            conn.m_pendingOffset = 0U;
+        }
+    }
+
+    return true;
+}
+
+bool EpollServer::recvAllowed() const
+{
+    return (m_queuedEventBytes + m_localEventBytes) < MaxPendingEventBytes;
+}
+
+bool EpollServer::setRecvPaused(Connection& conn, bool paused)
+{
+    if (conn.m_recvPaused == paused) {
+        return true;
+    }
+
+    struct epoll_event ev;
+    std::memset(&ev, 0, sizeof(ev));
+    ev.events = ConnEpollEvents;
+    if (paused) {
+        ev.events = PausedConnEpollEvents;
+    }
+    ev.data.u64 = conn.m_streamId;
+
+    // Re-enabling EPOLLIN reports data already waiting in the socket
+    if (::epoll_ctl(m_epollFd, EPOLL_CTL_MOD, conn.m_fd, &ev) != 0) {
+        return false;
+    }
+
+    conn.m_recvPaused = paused;
+    if (paused) {
+        m_pausedStreams.push_back(conn.m_streamId);
+        ++m_workerStats.m_recvPausesCount;
+    }
+    return true;
+}
+
+void EpollServer::resumePaused(EventsList& events)
+{
+    if (m_pausedStreams.empty() || (!recvAllowed())) {
+        return;
+    }
+
+    m_closedStreams.clear();
+    auto iter =
+        std::remove_if(
+            m_pausedStreams.begin(), m_pausedStreams.end(),
+            [this](DataInfo::StreamId streamId) -> bool
+            {
+                auto connIter = m_connections.find(streamId);
+                if (connIter == m_connections.end()) {
+                    return true;
+                }
+
+                auto& conn = connIter->second;
+                if (PausePendingWriteBytes <= conn.m_pendingBytes) {
+                    return false;
+                }
+
+                if (!setRecvPaused(conn, false)) {
+                    m_closedStreams.push_back(streamId);
+                }
+                return true;
+            });
+
+    m_pausedStreams.erase(iter, m_pausedStreams.end());
+    for (auto streamId : m_closedStreams) {
+        closeConnection(streamId, events);
+    }
+}
+
+void EpollServer::closeConnection(DataInfo::StreamId streamId, EventsList& events)
+{
+    auto iter = m_connections.find(streamId);
+    if (iter == m_connections.end()) {
+        assert(!"Closing unknown connection");
+        return;
+    }
+
+    if (iter->second.m_pendingBytes == m_workerStats.m_maxPendingWriteBytes) {
+        m_maxPendingWritesDirty = true;
+    }
+
+    ::close(iter->second.m_fd);
+    m_connections.erase(iter);
+    m_workerStats.m_connectionsCount = m_connections.size();
+
+    Event event;
+    event.m_type = EventType::Disconnected;
+    event.m_streamId = streamId;
+    events.push_back(std::move(event));
+}
+
+void EpollServer::sendOutgoing(EventsList& events)
+{
+    OutgoingList outgoing;
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        outgoing.swap(m_outgoing);
+        m_outgoingBytes = 0U;
+        m_queuedEventBytes = m_pendingEventBytes;
+    }
+
+    if (outgoing.empty()) {
+        return;
+    }
+
+    std::size_t outgoingBytes = 0U;
+    for (auto& dataPtr : outgoing) {
+        outgoingBytes += dataPtr->m_data.size();
+    }
+
+    m_closedStreams.clear();
+    std::size_t maxPendingBytes = 0U;
+    for (auto& elem : m_connections) {
+        auto& conn = elem.second;
+        std::copy(outgoing.begin(), outgoing.end(), std::back_inserter(conn.m_pendingWrites));
+        conn.m_pendingBytes += outgoingBytes;
+        if (!flushConnection(conn)) {
+            m_closedStreams.push_back(elem.first);
+            continue;
+        }
+
+        if (MaxPendingWriteBytes < conn.m_pendingBytes) {
+            Event event;
+            event.m_streamId = conn.m_streamId;
+            event.m_error = "Closing TCP connection that doesn't read sent data.";
+            events.push_back(std::move(event));
+            ++m_workerStats.m_overflowClosedCount;
+            m_closedStreams.push_back(elem.first);
+            continue;
+        }
+
+        if ((PausePendingWriteBytes <= conn.m_pendingBytes) &&
+            (!setRecvPaused(conn, true))) {
+            m_closedStreams.push_back(elem.first);
+            continue;
+        }
+
+        maxPendingBytes = std::max(maxPendingBytes, conn.m_pendingBytes);
+    }
+
+    m_workerStats.m_maxPendingWriteBytes = maxPendingBytes;
+    m_maxPendingWritesDirty = false;
+
+    for (auto streamId : m_closedStreams) {
+        closeConnection(streamId, events);
+    }
+}
+
+void EpollServer::updateMaxPendingWrites()
+{
+    if (!m_maxPendingWritesDirty) {
+        return;
+    }
+
+    std::size_t maxPendingBytes = 0U;
+    for (auto& elem : m_connections) {
+        maxPendingBytes = std::max(maxPendingBytes, elem.second.m_pendingBytes);
+    }
+
+    m_workerStats.m_maxPendingWriteBytes = maxPendingBytes;
+    m_maxPendingWritesDirty = false;
+}
+
+void EpollServer::postEvents(EventsList& events)
+{
+    updateMaxPendingWrites();
+
+    bool notify = false;
+    {
+        std::lock_guard<std::mutex> guard(m_lock);
+        if (!events.empty()) {
+            m_workerStats.m_maxBatchSize =
+                std::max(m_workerStats.m_maxBatchSize, events.size());
+
+            notify = m_events.empty();
+            m_pendingEventBytes += m_localEventBytes;
+            if (notify) {
+                m_events.swap(events);
+            }
+            else {
+                std::move(events.begin(), events.end(), std::back_inserter(m_events));
+            }
+        }
+        m_queuedEventBytes = m_pendingEventBytes;
+        m_resumeRequired = !m_pausedStreams.empty();
+        m_stats = m_workerStats;
+    }
+
+    m_localEventBytes = 0U;
+    events.clear();
+    if (notify && m_eventsPendingCallback) {
+        m_eventsPendingCallback();
+    }
+}
+
+void EpollServer::wakeup()
+{
+    std::uint64_t value = 1U;
+    auto result = ::write(m_wakeFd, &value, sizeof(value));
+    static_cast<void>(result);
+}
+
+void EpollServer::closeAll()
+{
+    for (auto& elem : m_connections) {
+        ::close(elem.second.m_fd);
+    }
+    m_connections.clear();
+
+    for (auto* fd : {&m_listenFd, &m_wakeFd, &m_epollFd, &m_spareFd}) {
+        if (0 <= *fd) {
+            ::close(*fd);
+            *fd = -1;
+        }
+    }
+}
+
+}  // namespace epoll_server
+
+}  // namespace tcp_socket
+
+}  // namespace plugin
+
+}  // namespace comms_champion
@@ -0,0 +1,202 @@
+//
+// Copyright 2016 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <unordered_map>
+#include <thread>
+#include <mutex>
+#include <atomic>
+
+#include "comms/CompileControl.h"
+
+CC_DISABLE_WARNINGS()
+#include <QtCore/QString>
+CC_ENABLE_WARNINGS()
+
+#include "comms_champion/DataInfo.h"
+
+namespace comms_champion
+{
+
+namespace plugin
+{
+
+namespace tcp_socket
+{
+
+namespace epoll_server
+{
+
+class EpollServer
+{
+public:
+    typedef unsigned short PortType;
+
+    enum class EventType
+    {
+        Connected,
+        DataReceived,
+        Disconnected,
+        Error
+    };
+
+    struct Event
+    {
+        EventType m_type = EventType::Error;
+        DataInfo::StreamId m_streamId = DataInfo::DefaultStreamId;
+        DataInfo::EndpointId m_endpoint = DataInfo::NoEndpoint;
+        DataInfoPtr m_data;
+        QString m_error;
+    };
+
+    typedef std::vector<Event> EventsList;
+
+    struct Stats
+    {
+        std::size_t m_connectionsCount = 0U;
+        std::size_t m_peakConnectionsCount = 0U;
+        unsigned long long m_acceptedCount = 0U;
+        unsigned long long m_receivedBytesCount = 0U;
+        unsigned long long m_receivedChunksCount = 0U;
+        unsigned long long m_sentBytesCount = 0U;
+        unsigned long long m_wakeupsCount = 0U;
+        std::size_t m_maxBatchSize = 0U;
+        unsigned long long m_recvPausesCount = 0U;
+        unsigned long long m_overflowClosedCount = 0U;
+        std::size_t m_maxPendingWriteBytes = 0U;
+        unsigned long long m_rejectedCount = 0U;
+        unsigned long long m_droppedSendsCount = 0U;
+        std::size_t m_filesLimit = 0U;
+    };
+
+    typedef std::function<void ()> EventsPendingCallback;
+
+    EpollServer();
+    ~EpollServer();
+
+    bool start(PortType port, QString& error);
+
+    void stop();
+
+    bool isRunning() const
+    {
+        return m_thread.joinable();
+    }
+
+    DataInfo::EndpointId localEndpoint() const
+    {
+        return m_localEndpoint;
+    }
+
+    PortType localPort() const
+    {
+        return m_localPort;
+    }
+
+    void takeEvents(EventsList& events);
+
+    // Returns false when the data is dropped due to a send backlog that
+    // the worker thread can't keep up with
+    bool send(DataInfoPtr dataPtr);
+
+    Stats getStats() const;
+
+    std::size_t pendingBytes() const;
+
+    template <typename TFunc>
+    void setEventsPendingCallback(TFunc&& func)
+    {
+        m_eventsPendingCallback = std::forward<TFunc>(func);
+    }
+
+private:
+    typedef std::deque<DataInfoPtr> PendingWritesList;
+
+    struct Connection
+    {
+        int m_fd = -1;
+        DataInfo::StreamId m_streamId = DataInfo::DefaultStreamId;
+        DataInfo::EndpointId m_endpoint = DataInfo::NoEndpoint;
+        PendingWritesList m_pendingWrites;
+        std::size_t m_pendingOffset = 0U;
+        std::size_t m_pendingBytes = 0U;
+        bool m_recvPaused = false;
+    };
+
+    typedef std::unordered_map<DataInfo::StreamId, Connection> ConnectionsMap;
+    typedef std::vector<DataInfoPtr> OutgoingList;
+    typedef std::vector<DataInfo::StreamId> StreamIdsList;
+
+    void run();
+    void acceptConnections(EventsList& events);
+    bool rejectConnection();
+    bool readConnection(Connection& conn, EventsList& events);
+    bool flushConnection(Connection& conn);
+    bool recvAllowed() const;
+    bool setRecvPaused(Connection& conn, bool paused);
+    void resumePaused(EventsList& events);
+    void closeConnection(DataInfo::StreamId streamId, EventsList& events);
+    void sendOutgoing(EventsList& events);
+    void updateMaxPendingWrites();
+    void postEvents(EventsList& events);
+    void wakeup();
+    void closeAll();
+
+    int m_epollFd = -1;
+    int m_listenFd = -1;
+    int m_wakeFd = -1;
+    int m_spareFd = -1;
+    std::thread m_thread;
+    std::atomic<bool> m_stopRequested;
+    DataInfo::EndpointId m_localEndpoint = DataInfo::NoEndpoint;
+    PortType m_localPort = 0U;
+    DataInfo::StreamId m_lastStreamId = DataInfo::DefaultStreamId;
+    ConnectionsMap m_connections;
+    StreamIdsList m_closedStreams;
+    StreamIdsList m_pausedStreams;
+    std::size_t m_localEventBytes = 0U;
+    std::size_t m_queuedEventBytes = 0U;
+    DataInfo::DataSeq m_readBuf;
+    Stats m_workerStats;
+    bool m_maxPendingWritesDirty = false;
+
+    mutable std::mutex m_lock;
+    EventsList m_events;
+    std::size_t m_pendingEventBytes = 0U;
+    bool m_resumeRequired = false;
+    OutgoingList m_outgoing;
+    std::size_t m_outgoingBytes = 0U;
+    unsigned long long m_droppedSendsCount = 0U;
+    Stats m_stats;
+
+    EventsPendingCallback m_eventsPendingCallback;
+};
+
+}  // namespace epoll_server
+
+}  // namespace tcp_socket
+
+}  // namespace plugin
+
+}  // namespace comms_champion
@@ -0,0 +1,184 @@
+//
+// Copyright 2016 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "Socket.h"
+
+#include <cassert>
+
+#include "comms_champion/EndpointRegistry.h"
+
+namespace comms_champion
+{
+
+namespace plugin
+{
+
+namespace tcp_socket
+{
+
+namespace epoll_server
+{
+
+namespace
+{
+
+const QString ToPropName("tcp.to");
+
+}  // namespace
+
+Socket::Socket()
+{
+    m_server.setEventsPendingCallback(
+        [this]()
+        {
+            QMetaObject::invokeMethod(this, "processEvents", Qt::QueuedConnection);
+        });
+}
+
+Socket::~Socket()
+{
+    m_server.stop();
+}
+
+bool Socket::socketConnectImpl()
+{
+    QString error;
+    if (!m_server.start(m_port, error)) {
+        reportError(error);
+        return false;
+    }
+
+    return true;
+}
+
+void Socket::socketDisconnectImpl()
+{
+    m_server.stop();
+
+    auto streams = std::move(m_streams);
+    m_streams.clear();
+    m_toListValid = false;
+    for (auto& elem : streams) {
+        reportStreamClosed(elem.first);
+    }
+}
+
+void Socket::sendDataImpl(DataInfoPtr dataPtr)
+{
+    assert(dataPtr);
+
+    // Rebuilt only when the connections change, the copies are shared
+    if (!m_toListValid) {
+        m_toList.clear();
+        for (auto& elem : m_streams) {
+            m_toList.append(elem.second);
+        }
+        m_toListValid = true;
+    }
+
+    dataPtr->m_fromEndpoint = m_server.localEndpoint();
+    dataPtr->m_extraProperties.insert(ToPropName, m_toList);
+    if (!m_server.send(std::move(dataPtr))) {
+        static const QString DroppedError(
+            tr("Send backlog of TCP/IP epoll server is full, data is dropped."));
+        reportError(DroppedError);
+    }
+}
+
+unsigned Socket::connectionPropertiesImpl() const
+{
+    return ConnectionProperty_Autoconnect;
+}
+
+std::size_t Socket::pendingBytesImpl() const
+{
+    return m_server.pendingBytes();
+}
+
+Socket::StatsList Socket::statsImpl() const
+{
+    auto stats = m_server.getStats();
+    StatsList result;
+    result.emplace_back("connections", static_cast<qulonglong>(stats.m_connectionsCount));
+    result.emplace_back("peak_connections", static_cast<qulonglong>(stats.m_peakConnectionsCount));
+    result.emplace_back("accepted", stats.m_acceptedCount);
+    result.emplace_back("rejected", stats.m_rejectedCount);
+    result.emplace_back("files_limit", static_cast<qulonglong>(stats.m_filesLimit));
+    result.emplace_back("rx_bytes", stats.m_receivedBytesCount);
+    result.emplace_back("rx_chunks", stats.m_receivedChunksCount);
+    result.emplace_back("tx_bytes", stats.m_sentBytesCount);
+    result.emplace_back("tx_dropped", stats.m_droppedSendsCount);
+    result.emplace_back("wakeups", stats.m_wakeupsCount);
+    result.emplace_back("max_batch", static_cast<qulonglong>(stats.m_maxBatchSize));
+    result.emplace_back("recv_pauses", stats.m_recvPausesCount);
+    result.emplace_back("overflow_closed", stats.m_overflowClosedCount);
+    result.emplace_back("max_pending_write_bytes", static_cast<qulonglong>(stats.m_maxPendingWriteBytes));
+    return result;
+}
+
+void Socket::processEvents()
+{
+    // Reuse the cached storage while staying safe against reentrant calls
+    EpollServer::EventsList events;
+    events.swap(m_events);
+    m_server.takeEvents(events);
+    for (auto& event : events) {
+        if (!m_server.isRunning()) {
+            break;
+        }
+
+        switch (event.m_type) {
+        case EpollServer::EventType::Connected:
+            m_toListValid = false;
+            m_streams.insert(
+                std::make_pair(
+                    event.m_streamId,
+                    EndpointRegistry::instanceRef().endpointName(event.m_endpoint)));
+            break;
+
+        case EpollServer::EventType::DataReceived:
+            reportDataReceived(std::move(event.m_data));
+            break;
+
+        case EpollServer::EventType::Disconnected:
+            m_toListValid = false;
+            m_streams.erase(event.m_streamId);
+            reportStreamClosed(event.m_streamId);
+            break;
+
+        case EpollServer::EventType::Error:
+            reportError(event.m_error);
+            break;
+
+        default:
+            assert(!"Unexpected event type");
+            break;
+        }
+    }
+
+    events.clear();
+    m_events.swap(events);
+}
+
+}  // namespace epoll_server
+
+}  // namespace tcp_socket
+
+}  // namespace plugin
+
+}  // namespace comms_champion
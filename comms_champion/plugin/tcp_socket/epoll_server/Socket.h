@@ -0,0 +1,98 @@
+//
+// Copyright 2016 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <unordered_map>
+
+#include "comms/CompileControl.h"
+
+CC_DISABLE_WARNINGS()
+#include <QtCore/QObject>
+#include <QtCore/QString>
+#include <QtCore/QVariantList>
+CC_ENABLE_WARNINGS()
+
+#include "comms_champion/Socket.h"
+#include "EpollServer.h"
+
+
+namespace comms_champion
+{
+
+namespace plugin
+{
+
+namespace tcp_socket
+{
+
+namespace epoll_server
+{
+
+class Socket : public QObject,
+               public comms_champion::Socket
+{
+    Q_OBJECT
+    using Base = comms_champion::Socket;
+
+public:
+    typedef EpollServer::PortType PortType;
+
+    Socket();
+    ~Socket();
+
+    void setPort(PortType value)
+    {
+        m_port = value;
+    }
+
+    PortType getPort() const
+    {
+        return m_port;
+    }
+
+protected:
+    virtual bool socketConnectImpl() override;
+    virtual void socketDisconnectImpl() override;
+    virtual void sendDataImpl(DataInfoPtr dataPtr) override;
+    virtual unsigned connectionPropertiesImpl() const override;
+    virtual std::size_t pendingBytesImpl() const override;
+    virtual StatsList statsImpl() const override;
+
+private slots:
+    void processEvents();
+
+private:
+    typedef std::unordered_map<DataInfo::StreamId, QString> StreamsMap;
+
+    static const PortType DefaultPort = 20000;
+    PortType m_port = DefaultPort;
+    EpollServer m_server;
+    EpollServer::EventsList m_events;
+    StreamsMap m_streams;
+    QVariantList m_toList;
+    bool m_toListValid = false;
+};
+
+}  // namespace epoll_server
+
+}  // namespace tcp_socket
+
+}  // namespace plugin
+
+}  // namespace comms_champion
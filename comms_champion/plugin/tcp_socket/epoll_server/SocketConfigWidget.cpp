@@ -0,0 +1,69 @@
+//
+// Copyright 2016 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "SocketConfigWidget.h"
+
+#include <limits>
+
+namespace comms_champion
+{
+
+namespace plugin
+{
+
+namespace tcp_socket
+{
+
+namespace epoll_server
+{
+
+SocketConfigWidget::SocketConfigWidget(
+    Socket& socket,
+    QWidget* parentObj)
+  : Base(parentObj),
+    m_socket(socket)
+{
+    m_ui.setupUi(this);
+
+    m_ui.m_portSpinBox->setRange(
+        1,
+        static_cast<int>(std::numeric_limits<PortType>::max()));
+
+    m_ui.m_portSpinBox->setValue(
+        static_cast<int>(m_socket.getPort()));
+
+    connect(
+        m_ui.m_portSpinBox, SIGNAL(valueChanged(int)),
+        this, SLOT(portValueChanged(int)));
+}
+
+SocketConfigWidget::~SocketConfigWidget() = default;
+
+void SocketConfigWidget::portValueChanged(int value)
+{
+    m_socket.setPort(static_cast<PortType>(value));
+}
+
+}  // namespace epoll_server
+
+}  // namespace tcp_socket
+
+}  // namespace plugin
+
+}  // namespace comms_champion
+
+
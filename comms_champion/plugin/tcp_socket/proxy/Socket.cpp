@@ -16,6 +16,8 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <cassert>
+#include <algorithm>
+#include <vector>
 
 #include "comms/CompileControl.h"
 
@@ -23,6 +25,7 @@ CC_DISABLE_WARNINGS()
 #include <QtNetwork/QHostAddress>
 CC_ENABLE_WARNINGS()
 
+#include "comms_champion/EndpointRegistry.h"
 #include "Socket.h"
 
 namespace comms_champion
@@ -40,9 +43,39 @@ namespace proxy
 namespace
 {
 
-const QString FromPropName("tcp.from");
 const QString ToPropName("tcp.to");
 
+EndpointRegistry::TransportId transportId()
+{
+    static const auto Id = EndpointRegistry::instanceRef().registerTransport("tcp");
+    return Id;
+}
+
+DataInfo::EndpointId endpointId(const QHostAddress& address, quint16 port)
+{
+    return EndpointRegistry::instanceRef().internHost(transportId(), address, port);
+}
+
+QString endpointName(const QHostAddress& address, quint16 port)
+{
+    return EndpointRegistry::instanceRef().endpointName(endpointId(address, port));
+}
+
+void reportLatency(
+    Socket::StatsList& list,
+    const QString& prefix,
+    const LatencyRecorder& recorder)
+{
+    auto toUs =
+        [](LatencyRecorder::Duration value) -> double
+        {
+            return std::chrono::duration_cast<std::chrono::duration<double, std::micro> >(value).count();
+        };
+    list.emplace_back(prefix + "_p50_us", toUs(recorder.percentile(50.0)));
+    list.emplace_back(prefix + "_p99_us", toUs(recorder.percentile(99.0)));
+    list.emplace_back(prefix + "_max_us", toUs(recorder.max()));
+}
+
 }  // namespace
 
 Socket::Socket()
@@ -54,12 +87,19 @@ Socket::Socket()
     QObject::connect(
         &m_server, SIGNAL(acceptError(QAbstractSocket::SocketError)),
         this, SLOT(socketErrorOccurred(QAbstractSocket::SocketError)));
+
+    m_decodeTimer.setSingleShot(true);
+    QObject::connect(
+        &m_decodeTimer, SIGNAL(timeout()),
+        this, SLOT(decodePending()));
 }
 
 Socket::~Socket()
 {
-    while (!m_sockets.empty()) {
-        removeConnection(m_sockets.begin());
+    while (!m_clients.empty()) {
+        auto& info = m_clients.begin()->second;
+        assert(info);
+        removeConnection(*info);
     }
 }
 
@@ -103,35 +143,32 @@ bool Socket::socketConnectImpl()
 void Socket::socketDisconnectImpl()
 {
     m_server.close();
+    decodePending();
 }
 
 void Socket::sendDataImpl(DataInfoPtr dataPtr)
 {
     assert(dataPtr);
     QVariantList toList;
-    for (auto& connectedPair : m_sockets) {
-        assert(connectedPair.first != nullptr);
-        assert(connectedPair.second);
-        connectedPair.first->write(
+    for (auto& elem : m_clients) {
+        assert(elem.second);
+        auto& connInfo = *elem.second;
+        assert(connInfo.m_client != nullptr);
+        assert(connInfo.m_connection);
+        connInfo.m_client->write(
             reinterpret_cast<const char*>(&dataPtr->m_data[0]),
             dataPtr->m_data.size());
-        connectedPair.second->write(
+        connInfo.m_connection->write(
             reinterpret_cast<const char*>(&dataPtr->m_data[0]),
             dataPtr->m_data.size());
 
         toList.append(
-            connectedPair.first->peerAddress().toString() + ':' +
-                        QString("%1").arg(connectedPair.first->peerPort()));
+            endpointName(connInfo.m_client->peerAddress(), connInfo.m_client->peerPort()));
 
         toList.append(
-            connectedPair.second->peerAddress().toString() + ':' +
-                        QString("%1").arg(connectedPair.second->peerPort()));
+            endpointName(connInfo.m_connection->peerAddress(), connInfo.m_connection->peerPort()));
     }
-    QString from =
-        m_server.serverAddress().toString() + ':' +
-                    QString("%1").arg(m_server.serverPort());
-
-    dataPtr->m_extraProperties.insert(FromPropName, from);
+    dataPtr->m_fromEndpoint = endpointId(m_server.serverAddress(), m_server.serverPort());
     dataPtr->m_extraProperties.insert(ToPropName, toList);
 }
 
@@ -140,6 +177,54 @@ unsigned Socket::connectionPropertiesImpl() const
     return ConnectionProperty_Autoconnect;
 }
 
+std::size_t Socket::pendingBytesImpl() const
+{
+    std::size_t result = 0U;
+    for (auto& elem : m_clients) {
+        assert(elem.second);
+        auto& connInfo = *elem.second;
+        assert(connInfo.m_client != nullptr);
+        assert(connInfo.m_connection);
+        auto bytes =
+            std::max(
+                connInfo.m_client->bytesToWrite(),
+                connInfo.m_connection->bytesToWrite());
+        result = std::max(result, static_cast<std::size_t>(bytes));
+    }
+    return result;
+}
+
+Socket::StatsList Socket::statsImpl() const
+{
+    auto fromClient = m_closedFromClient;
+    auto fromConnection = m_closedFromConnection;
+    for (auto& elem : m_clients) {
+        assert(elem.second);
+        auto& info = *elem.second;
+        fromClient.m_bytesCount += info.m_fromClient.m_bytesCount;
+        fromClient.m_framesCount += info.m_fromClient.m_framesCount;
+        fromConnection.m_bytesCount += info.m_fromConnection.m_bytesCount;
+        fromConnection.m_framesCount += info.m_fromConnection.m_framesCount;
+    }
+
+    StatsList result;
+    result.emplace_back("connections", static_cast<qulonglong>(m_clients.size()));
+    result.emplace_back("from_client_bytes", fromClient.m_bytesCount);
+    result.emplace_back("from_client_reads", fromClient.m_framesCount);
+    result.emplace_back("from_remote_bytes", fromConnection.m_bytesCount);
+    result.emplace_back("from_remote_reads", fromConnection.m_framesCount);
+
+    // Read until written to the other side
+    reportLatency(result, "forwarding_latency", m_forwardingLatency);
+    if (m_asyncDecode) {
+        // Forwarded until decoded, and the time the event loop was busy
+        // decoding a deferred batch, delaying the forwarding of new data
+        reportLatency(result, "decode_wait", m_decodeWaitLatency);
+        reportLatency(result, "decode_batch", m_decodeBatchLatency);
+    }
+    return result;
+}
+
 void Socket::newConnection()
 {
     auto *newConnSocket = m_server.nextPendingConnection();
@@ -169,7 +254,13 @@ void Socket::newConnection()
     }
 
     connectionSocket->connectToHost(m_remoteHost, m_remotePort);
-    m_sockets.emplace_back(newConnSocket, std::move(connectionSocket));
+    ConnectionInfoPtr info(new ConnectionInfo);
+    info->m_client = newConnSocket;
+    info->m_connection = std::move(connectionSocket);
+    info->m_clientStreamId = allocStreamId();
+    info->m_connectionStreamId = allocStreamId();
+    m_connections.insert(std::make_pair(info->m_connection.get(), info.get()));
+    m_clients.insert(std::make_pair(newConnSocket, std::move(info)));
 }
 
 void Socket::clientConnectionTerminated()
@@ -180,16 +271,17 @@ void Socket::clientConnectionTerminated()
         return;
     }
 
-    auto iter = findByClient(socket);
-    if (iter == m_sockets.end()) {
+    auto* info = findByClient(socket);
+    if (info == nullptr) {
         return;
     }
 
-    assert(iter->second);
+    assert(info->m_connection);
     socket->blockSignals(true);
-    iter->second->blockSignals(true);
-    iter->second->flush();
-    m_sockets.erase(iter);
+    info->m_connection->blockSignals(true);
+    info->m_connection->flush();
+    reportConnectionClosed(*info);
+    eraseConnection(socket, info->m_connection.get());
     socket->deleteLater();
 }
 
@@ -198,12 +290,12 @@ void Socket::readFromClientSocket()
     auto* socket = qobject_cast<QTcpSocket*>(sender());
     assert(socket != nullptr);
 
-    auto iter = findByClient(socket);
-    assert (iter != m_sockets.end());
-    assert(iter->second);
-    auto& connectionSocket = *(iter->second);
+    auto* info = findByClient(socket);
+    assert(info != nullptr);
+    assert(info->m_connection);
+    auto& connectionSocket = *(info->m_connection);
 
-    performReadWrite(*socket, connectionSocket);
+    performReadWrite(*socket, connectionSocket, info->m_clientStreamId, info->m_fromClient);
 }
 
 void Socket::socketErrorOccurred(QAbstractSocket::SocketError err)
@@ -237,17 +329,17 @@ void Socket::connectionSocketConnected()
         return;
     }
 
-    auto iter = findByConnection(socket);
-    assert(iter != m_sockets.end());
-    assert(iter->first != nullptr);
+    auto* info = findByConnection(socket);
+    assert(info != nullptr);
+    assert(info->m_client != nullptr);
 
     connect(
-        iter->first, SIGNAL(readyRead()),
+        info->m_client, SIGNAL(readyRead()),
         this, SLOT(readFromClientSocket()));
 
-    if (0 < iter->first->bytesAvailable()) {
-        assert(iter->second);
-        performReadWrite(*iter->first, *iter->second);
+    if (0 < info->m_client->bytesAvailable()) {
+        assert(info->m_connection);
+        performReadWrite(*info->m_client, *info->m_connection, info->m_clientStreamId, info->m_fromClient);
     }
 }
 
@@ -259,20 +351,22 @@ void Socket::connectionSocketDisconnected()
         return;
     }
 
-    auto iter = findByConnection(socket);
-    if (iter == m_sockets.end()) {
+    auto* info = findByConnection(socket);
+    if (info == nullptr) {
         return;
     }
 
-    assert(iter->first);
-    iter->first->blockSignals(true);
-    iter->first->flush();
-    delete iter->first;
+    auto* clientSocket = info->m_client;
+    assert(clientSocket != nullptr);
+    clientSocket->blockSignals(true);
+    clientSocket->flush();
+    delete clientSocket;
 
-    assert(iter->second);
-    iter->second->flush();
-    iter->second.release()->deleteLater();
-    m_sockets.erase(iter);
+    assert(info->m_connection);
+    info->m_connection->flush();
+    info->m_connection.release()->deleteLater();
+    reportConnectionClosed(*info);
+    eraseConnection(clientSocket, socket);
 }
 
 void Socket::readFromConnectionSocket()
@@ -280,45 +374,77 @@ void Socket::readFromConnectionSocket()
     auto* socket = qobject_cast<QTcpSocket*>(sender());
     assert(socket != nullptr);
 
-    auto iter = findByConnection(socket);
-    assert (iter != m_sockets.end());
-    assert(iter->first != nullptr);
-    auto& clientSocket = *(iter->first);
-    performReadWrite(*socket, clientSocket);
+    auto* info = findByConnection(socket);
+    assert(info != nullptr);
+    assert(info->m_client != nullptr);
+    auto& clientSocket = *(info->m_client);
+    performReadWrite(*socket, clientSocket, info->m_connectionStreamId, info->m_fromConnection);
 }
 
-Socket::SocketsList::iterator Socket::findByClient(QTcpSocket* socket)
+void Socket::decodePending()
 {
-    return std::find_if(
-        m_sockets.begin(), m_sockets.end(),
-        [socket](const ConnectedPair& elem) -> bool
-        {
-            return elem.first == socket;
-        });
+    m_decodeTimer.stop();
+    if (m_pendingDecode.empty()) {
+        return;
+    }
+
+    auto batchStart = DataInfo::TimestampClock::now();
+    std::vector<DataInfoPtr> pending;
+    pending.swap(m_pendingDecode);
+    for (auto& dataPtr : pending) {
+        assert(dataPtr);
+        m_decodeWaitLatency.record(
+            std::chrono::duration_cast<LatencyRecorder::Duration>(
+                DataInfo::TimestampClock::now() - dataPtr->m_timestamp));
+        reportDataReceived(std::move(dataPtr));
+    }
+
+    m_decodeBatchLatency.record(
+        std::chrono::duration_cast<LatencyRecorder::Duration>(
+            DataInfo::TimestampClock::now() - batchStart));
+
+    if (m_pendingDecode.empty()) {
+        pending.clear();
+        pending.swap(m_pendingDecode);
+    }
 }
 
-Socket::SocketsList::iterator Socket::findByConnection(QTcpSocket* socket)
+Socket::ConnectionInfo* Socket::findByClient(QTcpSocket* socket)
 {
-    return std::find_if(
-        m_sockets.begin(), m_sockets.end(),
-        [socket](const ConnectedPair& elem) -> bool
-        {
-            return elem.second.get() == socket;
-        });
+    auto iter = m_clients.find(socket);
+    if (iter == m_clients.end()) {
+        return nullptr;
+    }
+
+    return iter->second.get();
+}
+
+Socket::ConnectionInfo* Socket::findByConnection(QTcpSocket* socket)
+{
+    auto iter = m_connections.find(socket);
+    if (iter == m_connections.end()) {
+        return nullptr;
+    }
 
+    return iter->second;
 }
 
-void Socket::removeConnection(SocketsList::iterator iter)
+void Socket::eraseConnection(QTcpSocket* clientSocket, QTcpSocket* connectionSocket)
 {
-    assert(iter != m_sockets.end());
-    auto* clientSocket = iter->first;
+    m_connections.erase(connectionSocket);
+    m_clients.erase(clientSocket);
+}
+
+void Socket::removeConnection(ConnectionInfo& info)
+{
+    auto* clientSocket = info.m_client;
     assert(clientSocket);
 
-    ConnectionSocketPtr connectionSocket(std::move(iter->second));
+    ConnectionSocketPtr connectionSocket(std::move(info.m_connection));
     assert(connectionSocket);
-    assert(!iter->second);
+    assert(!info.m_connection);
 
-    m_sockets.erase(iter);
+    eraseConnection(clientSocket, connectionSocket.get());
 
     clientSocket->blockSignals(true);
     connectionSocket->blockSignals(true);
@@ -335,14 +461,40 @@ void Socket::removeConnection(SocketsList::iterator iter)
     }
 }
 
-void Socket::performReadWrite(QTcpSocket& readFromSocket, QTcpSocket& writeToSocket)
+void Socket::reportConnectionClosed(const ConnectionInfo& info)
+{
+    m_closedFromClient.m_bytesCount += info.m_fromClient.m_bytesCount;
+    m_closedFromClient.m_framesCount += info.m_fromClient.m_framesCount;
+    m_closedFromConnection.m_bytesCount += info.m_fromConnection.m_bytesCount;
+    m_closedFromConnection.m_framesCount += info.m_fromConnection.m_framesCount;
+    decodePending();
+    reportStreamClosed(info.m_clientStreamId);
+    reportStreamClosed(info.m_connectionStreamId);
+}
+
+DataInfo::StreamId Socket::allocStreamId()
+{
+    ++m_lastStreamId;
+    if (m_lastStreamId == DataInfo::DefaultStreamId) {
+        ++m_lastStreamId;
+    }
+    return m_lastStreamId;
+}
+
+void Socket::performReadWrite(
+    QTcpSocket& readFromSocket,
+    QTcpSocket& writeToSocket,
+    DataInfo::StreamId streamId,
+    TrafficCounters& counters)
 {
     if (readFromSocket.bytesAvailable() == 0) {
         return;
     }
 
+    auto readStart = DataInfo::TimestampClock::now();
     auto dataPtr = makeDataInfo();
-    dataPtr->m_timestamp = DataInfo::TimestampClock::now();
+    dataPtr->m_timestamp = readStart;
+    dataPtr->m_streamId = streamId;
 
     auto dataSize = readFromSocket.bytesAvailable();
     dataPtr->m_data.resize(dataSize);
@@ -352,22 +504,33 @@ void Socket::performReadWrite(QTcpSocket& readFromSocket, QTcpSocket& writeToSoc
         dataPtr->m_data.resize(result);
     }
 
+    counters.m_bytesCount += dataPtr->m_data.size();
+    ++counters.m_framesCount;
+
     writeToSocket.write(
         reinterpret_cast<const char*>(&dataPtr->m_data[0]),
         dataPtr->m_data.size());
 
-    QString from =
-        readFromSocket.peerAddress().toString() + ':' +
-                    QString("%1").arg(readFromSocket.peerPort());
-    QString to =
-        writeToSocket.peerAddress().toString() + ':' +
-                    QString("%1").arg(writeToSocket.peerPort());
+    dataPtr->m_fromEndpoint = endpointId(readFromSocket.peerAddress(), readFromSocket.peerPort());
+    dataPtr->m_toEndpoint = endpointId(writeToSocket.peerAddress(), writeToSocket.peerPort());
 
+    if (!m_asyncDecode) {
+        reportDataReceived(std::move(dataPtr));
+        m_forwardingLatency.record(
+            std::chrono::duration_cast<LatencyRecorder::Duration>(
+                DataInfo::TimestampClock::now() - readStart));
+        return;
+    }
 
-    dataPtr->m_extraProperties.insert(FromPropName, from);
-    dataPtr->m_extraProperties.insert(ToPropName, to);
+    writeToSocket.flush();
+    m_forwardingLatency.record(
+        std::chrono::duration_cast<LatencyRecorder::Duration>(
+            DataInfo::TimestampClock::now() - readStart));
 
-    reportDataReceived(std::move(dataPtr));
+    m_pendingDecode.push_back(std::move(dataPtr));
+    if (!m_decodeTimer.isActive()) {
+        m_decodeTimer.start(0);
+    }
 }
 
 }  // namespace proxy
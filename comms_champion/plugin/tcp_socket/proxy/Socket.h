@@ -17,16 +17,19 @@
 
 #pragma once
 
-#include <list>
+#include <memory>
+#include <unordered_map>
 
 #include "comms/CompileControl.h"
 
 CC_DISABLE_WARNINGS()
 #include <QtNetwork/QTcpServer>
 #include <QtNetwork/QTcpSocket>
+#include <QtCore/QTimer>
 CC_ENABLE_WARNINGS()
 
 #include "comms_champion/Socket.h"
+#include "comms_champion/LatencyRecorder.h"
 
 
 namespace comms_champion
@@ -83,11 +86,26 @@ public:
         return m_remotePort;
     }
 
+    // Forward received data first and decode it later in the same event
+    // loop. Decoding is not thread safe, so forwarding of data that arrives
+    // while a deferred batch is being decoded is still delayed by it.
+    void setAsyncDecode(bool value)
+    {
+        m_asyncDecode = value;
+    }
+
+    bool getAsyncDecode() const
+    {
+        return m_asyncDecode;
+    }
+
 protected:
     virtual bool socketConnectImpl() override;
     virtual void socketDisconnectImpl() override;
     virtual void sendDataImpl(DataInfoPtr dataPtr) override;
     virtual unsigned connectionPropertiesImpl() const override;
+    virtual std::size_t pendingBytesImpl() const override;
+    virtual StatsList statsImpl() const override;
 
 private slots:
     void newConnection();
@@ -98,17 +116,43 @@ private slots:
     void connectionSocketConnected();
     void connectionSocketDisconnected();
     void readFromConnectionSocket();
+    void decodePending();
 
 private:
+    struct TrafficCounters
+    {
+        unsigned long long m_bytesCount = 0U;
+        unsigned long long m_framesCount = 0U;
+    };
+
     typedef QTcpSocket* ClientSocketPtr;
     typedef std::unique_ptr<QTcpSocket> ConnectionSocketPtr;
-    typedef std::pair<ClientSocketPtr, ConnectionSocketPtr> ConnectedPair;
-    typedef std::list<ConnectedPair> SocketsList;
 
-    SocketsList::iterator findByClient(QTcpSocket* socket);
-    SocketsList::iterator findByConnection(QTcpSocket* socket);
-    void removeConnection(SocketsList::iterator iter);
-    void performReadWrite(QTcpSocket& readFromSocket, QTcpSocket& writeToSocket);
+    struct ConnectionInfo
+    {
+        ClientSocketPtr m_client = nullptr;
+        ConnectionSocketPtr m_connection;
+        DataInfo::StreamId m_clientStreamId = DataInfo::DefaultStreamId;
+        DataInfo::StreamId m_connectionStreamId = DataInfo::DefaultStreamId;
+        TrafficCounters m_fromClient;
+        TrafficCounters m_fromConnection;
+    };
+
+    typedef std::unique_ptr<ConnectionInfo> ConnectionInfoPtr;
+    typedef std::unordered_map<QTcpSocket*, ConnectionInfoPtr> ClientsMap;
+    typedef std::unordered_map<QTcpSocket*, ConnectionInfo*> ConnectionsMap;
+
+    ConnectionInfo* findByClient(QTcpSocket* socket);
+    ConnectionInfo* findByConnection(QTcpSocket* socket);
+    void eraseConnection(QTcpSocket* clientSocket, QTcpSocket* connectionSocket);
+    void removeConnection(ConnectionInfo& info);
+    void reportConnectionClosed(const ConnectionInfo& info);
+    DataInfo::StreamId allocStreamId();
+    void performReadWrite(
+        QTcpSocket& readFromSocket,
+        QTcpSocket& writeToSocket,
+        DataInfo::StreamId streamId,
+        TrafficCounters& counters);
 
     static const PortType DefaultPort = 20000;
     PortType m_port = DefaultPort;
@@ -116,7 +160,17 @@ private:
     PortType m_remotePort = DefaultPort;
 
     QTcpServer m_server;
-    SocketsList m_sockets;
+    ClientsMap m_clients;
+    ConnectionsMap m_connections;
+    DataInfo::StreamId m_lastStreamId = DataInfo::DefaultStreamId;
+    bool m_asyncDecode = true;
+    std::vector<DataInfoPtr> m_pendingDecode;
+    QTimer m_decodeTimer;
+    TrafficCounters m_closedFromClient;
+    TrafficCounters m_closedFromConnection;
+    LatencyRecorder m_forwardingLatency;
+    LatencyRecorder m_decodeWaitLatency;
+    LatencyRecorder m_decodeBatchLatency;
 };
 
 }  // namespace proxy
@@ -55,6 +55,8 @@ SocketConfigWidget::SocketConfigWidget(
     m_ui.m_remotePortSpinBox->setValue(
         static_cast<int>(m_socket.getRemotePort()));
 
+    m_ui.m_asyncDecodeCheckBox->setChecked(m_socket.getAsyncDecode());
+
     connect(
         m_ui.m_localPortSpinBox, SIGNAL(valueChanged(int)),
         this, SLOT(localPortValueChanged(int)));
@@ -66,6 +68,10 @@ SocketConfigWidget::SocketConfigWidget(
     connect(
         m_ui.m_remotePortSpinBox, SIGNAL(valueChanged(int)),
         this, SLOT(remotePortValueChanged(int)));
+
+    connect(
+        m_ui.m_asyncDecodeCheckBox, SIGNAL(toggled(bool)),
+        this, SLOT(asyncDecodeToggled(bool)));
 }
 
 SocketConfigWidget::~SocketConfigWidget() = default;
@@ -85,6 +91,11 @@ void SocketConfigWidget::remotePortValueChanged(int value)
     m_socket.setRemotePort(static_cast<PortType>(value));
 }
 
+void SocketConfigWidget::asyncDecodeToggled(bool checked)
+{
+    m_socket.setAsyncDecode(checked);
+}
+
 }  // namespace proxy
 
 }  // namespace tcp_socket
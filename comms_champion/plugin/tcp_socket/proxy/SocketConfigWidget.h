@@ -56,6 +56,7 @@ private slots:
     void localPortValueChanged(int value);
     void remoteHostValueChanged(const QString& value);
     void remotePortValueChanged(int value);
+    void asyncDecodeToggled(bool checked);
 
 private:
     Socket& m_socket;
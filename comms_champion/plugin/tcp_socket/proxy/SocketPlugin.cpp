@@ -42,6 +42,7 @@ const QString MainConfigKey("cc_tcp_proxy_socket");
 const QString LocalPortSubKey("local_port");
 const QString RemoteHostSubKey("remote_host");
 const QString RemotePortSubKey("remote_port");
+const QString AsyncDecodeSubKey("async_decode");
 
 }  // namespace
 
@@ -72,6 +73,7 @@ void SocketPlugin::getCurrentConfigImpl(QVariantMap& config)
     subConfig.insert(LocalPortSubKey, QVariant::fromValue(m_socket->getPort()));
     subConfig.insert(RemoteHostSubKey, QVariant::fromValue(m_socket->getRemoteHost()));
     subConfig.insert(RemotePortSubKey, QVariant::fromValue(m_socket->getRemotePort()));
+    subConfig.insert(AsyncDecodeSubKey, QVariant::fromValue(m_socket->getAsyncDecode()));
     config.insert(MainConfigKey, QVariant::fromValue(subConfig));
 }
 
@@ -108,6 +110,11 @@ void SocketPlugin::reconfigureImpl(const QVariantMap& config)
     m_socket->setPort(localPort);
     m_socket->setRemoteHost(remoteHost);
     m_socket->setRemotePort(remotePort);
+
+    auto asyncDecodeVar = subConfig.value(AsyncDecodeSubKey);
+    if (asyncDecodeVar.isValid() && asyncDecodeVar.canConvert<bool>()) {
+        m_socket->setAsyncDecode(asyncDecodeVar.value<bool>());
+    }
 }
 
 void SocketPlugin::createSocketIfNeeded()
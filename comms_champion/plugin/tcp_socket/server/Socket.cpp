@@ -16,6 +16,7 @@
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #include <cassert>
+#include <algorithm>
 
 #include "comms/CompileControl.h"
 
@@ -23,6 +24,7 @@ CC_DISABLE_WARNINGS()
 #include <QtNetwork/QHostAddress>
 CC_ENABLE_WARNINGS()
 
+#include "comms_champion/EndpointRegistry.h"
 #include "Socket.h"
 
 namespace comms_champion
@@ -40,9 +42,24 @@ namespace server
 namespace
 {
 
-const QString FromPropName("tcp.from");
 const QString ToPropName("tcp.to");
 
+EndpointRegistry::TransportId transportId()
+{
+    static const auto Id = EndpointRegistry::instanceRef().registerTransport("tcp");
+    return Id;
+}
+
+DataInfo::EndpointId endpointId(const QHostAddress& address, quint16 port)
+{
+    return EndpointRegistry::instanceRef().internHost(transportId(), address, port);
+}
+
+QString endpointName(const QHostAddress& address, quint16 port)
+{
+    return EndpointRegistry::instanceRef().endpointName(endpointId(address, port));
+}
+
 }  // namespace
 
 Socket::Socket()
@@ -58,8 +75,9 @@ Socket::Socket()
 
 Socket::~Socket()
 {
-    for (auto* socket : m_sockets) {
-        socket->flush();
+    for (auto& elem : m_sockets) {
+        elem.second.m_txQueue->flush();
+        elem.first->flush();
     }
 }
 
@@ -95,24 +113,16 @@ void Socket::sendDataImpl(DataInfoPtr dataPtr)
 
     QVariantList toList;
 
-    for (auto* socketTmp : m_sockets) {
-        auto* socket = qobject_cast<QTcpSocket*>(socketTmp);
+    for (auto& elem : m_sockets) {
+        auto* socket = elem.first;
         assert(socket != nullptr);
-        socket->write(
-            reinterpret_cast<const char*>(&dataPtr->m_data[0]),
-            dataPtr->m_data.size());
-
-        QString to =
-            socket->peerAddress().toString() + ':' +
-                        QString("%1").arg(socket->peerPort());
-        toList.append(to);
-    }
+        assert(elem.second.m_txQueue);
+        elem.second.m_txQueue->push(dataPtr);
 
-    QString from =
-        m_server.serverAddress().toString() + ':' +
-                    QString("%1").arg(m_server.serverPort());
+        toList.append(endpointName(socket->peerAddress(), socket->peerPort()));
+    }
 
-    dataPtr->m_extraProperties.insert(FromPropName, from);
+    dataPtr->m_fromEndpoint = endpointId(m_server.serverAddress(), m_server.serverPort());
     dataPtr->m_extraProperties.insert(ToPropName, toList);
 }
 
@@ -121,10 +131,52 @@ unsigned Socket::connectionPropertiesImpl() const
     return ConnectionProperty_Autoconnect;
 }
 
+std::size_t Socket::pendingBytesImpl() const
+{
+    // The slowest connection limits the sender
+    std::size_t result = 0U;
+    for (auto& elem : m_sockets) {
+        assert(elem.second.m_txQueue);
+        result = std::max(result, elem.second.m_txQueue->pendingBytes());
+    }
+    return result;
+}
+
+Socket::StatsList Socket::statsImpl() const
+{
+    // Totals include the already closed connections
+    auto transmitStats = m_closedTransmitStats;
+    auto receivedBytes = m_closedReceivedBytesCount;
+    auto receivedFrames = m_closedReceivedFramesCount;
+    for (auto& elem : m_sockets) {
+        auto& info = elem.second;
+        assert(info.m_txQueue);
+        transmitStats.add(info.m_txQueue->getStats());
+        receivedBytes += info.m_receivedBytesCount;
+        receivedFrames += info.m_receivedFramesCount;
+    }
+
+    StatsList result;
+    result.emplace_back("connections", static_cast<qulonglong>(m_sockets.size()));
+    result.emplace_back("rx_bytes", receivedBytes);
+    result.emplace_back("rx_frames", receivedFrames);
+    transmitStats.report(result);
+    return result;
+}
+
 void Socket::newConnection()
 {
     auto *newConnSocket = m_server.nextPendingConnection();
-    m_sockets.push_back(newConnSocket);
+
+    ++m_lastStreamId;
+    if (m_lastStreamId == DataInfo::DefaultStreamId) {
+        ++m_lastStreamId;
+    }
+
+    ConnectionInfo connInfo;
+    connInfo.m_streamId = m_lastStreamId;
+    connInfo.m_txQueue.reset(new TransmitQueue(*newConnSocket));
+    m_sockets.insert(std::make_pair(newConnSocket, std::move(connInfo)));
     connect(
         newConnSocket, SIGNAL(disconnected()),
         newConnSocket, SLOT(deleteLater()));
@@ -141,14 +193,19 @@ void Socket::newConnection()
 
 void Socket::connectionTerminated()
 {
-    auto* socket = sender();
-    auto iter = std::find(m_sockets.begin(), m_sockets.end(), socket);
+    auto* socket = qobject_cast<QTcpSocket*>(sender());
+    auto iter = m_sockets.find(socket);
     if (iter == m_sockets.end()) {
         assert(!"Must have found socket");
         return;
     }
 
+    auto streamId = iter->second.m_streamId;
+    m_closedTransmitStats.add(iter->second.m_txQueue->getStats());
+    m_closedReceivedBytesCount += iter->second.m_receivedBytesCount;
+    m_closedReceivedFramesCount += iter->second.m_receivedFramesCount;
     m_sockets.erase(iter);
+    reportStreamClosed(streamId);
 }
 
 void Socket::readFromSocket()
@@ -156,8 +213,12 @@ void Socket::readFromSocket()
     auto* socket = qobject_cast<QTcpSocket*>(sender());
     assert(socket != nullptr);
 
+    auto iter = m_sockets.find(socket);
+    assert(iter != m_sockets.end());
+
     auto dataPtr = makeDataInfo();
     dataPtr->m_timestamp = DataInfo::TimestampClock::now();
+    dataPtr->m_streamId = iter->second.m_streamId;
 
     auto dataSize = socket->bytesAvailable();
     dataPtr->m_data.resize(dataSize);
@@ -167,15 +228,12 @@ void Socket::readFromSocket()
         dataPtr->m_data.resize(result);
     }
 
-    QString from =
-        socket->peerAddress().toString() + ':' +
-                    QString("%1").arg(socket->peerPort());
-    dataPtr->m_extraProperties.insert(FromPropName, from);
+    iter->second.m_receivedBytesCount += dataPtr->m_data.size();
+    ++iter->second.m_receivedFramesCount;
+
+    dataPtr->m_fromEndpoint = endpointId(socket->peerAddress(), socket->peerPort());
 
-    QString to =
-        m_server.serverAddress().toString() + ':' +
-                    QString("%1").arg(m_server.serverPort());
-    dataPtr->m_extraProperties.insert(ToPropName, to);
+    dataPtr->m_toEndpoint = endpointId(m_server.serverAddress(), m_server.serverPort());
 
     reportDataReceived(std::move(dataPtr));
 }
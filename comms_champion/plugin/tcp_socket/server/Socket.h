@@ -17,7 +17,8 @@
 
 #pragma once
 
-#include <list>
+#include <memory>
+#include <unordered_map>
 
 #include "comms/CompileControl.h"
 
@@ -27,6 +28,7 @@ CC_DISABLE_WARNINGS()
 CC_ENABLE_WARNINGS()
 
 #include "comms_champion/Socket.h"
+#include "common/TransmitQueue.h"
 
 
 namespace comms_champion
@@ -68,6 +70,8 @@ protected:
     virtual void socketDisconnectImpl() override;
     virtual void sendDataImpl(DataInfoPtr dataPtr) override;
     virtual unsigned connectionPropertiesImpl() const override;
+    virtual std::size_t pendingBytesImpl() const override;
+    virtual StatsList statsImpl() const override;
 
 private slots:
     void newConnection();
@@ -77,10 +81,26 @@ private slots:
     void acceptErrorOccurred(QAbstractSocket::SocketError err);
 
 private:
+    typedef std::unique_ptr<TransmitQueue> TransmitQueuePtr;
+
+    struct ConnectionInfo
+    {
+        DataInfo::StreamId m_streamId = DataInfo::DefaultStreamId;
+        TransmitQueuePtr m_txQueue;
+        unsigned long long m_receivedBytesCount = 0U;
+        unsigned long long m_receivedFramesCount = 0U;
+    };
+
+    typedef std::unordered_map<QTcpSocket*, ConnectionInfo> SocketsMap;
+
     static const PortType DefaultPort = 20000;
     PortType m_port = DefaultPort;
-    std::list<QTcpSocket*> m_sockets;
+    SocketsMap m_sockets;
     QTcpServer m_server;
+    DataInfo::StreamId m_lastStreamId = DataInfo::DefaultStreamId;
+    TransmitQueue::Stats m_closedTransmitStats;
+    unsigned long long m_closedReceivedBytesCount = 0U;
+    unsigned long long m_closedReceivedFramesCount = 0U;
 };
 
 }  // namespace server
@@ -0,0 +1,387 @@
+//
+// Copyright 2016 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "NativeSocket.h"
+
+#include <cassert>
+#include <chrono>
+#include <algorithm>
+
+#ifdef Q_OS_LINUX
+#include <cerrno>
+#include <cstring>
+#include <time.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#endif
+
+namespace comms_champion
+{
+
+namespace plugin
+{
+
+namespace udp_socket
+{
+
+namespace client
+{
+
+namespace
+{
+
+#ifdef Q_OS_LINUX
+
+const std::size_t BatchSize = 16U;
+const std::size_t MaxDatagramSize = 64U * 1024U;
+
+union ControlBuf
+{
+    struct cmsghdr m_align;
+    char m_buf[CMSG_SPACE(sizeof(struct timespec))];
+};
+
+QString lastErrorString()
+{
+    return QString::fromLocal8Bit(std::strerror(errno));
+}
+
+bool wouldBlock(int err)
+{
+#if EAGAIN == EWOULDBLOCK
+    return err == EAGAIN;
+#else
+    return (err == EAGAIN) || (err == EWOULDBLOCK);
+#endif
+}
+
+#endif
+
+}  // namespace
+
+double NativeSocket::Stats::avgLatencyUs() const
+{
+    if (m_kernelTimestampsCount == 0U) {
+        return 0.0;
+    }
+
+    return
+        static_cast<double>(m_totalLatencyNs) /
+        static_cast<double>(m_kernelTimestampsCount) /
+        1000.0;
+}
+
+NativeSocket::NativeSocket() = default;
+
+NativeSocket::~NativeSocket()
+{
+    close();
+}
+
+bool NativeSocket::isSupported()
+{
+#ifdef Q_OS_LINUX
+    return true;
+#else
+    return false;
+#endif
+}
+
+QHostAddress NativeSocket::localAddressTo(const QHostAddress& address, PortType port)
+{
+#ifdef Q_OS_LINUX
+    bool ipv4 = false;
+    auto ipv4Address = address.toIPv4Address(&ipv4);
+    if (!ipv4) {
+        return QHostAddress();
+    }
+
+    int fd = ::socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return QHostAddress();
+    }
+
+    // Connecting UDP socket only selects the route, nothing is sent
+    struct sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(ipv4Address);
+    addr.sin_port = htons(port);
+    QHostAddress result;
+    socklen_t addrLen = sizeof(addr);
+    if ((::connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == 0) &&
+        (::getsockname(fd, reinterpret_cast<struct sockaddr*>(&addr), &addrLen) == 0)) {
+        result = QHostAddress(ntohl(addr.sin_addr.s_addr));
+    }
+
+    ::close(fd);
+    return result;
+#else
+    static_cast<void>(address);
+    static_cast<void>(port);
+    return QHostAddress();
+#endif
+}
+
+bool NativeSocket::open(PortType localPort)
+{
+#ifdef Q_OS_LINUX
+    close();
+
+    int fd = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        reportError("Failed to create UDP socket: " + lastErrorString());
+        return false;
+    }
+
+    int enabled = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &enabled, sizeof(enabled));
+    ::setsockopt(fd, SOL_SOCKET, SO_BROADCAST, &enabled, sizeof(enabled));
+    if (::setsockopt(fd, SOL_SOCKET, SO_TIMESTAMPNS, &enabled, sizeof(enabled)) != 0) {
+        reportError("Kernel receive timestamps are not available: " + lastErrorString());
+    }
+
+    struct sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    addr.sin_port = htons(localPort);
+    if (::bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0) {
+        reportError(
+            "Failed to bind UDP socket to port " + QString("%1").arg(localPort) +
+            ": " + lastErrorString());
+        ::close(fd);
+        return false;
+    }
+
+    socklen_t addrLen = sizeof(addr);
+    if (::getsockname(fd, reinterpret_cast<struct sockaddr*>(&addr), &addrLen) == 0) {
+        m_localAddress = QHostAddress(ntohl(addr.sin_addr.s_addr));
+        m_localPort = ntohs(addr.sin_port);
+    }
+    else {
+        m_localAddress = QHostAddress(QHostAddress::AnyIPv4);
+        m_localPort = localPort;
+    }
+
+    m_fd = fd;
+    m_stats = Stats();
+    m_arena.resize(BatchSize * MaxDatagramSize);
+    m_notifier.reset(new QSocketNotifier(fd, QSocketNotifier::Read));
+    connect(
+        m_notifier.get(), SIGNAL(activated(int)),
+        this, SLOT(readPending()));
+    return true;
+#else
+    static_cast<void>(localPort);
+    reportError("Native UDP socket is not supported on this platform.");
+    return false;
+#endif
+}
+
+void NativeSocket::close()
+{
+    if (m_notifier) {
+        m_notifier->setEnabled(false);
+        m_notifier.release()->deleteLater();
+    }
+
+#ifdef Q_OS_LINUX
+    if (0 <= m_fd) {
+        ::close(m_fd);
+    }
+#endif
+
+    m_fd = -1;
+    m_localAddress.clear();
+    m_localPort = 0;
+}
+
+bool NativeSocket::writeDatagram(
+    const std::uint8_t* data,
+    std::size_t size,
+    const QHostAddress& address,
+    PortType port)
+{
+#ifdef Q_OS_LINUX
+    if (!isOpen()) {
+        return false;
+    }
+
+    // The socket is AF_INET, IPv6 peers are served by the Qt socket
+    bool ipv4 = false;
+    auto ipv4Address = address.toIPv4Address(&ipv4);
+    if (!ipv4) {
+        return false;
+    }
+
+    struct sockaddr_in addr;
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(ipv4Address);
+    addr.sin_port = htons(port);
+
+    ssize_t result = -1;
+    do {
+        result =
+            ::sendto(
+                m_fd,
+                data,
+                size,
+                MSG_NOSIGNAL,
+                reinterpret_cast<const struct sockaddr*>(&addr),
+                sizeof(addr));
+    } while ((result < 0) && (errno == EINTR));
+
+    return (0 <= result) && (static_cast<std::size_t>(result) == size);
+#else
+    static_cast<void>(data);
+    static_cast<void>(size);
+    static_cast<void>(address);
+    static_cast<void>(port);
+    return false;
+#endif
+}
+
+void NativeSocket::readPending()
+{
+#ifdef Q_OS_LINUX
+    struct mmsghdr msgs[BatchSize];
+    struct iovec iovs[BatchSize];
+    struct sockaddr_in addrs[BatchSize];
+    ControlBuf controls[BatchSize];
+
+    while (isOpen()) {
+        m_readStart = DataInfo::TimestampClock::now();
+        std::memset(&msgs[0], 0, sizeof(msgs));
+        for (auto idx = 0U; idx < BatchSize; ++idx) {
+            iovs[idx].iov_base = &m_arena[idx * MaxDatagramSize];
+            iovs[idx].iov_len = MaxDatagramSize;
+
+            auto& hdr = msgs[idx].msg_hdr;
+            hdr.msg_iov = &iovs[idx];
+            hdr.msg_iovlen = 1;
+            hdr.msg_name = &addrs[idx];
+            hdr.msg_namelen = sizeof(addrs[idx]);
+            hdr.msg_control = controls[idx].m_buf;
+            hdr.msg_controllen = sizeof(controls[idx].m_buf);
+        }
+
+        auto count = ::recvmmsg(m_fd, &msgs[0], BatchSize, MSG_DONTWAIT, nullptr);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            if (!wouldBlock(errno)) {
+                reportError("Failed to read UDP datagrams: " + lastErrorString());
+            }
+            break;
+        }
+
+        if (count == 0) {
+            break;
+        }
+
+        auto sysNow = std::chrono::system_clock::now();
+        auto userNow = DataInfo::TimestampClock::now();
+
+        ++m_stats.m_batchesCount;
+        m_stats.m_maxBatchSize =
+            std::max(m_stats.m_maxBatchSize, static_cast<std::size_t>(count));
+
+        for (auto idx = 0; idx < count; ++idx) {
+            auto& hdr = msgs[idx].msg_hdr;
+            std::size_t size = msgs[idx].msg_len;
+            if ((hdr.msg_flags & MSG_TRUNC) != 0) {
+                ++m_stats.m_truncatedCount;
+            }
+
+            auto dataPtr = makeDataInfo();
+            auto* dataBegin = &m_arena[static_cast<std::size_t>(idx) * MaxDatagramSize];
+            dataPtr->m_data.assign(dataBegin, dataBegin + size);
+            dataPtr->m_timestamp = userNow;
+
+            for (auto* cmsg = CMSG_FIRSTHDR(&hdr); cmsg != nullptr; cmsg = CMSG_NXTHDR(&hdr, cmsg)) {
+                if ((cmsg->cmsg_level != SOL_SOCKET) ||
+                    (cmsg->cmsg_type != SCM_TIMESTAMPNS)) {
+                    continue;
+                }
+
+                struct timespec ts;
+                std::memcpy(&ts, CMSG_DATA(cmsg), sizeof(ts));
+                auto kernelTime =
+                    std::chrono::system_clock::time_point(
+                        std::chrono::duration_cast<std::chrono::system_clock::duration>(
+                            std::chrono::seconds(ts.tv_sec) +
+                            std::chrono::nanoseconds(ts.tv_nsec)));
+
+                auto latency = sysNow - kernelTime;
+                if (latency < std::chrono::system_clock::duration::zero()) {
+                    latency = std::chrono::system_clock::duration::zero();
+                }
+
+                dataPtr->m_timestamp =
+                    userNow - std::chrono::duration_cast<DataInfo::TimestampClock::duration>(latency);
+
+                auto latencyNs =
+                    static_cast<unsigned long long>(
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count());
+                ++m_stats.m_kernelTimestampsCount;
+                m_stats.m_totalLatencyNs += latencyNs;
+                m_stats.m_maxLatencyNs = std::max(m_stats.m_maxLatencyNs, latencyNs);
+                break;
+            }
+
+            ++m_stats.m_datagramsCount;
+            m_stats.m_bytesCount += size;
+
+            QHostAddress senderAddress(ntohl(addrs[idx].sin_addr.s_addr));
+            auto senderPort = static_cast<PortType>(ntohs(addrs[idx].sin_port));
+            if (m_datagramReceivedCallback) {
+                m_datagramReceivedCallback(std::move(dataPtr), senderAddress, senderPort);
+            }
+
+            if (!isOpen()) {
+                return;
+            }
+        }
+
+        if (static_cast<std::size_t>(count) < BatchSize) {
+            break;
+        }
+    }
+#endif
+}
+
+void NativeSocket::reportError(const QString& msg)
+{
+    if (m_errorReportCallback) {
+        m_errorReportCallback(msg);
+    }
+}
+
+}  // namespace client
+
+}  // namespace udp_socket
+
+}  // namespace plugin
+
+}  // namespace comms_champion
+
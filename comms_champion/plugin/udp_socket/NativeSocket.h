@@ -0,0 +1,157 @@
+//
+// Copyright 2016 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <memory>
+#include <functional>
+
+#include "comms/CompileControl.h"
+
+CC_DISABLE_WARNINGS()
+#include <QtCore/QObject>
+#include <QtCore/QSocketNotifier>
+#include <QtNetwork/QHostAddress>
+CC_ENABLE_WARNINGS()
+
+#include "comms_champion/DataInfo.h"
+
+
+namespace comms_champion
+{
+
+namespace plugin
+{
+
+namespace udp_socket
+{
+
+namespace client
+{
+
+class NativeSocket : public QObject
+{
+    Q_OBJECT
+
+public:
+    typedef unsigned short PortType;
+
+    struct Stats
+    {
+        unsigned long long m_datagramsCount = 0U;
+        unsigned long long m_bytesCount = 0U;
+        unsigned long long m_batchesCount = 0U;
+        unsigned long long m_truncatedCount = 0U;
+        unsigned long long m_kernelTimestampsCount = 0U;
+        unsigned long long m_totalLatencyNs = 0U;
+        unsigned long long m_maxLatencyNs = 0U;
+        std::size_t m_maxBatchSize = 0U;
+
+        double avgLatencyUs() const;
+    };
+
+    typedef std::function<void (DataInfoPtr, const QHostAddress&, PortType)> DatagramReceivedCallback;
+    typedef std::function<void (const QString&)> ErrorReportCallback;
+
+    NativeSocket();
+    ~NativeSocket();
+
+    static bool isSupported();
+
+    // Local address the datagrams to the peer are sent from, null when
+    // it cannot be determined
+    static QHostAddress localAddressTo(const QHostAddress& address, PortType port);
+
+    bool open(PortType localPort);
+
+    void close();
+
+    bool isOpen() const
+    {
+        return 0 <= m_fd;
+    }
+
+    bool writeDatagram(
+        const std::uint8_t* data,
+        std::size_t size,
+        const QHostAddress& address,
+        PortType port);
+
+    QHostAddress localAddress() const
+    {
+        return m_localAddress;
+    }
+
+    PortType localPort() const
+    {
+        return m_localPort;
+    }
+
+    const Stats& getStats() const
+    {
+        return m_stats;
+    }
+
+    // Time the currently reported batch started to be read,
+    // kernel timestamps precede it by the socket queueing delay.
+    const DataInfo::Timestamp& getReadStart() const
+    {
+        return m_readStart;
+    }
+
+    template <typename TFunc>
+    void setDatagramReceivedCallback(TFunc&& func)
+    {
+        m_datagramReceivedCallback = std::forward<TFunc>(func);
+    }
+
+    template <typename TFunc>
+    void setErrorReportCallback(TFunc&& func)
+    {
+        m_errorReportCallback = std::forward<TFunc>(func);
+    }
+
+private slots:
+    void readPending();
+
+private:
+    void reportError(const QString& msg);
+
+    int m_fd = -1;
+    std::unique_ptr<QSocketNotifier> m_notifier;
+    std::vector<std::uint8_t> m_arena;
+    QHostAddress m_localAddress;
+    PortType m_localPort = 0;
+    Stats m_stats;
+    DataInfo::Timestamp m_readStart;
+    DatagramReceivedCallback m_datagramReceivedCallback;
+    ErrorReportCallback m_errorReportCallback;
+};
+
+}  // namespace client
+
+}  // namespace udp_socket
+
+}  // namespace plugin
+
+}  // namespace comms_champion
+
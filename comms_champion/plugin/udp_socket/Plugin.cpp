@@ -42,6 +42,7 @@ const QString HostSubKey("host");
 const QString PortSubKey("port");
 const QString LocalPortSubKey("local_port");
 const QString BroadcastPropName("broadcast_prop");
+const QString NativeReceiveSubKey("native_receive");
 
 }  // namespace
 
@@ -74,6 +75,7 @@ void Plugin::getCurrentConfigImpl(QVariantMap& config)
     subConfig.insert(PortSubKey, m_socket->getPort());
     subConfig.insert(LocalPortSubKey, m_socket->getLocalPort());
     subConfig.insert(BroadcastPropName, m_socket->getBroadcastPropName());
+    subConfig.insert(NativeReceiveSubKey, m_socket->getNativeReceive());
     config.insert(MainConfigKey, QVariant::fromValue(subConfig));
 }
 
@@ -113,6 +115,11 @@ void Plugin::reconfigureImpl(const QVariantMap& config)
         auto propName = broadcastBroadcastNameVar.value<QString>();
         m_socket->setBroadcastPropName(propName);
     }
+
+    auto nativeReceiveVar = subConfig.value(NativeReceiveSubKey);
+    if (nativeReceiveVar.isValid() && nativeReceiveVar.canConvert<bool>()) {
+        m_socket->setNativeReceive(nativeReceiveVar.value<bool>());
+    }
 }
 
 void Plugin::createSocketIfNeeded()
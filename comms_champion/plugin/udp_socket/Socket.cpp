@@ -15,8 +15,10 @@
 // You should have received a copy of the GNU Lesser General Public License
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
+
 #include <cassert>
 #include <iostream>
+#include <algorithm>
 
 #include "comms/CompileControl.h"
 
@@ -24,6 +26,7 @@ CC_DISABLE_WARNINGS()
 #include <QtNetwork/QHostAddress>
 CC_ENABLE_WARNINGS()
 
+#include "comms_champion/EndpointRegistry.h"
 #include "Socket.h"
 
 namespace comms_champion
@@ -43,15 +46,28 @@ namespace
 
 const QString DefaultHost("127.0.0.1");
 const QString DefaultBroadcastPropName("broadcast");
-const QString FromPropName("udp.from");
 const QString ToPropName("udp.to");
 
+EndpointRegistry::TransportId transportId()
+{
+    static const auto Id = EndpointRegistry::instanceRef().registerTransport("udp");
+    return Id;
+}
+
+DataInfo::EndpointId endpointId(const QHostAddress& address, quint16 port)
+{
+    return EndpointRegistry::instanceRef().internHost(transportId(), address, port);
+}
+
 }  // namespace
 
+const std::size_t Socket::MaxPeersCount;
+const std::size_t Socket::FirstDatagramsCount;
 
 Socket::Socket()
   : m_host(DefaultHost),
-    m_broadcastPropName(DefaultBroadcastPropName)
+    m_broadcastPropName(DefaultBroadcastPropName),
+    m_firstDatagramsLatency(LatencyRecorder::Mode::KeepFirst, FirstDatagramsCount)
 {
     connect(
         &m_socket, SIGNAL(disconnected()),
@@ -68,10 +84,23 @@ Socket::Socket()
     connect(
         &m_broadcastSocket, SIGNAL(error(QAbstractSocket::SocketError)),
         this, SLOT(socketErrorOccurred(QAbstractSocket::SocketError)));
+
+    m_nativeSocket.setDatagramReceivedCallback(
+        [this](DataInfoPtr dataPtr, const QHostAddress& senderAddress, PortType senderPort)
+        {
+            nativeDatagramReceived(std::move(dataPtr), senderAddress, senderPort);
+        });
+
+    m_nativeSocket.setErrorReportCallback(
+        [this](const QString& msg)
+        {
+            reportError(msg);
+        });
 }
 
 Socket::~Socket()
 {
+    abortHostLookup();
     m_socket.blockSignals(true);
 }
 
@@ -93,41 +122,52 @@ bool Socket::socketConnectImpl()
 
     assert(!m_socket.isOpen());
     assert(!m_broadcastSocket.isOpen());
-    m_running = true;
+    assert(!m_nativeSocket.isOpen());
+
+    m_peers.clear();
+    m_firstDatagramsLatency.clear();
+    m_datagramsCount = 0U;
+    m_filteredCount = 0U;
+
+    // The native socket is IPv4 only, use Qt one for other remote hosts
+    QHostAddress hostAddress;
+    bool nativeReceive = m_nativeReceive;
+    if (hostAddress.setAddress(m_host) &&
+        (hostAddress.protocol() != QAbstractSocket::IPv4Protocol)) {
+        nativeReceive = false;
+    }
 
-    do {
-        if (m_localPort == 0) {
-            break;
+    if (nativeReceive) {
+        if (!m_nativeSocket.open(m_localPort)) {
+            return false;
         }
-
-        if (!bindSocket(m_socket)) {
+    }
+    else {
+        if (!bindSocket(m_socket, m_localPort)) {
             reportError("Failed to bind UDP socket to port " + QString("%1").arg(m_localPort));
+            return false;
         }
 
-        if (!bindSocket(m_broadcastSocket)) {
+        if ((m_localPort != 0) && (!bindSocket(m_broadcastSocket, m_localPort))) {
             reportError("Failed to bind broadcast UDP socket to port " + QString("%1").arg(m_localPort));
         }
+    }
 
-    } while (false);
-
-    do {
-        if (m_host.isEmpty()) {
-            break;
-        }
-
-        m_socket.connectToHost(m_host, m_port);
-        if (!m_socket.waitForConnected()) {
-            reportError("Failed to connect UDP socket to " + QString("%1:%2").arg(m_host).arg(m_port));
-        }
-    } while (false);
+    m_nativeReceiveUsed = nativeReceive;
+    m_running = true;
+    startHostLookup();
     return true;
 }
 
 void Socket::socketDisconnectImpl()
 {
+    abortHostLookup();
     m_socket.blockSignals(true);
     m_socket.close();
     m_broadcastSocket.close();
+    m_nativeSocket.close();
+    m_remoteAddress.clear();
+    m_peers.clear();
     m_running = false;
     m_socket.blockSignals(false);
 }
@@ -135,67 +175,100 @@ void Socket::socketDisconnectImpl()
 void Socket::sendDataImpl(DataInfoPtr dataPtr)
 {
     assert(dataPtr);
-    QString from =
-        m_socket.localAddress().toString() + ':' +
-                    QString("%1").arg(m_socket.localPort());
-    dataPtr->m_extraProperties.insert(FromPropName, from);
-
-    do {
-        if ((!dataPtr->m_extraProperties.contains(m_broadcastPropName)) ||
-            (!m_broadcastSocket.isOpen()) ||
-            (m_port == 0)) {
-            break;
-        }
+    if (dataPtr->m_data.empty()) {
+        return;
+    }
 
-        std::size_t writtenCount = 0;
-        while (writtenCount < dataPtr->m_data.size()) {
-            auto remSize = dataPtr->m_data.size() - writtenCount;
-            auto count =
-                m_broadcastSocket.writeDatagram(
-                    reinterpret_cast<const char*>(&dataPtr->m_data[writtenCount]),
-                    remSize,
-                    QHostAddress::Broadcast,
-                    m_port);
-
-            if (count < 0) {
-                return;
-            }
-
-            writtenCount += count;
-        }
+    dataPtr->m_fromEndpoint = endpointId(localAddress(), localPort());
 
-        QString to =
-            QHostAddress(QHostAddress::Broadcast).toString() + ':' +
-                        QString("%1").arg(m_port);
+    if (dataPtr->m_extraProperties.contains(m_broadcastPropName) && (m_port != 0)) {
+        QHostAddress broadcastAddress(QHostAddress::Broadcast);
+        if (writeDatagram(*dataPtr, broadcastAddress, m_port, true)) {
+            dataPtr->m_toEndpoint = endpointId(broadcastAddress, m_port);
+        }
+        return;
+    }
 
-        dataPtr->m_extraProperties.insert(ToPropName, to);
+    if (!m_remoteAddress.isNull()) {
+        if (writeDatagram(*dataPtr, m_remoteAddress, m_port, false)) {
+            dataPtr->m_toEndpoint = endpointId(m_remoteAddress, m_port);
+        }
         return;
-    } while (false);
+    }
 
-    if (!m_socket.isOpen()) {
+    auto* peer = findPeer(*dataPtr);
+    if (peer != nullptr) {
+        if (writeDatagram(*dataPtr, peer->m_address, peer->m_port, false)) {
+            dataPtr->m_toEndpoint = peer->m_endpoint;
+        }
         return;
     }
 
-    std::size_t writtenCount = 0;
-    while (writtenCount < dataPtr->m_data.size()) {
-        auto remSize = dataPtr->m_data.size() - writtenCount;
-        auto count =
-            m_socket.write(
-                reinterpret_cast<const char*>(&dataPtr->m_data[writtenCount]),
-                remSize);
-        if (count < 0) {
-            return;
+    if (m_peers.size() == 1U) {
+        auto& onlyPeer = m_peers.begin()->second;
+        if (writeDatagram(*dataPtr, onlyPeer.m_address, onlyPeer.m_port, false)) {
+            dataPtr->m_toEndpoint = onlyPeer.m_endpoint;
         }
+        return;
+    }
 
-        writtenCount += count;
+    QVariantList toList;
+    auto& registry = EndpointRegistry::instanceRef();
+    for (auto& elem : m_peers) {
+        auto& p = elem.second;
+        if (writeDatagram(*dataPtr, p.m_address, p.m_port, false)) {
+            toList.append(registry.endpointName(p.m_endpoint));
+        }
     }
 
-    QString to =
-        m_socket.peerAddress().toString() + ':' +
-                    QString("%1").arg(m_socket.peerPort());
+    if (!toList.isEmpty()) {
+        dataPtr->m_extraProperties.insert(ToPropName, toList);
+    }
+}
 
-    dataPtr->m_extraProperties.insert(ToPropName, to);
+Socket::StatsList Socket::statsImpl() const
+{
+    StatsList result;
+    result.emplace_back("receive_path", m_nativeReceiveUsed ? "native" : "qt");
+    result.emplace_back("datagrams", m_datagramsCount);
+
+    double datagramsPerSec = 0.0;
+    auto duration =
+        std::chrono::duration_cast<std::chrono::duration<double> >(
+            m_lastDatagramTimestamp - m_firstDatagramTimestamp).count();
+    if ((1U < m_datagramsCount) && (0.0 < duration)) {
+        datagramsPerSec = static_cast<double>(m_datagramsCount - 1U) / duration;
+    }
+    result.emplace_back("datagrams_per_sec", datagramsPerSec);
+    result.emplace_back("filtered", m_filteredCount);
+    result.emplace_back("peers", static_cast<qulonglong>(m_peers.size()));
+
+    // Time from the start of the read to reporting the datagram
+    auto toUs =
+        [](LatencyRecorder::Duration value) -> double
+        {
+            return std::chrono::duration_cast<std::chrono::duration<double, std::micro> >(value).count();
+        };
+    result.emplace_back("first_datagrams_latency_p50_us", toUs(m_firstDatagramsLatency.percentile(50.0)));
+    result.emplace_back("first_datagrams_latency_p99_us", toUs(m_firstDatagramsLatency.percentile(99.0)));
+    result.emplace_back("first_datagrams_latency_max_us", toUs(m_firstDatagramsLatency.max()));
+
+    if (!m_nativeReceiveUsed) {
+        return result;
+    }
 
+    // The Qt path timestamps datagrams when they are read, kernel
+    // timestamps correct it by the socket queueing delay
+    auto& nativeStats = m_nativeSocket.getStats();
+    result.emplace_back("kernel_timestamps", nativeStats.m_kernelTimestampsCount);
+    result.emplace_back("timestamp_correction_avg_us", nativeStats.avgLatencyUs());
+    result.emplace_back(
+        "timestamp_correction_max_us",
+        static_cast<double>(nativeStats.m_maxLatencyNs) / 1000.0);
+    result.emplace_back("read_batches", nativeStats.m_batchesCount);
+    result.emplace_back("max_read_batch", static_cast<qulonglong>(nativeStats.m_maxBatchSize));
+    result.emplace_back("truncated", nativeStats.m_truncatedCount);
+    return result;
 }
 
 void Socket::socketDisconnected()
@@ -219,8 +292,30 @@ void Socket::socketErrorOccurred(QAbstractSocket::SocketError err)
     std::cout << "ERROR: UDP Socket: " << m_socket.errorString().toStdString() << std::endl;
 }
 
+void Socket::hostLookedUp(const QHostInfo& info)
+{
+    if (info.lookupId() != m_hostLookupId) {
+        return;
+    }
+
+    m_hostLookupId = -1;
+    if (!m_running) {
+        return;
+    }
+
+    for (auto& addr : info.addresses()) {
+        if (addr.protocol() == QAbstractSocket::IPv4Protocol) {
+            m_remoteAddress = addr;
+            return;
+        }
+    }
+
+    reportError("Failed to resolve UDP remote host " + m_host);
+}
+
 void Socket::readData(QUdpSocket& socket)
 {
+    auto readStart = DataInfo::TimestampClock::now();
     while (socket.hasPendingDatagrams()) {
         QHostAddress senderAddress;
         quint16 senderPort;
@@ -234,35 +329,219 @@ void Socket::readData(QUdpSocket& socket)
             &senderAddress,
             &senderPort);
 
-        QString from =
-            senderAddress.toString() + ':' +
-                        QString("%1").arg(senderPort);
-        QString to =
-            m_socket.localAddress().toString() + ':' +
-                        QString("%1").arg(m_socket.localPort());
-
-        dataPtr->m_extraProperties.insert(FromPropName, from);
-        dataPtr->m_extraProperties.insert(ToPropName, to);
-        reportDataReceived(std::move(dataPtr));
-
-        if (m_socket.state() != QUdpSocket::ConnectedState) {
-            m_socket.connectToHost(senderAddress, senderPort);
-            m_socket.waitForConnected();
-            assert(m_socket.isOpen());
-            assert(m_socket.state() == QUdpSocket::ConnectedState);
-        }
+        datagramReceived(std::move(dataPtr), senderAddress, senderPort, readStart);
     }
 }
 
-bool Socket::bindSocket(QUdpSocket& socket)
+bool Socket::bindSocket(QUdpSocket& socket, PortType port)
 {
-    if (!socket.bind(QHostAddress::AnyIPv4, m_localPort, QUdpSocket::ShareAddress)) {
+    if (!socket.bind(QHostAddress::AnyIPv4, port, QUdpSocket::ShareAddress)) {
         return false;
     }
 
     return socket.open(QUdpSocket::ReadWrite);
 }
 
+void Socket::startHostLookup()
+{
+    m_remoteAddress.clear();
+    if (m_host.isEmpty()) {
+        return;
+    }
+
+    if (m_remoteAddress.setAddress(m_host)) {
+        return;
+    }
+
+    m_hostLookupId = QHostInfo::lookupHost(m_host, this, SLOT(hostLookedUp(const QHostInfo&)));
+}
+
+void Socket::abortHostLookup()
+{
+    if (m_hostLookupId < 0) {
+        return;
+    }
+
+    QHostInfo::abortHostLookup(m_hostLookupId);
+    m_hostLookupId = -1;
+}
+
+bool Socket::writeDatagram(
+    const DataInfo& dataInfo,
+    const QHostAddress& address,
+    PortType port,
+    bool broadcast)
+{
+    assert(!dataInfo.m_data.empty());
+    if (m_nativeSocket.isOpen()) {
+        return
+            m_nativeSocket.writeDatagram(
+                &dataInfo.m_data[0],
+                dataInfo.m_data.size(),
+                address,
+                port);
+    }
+
+    auto* socket = &m_socket;
+    if (broadcast && m_broadcastSocket.isOpen()) {
+        socket = &m_broadcastSocket;
+    }
+
+    if (!socket->isOpen()) {
+        return false;
+    }
+
+    auto count =
+        socket->writeDatagram(
+            reinterpret_cast<const char*>(&dataInfo.m_data[0]),
+            dataInfo.m_data.size(),
+            address,
+            port);
+
+    return (0 <= count) && (static_cast<std::size_t>(count) == dataInfo.m_data.size());
+}
+
+void Socket::nativeDatagramReceived(
+    DataInfoPtr dataPtr,
+    const QHostAddress& senderAddress,
+    PortType senderPort)
+{
+    // Measure the same interval as the Qt path, the kernel queueing
+    // delay is accounted by the native socket statistics.
+    auto readStart = m_nativeSocket.getReadStart();
+    datagramReceived(std::move(dataPtr), senderAddress, senderPort, readStart);
+}
+
+void Socket::datagramReceived(
+    DataInfoPtr dataPtr,
+    const QHostAddress& senderAddress,
+    PortType senderPort,
+    const DataInfo::Timestamp& readStart)
+{
+    // The socket isn't connected, drop datagrams from other hosts
+    if (!isFromRemote(senderAddress, senderPort)) {
+        ++m_filteredCount;
+        return;
+    }
+
+    auto fromEndpoint = endpointId(senderAddress, senderPort);
+    auto iter = m_peers.find(fromEndpoint);
+    if ((iter == m_peers.end()) && (m_peers.size() < MaxPeersCount)) {
+        PeerInfo peer;
+        peer.m_address = senderAddress;
+        peer.m_port = senderPort;
+        peer.m_endpoint = fromEndpoint;
+        peer.m_localEndpoint = localEndpointFor(senderAddress, senderPort);
+        iter = m_peers.insert(std::make_pair(fromEndpoint, std::move(peer))).first;
+    }
+
+    dataPtr->m_fromEndpoint = fromEndpoint;
+    if (iter != m_peers.end()) {
+        dataPtr->m_toEndpoint = iter->second.m_localEndpoint;
+    }
+    else {
+        dataPtr->m_toEndpoint = localEndpointFor(senderAddress, senderPort);
+    }
+
+    if (m_datagramsCount == 0U) {
+        m_firstDatagramTimestamp = dataPtr->m_timestamp;
+    }
+    m_lastDatagramTimestamp = dataPtr->m_timestamp;
+    ++m_datagramsCount;
+
+    if (!m_firstDatagramsLatency.isFull()) {
+        m_firstDatagramsLatency.record(
+            std::chrono::duration_cast<LatencyRecorder::Duration>(
+                DataInfo::TimestampClock::now() - readStart));
+    }
+
+    reportDataReceived(std::move(dataPtr));
+}
+
+const Socket::PeerInfo* Socket::findPeer(const DataInfo& dataInfo) const
+{
+    if (m_peers.empty()) {
+        return nullptr;
+    }
+
+    if (dataInfo.m_toEndpoint != DataInfo::NoEndpoint) {
+        auto iter = m_peers.find(dataInfo.m_toEndpoint);
+        if (iter != m_peers.end()) {
+            return &iter->second;
+        }
+    }
+
+    auto toVar = dataInfo.m_extraProperties.value(ToPropName);
+    if ((!toVar.isValid()) || (!toVar.canConvert<QString>())) {
+        return nullptr;
+    }
+
+    auto toName = toVar.value<QString>();
+    auto& registry = EndpointRegistry::instanceRef();
+    auto iter =
+        std::find_if(
+            m_peers.begin(), m_peers.end(),
+            [&registry, &toName](const PeersMap::value_type& elem) -> bool
+            {
+                return registry.endpointName(elem.second.m_endpoint) == toName;
+            });
+
+    if (iter == m_peers.end()) {
+        return nullptr;
+    }
+
+    return &iter->second;
+}
+
+bool Socket::isFromRemote(const QHostAddress& senderAddress, PortType senderPort) const
+{
+    if (m_host.isEmpty()) {
+        return true;
+    }
+
+    // Nothing is accepted until the remote host is resolved
+    return
+        (!m_remoteAddress.isNull()) &&
+        (senderPort == m_port) &&
+        (senderAddress == m_remoteAddress);
+}
+
+DataInfo::EndpointId Socket::localEndpointFor(
+    const QHostAddress& senderAddress,
+    PortType senderPort) const
+{
+    // The socket is bound to any address, report the one facing the sender
+    auto address = localAddress();
+    if ((address.isNull()) ||
+        (address == QHostAddress(QHostAddress::AnyIPv4)) ||
+        (address == QHostAddress(QHostAddress::Any))) {
+        auto routeAddress = NativeSocket::localAddressTo(senderAddress, senderPort);
+        if (!routeAddress.isNull()) {
+            address = routeAddress;
+        }
+    }
+
+    return endpointId(address, localPort());
+}
+
+QHostAddress Socket::localAddress() const
+{
+    if (m_nativeSocket.isOpen()) {
+        return m_nativeSocket.localAddress();
+    }
+
+    return m_socket.localAddress();
+}
+
+Socket::PortType Socket::localPort() const
+{
+    if (m_nativeSocket.isOpen()) {
+        return m_nativeSocket.localPort();
+    }
+
+    return m_socket.localPort();
+}
+
 }  // namespace client
 
 }  // namespace udp_socket
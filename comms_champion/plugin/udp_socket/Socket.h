@@ -18,14 +18,19 @@
 #pragma once
 
 #include <list>
+#include <vector>
+#include <unordered_map>
 
 #include "comms/CompileControl.h"
 
 CC_DISABLE_WARNINGS()
 #include <QtNetwork/QUdpSocket>
+#include <QtNetwork/QHostInfo>
 CC_ENABLE_WARNINGS()
 
 #include "comms_champion/Socket.h"
+#include "comms_champion/LatencyRecorder.h"
+#include "NativeSocket.h"
 
 
 namespace comms_champion
@@ -92,22 +97,77 @@ public:
         return m_broadcastPropName;
     }
 
+    void setNativeReceive(bool value)
+    {
+        m_nativeReceive = value && NativeSocket::isSupported();
+    }
+
+    bool getNativeReceive() const
+    {
+        return m_nativeReceive;
+    }
+
+    const LatencyRecorder& getFirstDatagramsLatency() const
+    {
+        return m_firstDatagramsLatency;
+    }
+
+    std::size_t getPeersCount() const
+    {
+        return m_peers.size();
+    }
+
 protected:
     virtual bool socketConnectImpl() override;
     virtual void socketDisconnectImpl() override;
     virtual void sendDataImpl(DataInfoPtr dataPtr) override;
+    virtual StatsList statsImpl() const override;
 
 private slots:
     void socketDisconnected();
     void readFromSocket();
     void readFromBroadcastSocket();
     void socketErrorOccurred(QAbstractSocket::SocketError err);
+    void hostLookedUp(const QHostInfo& info);
 
 private:
+    struct PeerInfo
+    {
+        QHostAddress m_address;
+        PortType m_port = 0;
+        DataInfo::EndpointId m_endpoint = DataInfo::NoEndpoint;
+        DataInfo::EndpointId m_localEndpoint = DataInfo::NoEndpoint;
+    };
+
+    typedef std::unordered_map<DataInfo::EndpointId, PeerInfo> PeersMap;
+
     void readData(QUdpSocket& socket);
-    bool bindSocket(QUdpSocket& socket);
+    bool bindSocket(QUdpSocket& socket, PortType port);
+    void startHostLookup();
+    void abortHostLookup();
+    bool writeDatagram(
+        const DataInfo& dataInfo,
+        const QHostAddress& address,
+        PortType port,
+        bool broadcast);
+    void nativeDatagramReceived(
+        DataInfoPtr dataPtr,
+        const QHostAddress& senderAddress,
+        PortType senderPort);
+    void datagramReceived(
+        DataInfoPtr dataPtr,
+        const QHostAddress& senderAddress,
+        PortType senderPort,
+        const DataInfo::Timestamp& readStart);
+    const PeerInfo* findPeer(const DataInfo& dataInfo) const;
+    bool isFromRemote(const QHostAddress& senderAddress, PortType senderPort) const;
+    DataInfo::EndpointId localEndpointFor(const QHostAddress& senderAddress, PortType senderPort) const;
+    QHostAddress localAddress() const;
+    PortType localPort() const;
 
     static const PortType DefaultPort = 20000;
+    static const std::size_t MaxPeersCount = 256U;
+    static const std::size_t FirstDatagramsCount = 1000U;
 
     QString m_host;
     PortType m_port = DefaultPort;
@@ -115,6 +175,17 @@ private:
     QString m_broadcastPropName;
     QUdpSocket m_socket;
     QUdpSocket m_broadcastSocket;
+    NativeSocket m_nativeSocket;
+    QHostAddress m_remoteAddress;
+    int m_hostLookupId = -1;
+    PeersMap m_peers;
+    LatencyRecorder m_firstDatagramsLatency;
+    unsigned long long m_datagramsCount = 0U;
+    unsigned long long m_filteredCount = 0U;
+    DataInfo::Timestamp m_firstDatagramTimestamp;
+    DataInfo::Timestamp m_lastDatagramTimestamp;
+    bool m_nativeReceive = false;
+    bool m_nativeReceiveUsed = false;
     bool m_running = false;
 };
 
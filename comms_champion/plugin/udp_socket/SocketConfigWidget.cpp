@@ -57,6 +57,9 @@ SocketConfigWidget::SocketConfigWidget(
 
     m_ui.m_broadcastLineEdit->setText(m_socket.getBroadcastPropName());
 
+    m_ui.m_nativeReceiveCheckBox->setChecked(m_socket.getNativeReceive());
+    m_ui.m_nativeReceiveCheckBox->setEnabled(NativeSocket::isSupported());
+
     connect(
         m_ui.m_hostLineEdit, SIGNAL(textChanged(const QString&)),
         this, SLOT(hostValueChanged(const QString&)));
@@ -73,6 +76,9 @@ SocketConfigWidget::SocketConfigWidget(
         m_ui.m_broadcastLineEdit, SIGNAL(textChanged(const QString&)),
         this, SLOT(broadcastValueChanged(const QString&)));
 
+    connect(
+        m_ui.m_nativeReceiveCheckBox, SIGNAL(toggled(bool)),
+        this, SLOT(nativeReceiveToggled(bool)));
 }
 
 SocketConfigWidget::~SocketConfigWidget() = default;
@@ -97,6 +103,11 @@ void SocketConfigWidget::broadcastValueChanged(const QString& value)
     m_socket.setBroadcastPropName(value);
 }
 
+void SocketConfigWidget::nativeReceiveToggled(bool checked)
+{
+    m_socket.setNativeReceive(checked);
+}
+
 }  // namespace client
 
 }  // namespace udp_socket
@@ -0,0 +1,119 @@
+//
+// Copyright 2016 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "Plugin.h"
+
+#include <memory>
+#include <cassert>
+
+#include "SocketConfigWidget.h"
+
+namespace comms_champion
+{
+
+namespace plugin
+{
+
+namespace unix_socket
+{
+
+namespace
+{
+
+const QString MainConfigKey("cc_unix_socket");
+const QString PathSubKey("path");
+const QString ModeSubKey("mode");
+const QString TypeSubKey("type");
+
+}  // namespace
+
+Plugin::Plugin()
+{
+    pluginProperties()
+        .setSocketCreateFunc(
+            [this]() -> SocketPtr
+            {
+                createSocketIfNeeded();
+                return m_socket;
+            })
+        .setConfigWidgetCreateFunc(
+            [this]() -> QWidget*
+            {
+                createSocketIfNeeded();
+                return new SocketConfigWidget(*m_socket);
+            });
+}
+
+Plugin::~Plugin() = default;
+
+void Plugin::getCurrentConfigImpl(QVariantMap& config)
+{
+    createSocketIfNeeded();
+
+    QVariantMap subConfig;
+    subConfig.insert(PathSubKey, m_socket->getPath());
+    subConfig.insert(ModeSubKey, static_cast<int>(m_socket->getMode()));
+    subConfig.insert(TypeSubKey, static_cast<int>(m_socket->getType()));
+    config.insert(MainConfigKey, QVariant::fromValue(subConfig));
+}
+
+void Plugin::reconfigureImpl(const QVariantMap& config)
+{
+    auto subConfigVar = config.value(MainConfigKey);
+    if ((!subConfigVar.isValid()) || (!subConfigVar.canConvert<QVariantMap>())) {
+        return;
+    }
+
+    createSocketIfNeeded();
+    assert(m_socket);
+
+    auto subConfig = subConfigVar.value<QVariantMap>();
+    auto pathVar = subConfig.value(PathSubKey);
+    if (pathVar.isValid() && pathVar.canConvert<QString>()) {
+        m_socket->setPath(pathVar.value<QString>());
+    }
+
+    auto modeVar = subConfig.value(ModeSubKey);
+    if (modeVar.isValid() && modeVar.canConvert<int>()) {
+        auto mode = modeVar.value<int>();
+        if ((0 <= mode) && (mode < static_cast<int>(Socket::Mode::NumOfValues))) {
+            m_socket->setMode(static_cast<Socket::Mode>(mode));
+        }
+    }
+
+    auto typeVar = subConfig.value(TypeSubKey);
+    if (typeVar.isValid() && typeVar.canConvert<int>()) {
+        auto type = typeVar.value<int>();
+        if ((0 <= type) && (type < static_cast<int>(Socket::Type::NumOfValues))) {
+            m_socket->setType(static_cast<Socket::Type>(type));
+        }
+    }
+}
+
+void Plugin::createSocketIfNeeded()
+{
+    if (!m_socket) {
+        m_socket.reset(new Socket());
+    }
+}
+
+}  // namespace unix_socket
+
+}  // namespace plugin
+
+}  // namespace comms_champion
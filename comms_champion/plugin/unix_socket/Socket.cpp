@@ -0,0 +1,445 @@
+//
+// Copyright 2016 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "Socket.h"
+
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <initializer_list>
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+
+namespace comms_champion
+{
+
+namespace plugin
+{
+
+namespace unix_socket
+{
+
+namespace
+{
+
+const QString DefaultPath("/tmp/cc_unix_socket");
+const std::size_t ReadBufSize = 64U * 1024U;
+
+// Per connection write backlog, the connection is closed above it
+const std::size_t MaxPendingWriteBytes = 4U * 1024U * 1024U;
+
+QString lastErrorString()
+{
+    return QString::fromLocal8Bit(std::strerror(errno));
+}
+
+bool wouldBlock(int err)
+{
+#if EAGAIN == EWOULDBLOCK
+    return err == EAGAIN;
+#else
+    return (err == EAGAIN) || (err == EWOULDBLOCK);
+#endif
+}
+
+bool fillAddress(const QString& path, struct sockaddr_un& addr)
+{
+    auto pathStr = path.toLocal8Bit();
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (sizeof(addr.sun_path) <= static_cast<std::size_t>(pathStr.size())) {
+        return false;
+    }
+
+    std::memcpy(addr.sun_path, pathStr.constData(), static_cast<std::size_t>(pathStr.size()));
+    return true;
+}
+
+}  // namespace
+
+Socket::Socket()
+  : m_path(DefaultPath)
+{
+}
+
+Socket::~Socket()
+{
+    closeAll();
+}
+
+bool Socket::socketConnectImpl()
+{
+    if ((0 <= m_listenFd) || (!m_connections.empty())) {
+        assert(!"Already connected");
+        static const QString AlreadyConnectedError(
+            tr("Previous run of Unix domain socket wasn't terminated properly."));
+        reportError(AlreadyConnectedError);
+        return false;
+    }
+
+    m_readBuf.resize(ReadBufSize);
+    if (m_mode == Mode::Server) {
+        return listen();
+    }
+
+    return connectToServer();
+}
+
+void Socket::socketDisconnectImpl()
+{
+    closeAll();
+}
+
+void Socket::sendDataImpl(DataInfoPtr dataPtr)
+{
+    assert(dataPtr);
+    if (dataPtr->m_data.empty()) {
+        return;
+    }
+
+    std::vector<int> failedFds;
+    for (auto& elem : m_connections) {
+        auto& info = elem.second;
+        info.m_pendingWrites.push_back(dataPtr);
+        info.m_pendingBytes += dataPtr->m_data.size();
+        if (!flushConnection(elem.first, info)) {
+            failedFds.push_back(elem.first);
+            continue;
+        }
+
+        if (MaxPendingWriteBytes < info.m_pendingBytes) {
+            static const QString OverflowError(
+                tr("Closing Unix domain connection that doesn't read sent data."));
+            reportError(OverflowError);
+            failedFds.push_back(elem.first);
+        }
+    }
+
+    for (auto fd : failedFds) {
+        closeConnection(fd);
+    }
+}
+
+unsigned Socket::connectionPropertiesImpl() const
+{
+    if (m_mode == Mode::Server) {
+        return ConnectionProperty_Autoconnect;
+    }
+
+    return 0U;
+}
+
+std::size_t Socket::pendingBytesImpl() const
+{
+    std::size_t result = 0U;
+    for (auto& elem : m_connections) {
+        result = std::max(result, elem.second.m_pendingBytes);
+    }
+    return result;
+}
+
+void Socket::acceptConnections()
+{
+    while (0 <= m_listenFd) {
+        int fd = ::accept4(m_listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if ((errno == EINTR) || (errno == ECONNABORTED)) {
+                continue;
+            }
+
+            if (!wouldBlock(errno)) {
+                reportError(tr("Failed to accept Unix domain connection: ") + lastErrorString());
+            }
+            break;
+        }
+
+        ++m_lastStreamId;
+        if (m_lastStreamId == DataInfo::DefaultStreamId) {
+            ++m_lastStreamId;
+        }
+
+        addConnection(fd, m_lastStreamId);
+    }
+}
+
+void Socket::readFromConnection(int fd)
+{
+    auto iter = m_connections.find(fd);
+    if (iter == m_connections.end()) {
+        return;
+    }
+
+    auto streamId = iter->second.m_streamId;
+    bool seqPacket = (m_type == Type::SeqPacket);
+    while (true) {
+        struct iovec iov;
+        iov.iov_base = &m_readBuf[0];
+        iov.iov_len = m_readBuf.size();
+
+        struct msghdr msg;
+        std::memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+
+        auto result = ::recvmsg(fd, &msg, MSG_DONTWAIT);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            if (wouldBlock(errno)) {
+                return;
+            }
+
+            if (errno != ECONNRESET) {
+                reportError(tr("Failed to read Unix domain socket: ") + lastErrorString());
+            }
+            break;
+        }
+
+        if (result == 0) {
+            break;
+        }
+
+        if (seqPacket && ((msg.msg_flags & MSG_TRUNC) != 0)) {
+            reportError(tr("Received packet is too long and was truncated."));
+        }
+
+        auto size = static_cast<std::size_t>(result);
+        auto dataPtr = makeDataInfo();
+        dataPtr->m_timestamp = DataInfo::TimestampClock::now();
+        dataPtr->m_streamId = streamId;
+        dataPtr->m_wholeFrame = seqPacket;
+        dataPtr->m_data.assign(m_readBuf.begin(), m_readBuf.begin() + size);
+        reportDataReceived(std::move(dataPtr));
+
+        if (m_connections.find(fd) == m_connections.end()) {
+            // Closed while reporting
+            return;
+        }
+    }
+
+    closeConnection(fd);
+}
+
+void Socket::writeToConnection(int fd)
+{
+    auto iter = m_connections.find(fd);
+    if (iter == m_connections.end()) {
+        return;
+    }
+
+    if (!flushConnection(fd, iter->second)) {
+        closeConnection(fd);
+    }
+}
+
+bool Socket::listen()
+{
+    struct sockaddr_un addr;
+    if (!fillAddress(m_path, addr)) {
+        reportError(tr("Unix domain socket path is too long."));
+        return false;
+    }
+
+    m_listenFd = ::socket(AF_UNIX, socketType() | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (m_listenFd < 0) {
+        reportError(tr("Failed to create Unix domain socket: ") + lastErrorString());
+        return false;
+    }
+
+    ::unlink(addr.sun_path);
+    m_listenPath = m_path;
+    if (::bind(m_listenFd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0) {
+        reportError(tr("Failed to bind Unix domain socket: ") + lastErrorString());
+        closeAll();
+        return false;
+    }
+
+    if (::listen(m_listenFd, SOMAXCONN) != 0) {
+        reportError(tr("Failed to listen on Unix domain socket: ") + lastErrorString());
+        closeAll();
+        return false;
+    }
+
+    m_listenNotifier.reset(new QSocketNotifier(m_listenFd, QSocketNotifier::Read));
+    connect(
+        m_listenNotifier.get(), SIGNAL(activated(int)),
+        this, SLOT(acceptConnections()));
+    return true;
+}
+
+bool Socket::connectToServer()
+{
+    struct sockaddr_un addr;
+    if (!fillAddress(m_path, addr)) {
+        reportError(tr("Unix domain socket path is too long."));
+        return false;
+    }
+
+    int fd = ::socket(AF_UNIX, socketType() | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        reportError(tr("Failed to create Unix domain socket: ") + lastErrorString());
+        return false;
+    }
+
+    // Connection to the local socket doesn't block for long
+    if (::connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0) {
+        reportError(tr("Failed to connect to Unix domain socket: ") + lastErrorString());
+        ::close(fd);
+        return false;
+    }
+
+    auto flags = ::fcntl(fd, F_GETFL, 0);
+    ::fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+    addConnection(fd, DataInfo::DefaultStreamId);
+    return true;
+}
+
+void Socket::addConnection(int fd, DataInfo::StreamId streamId)
+{
+    ConnectionInfo info;
+    info.m_streamId = streamId;
+    info.m_readNotifier.reset(new QSocketNotifier(fd, QSocketNotifier::Read));
+    info.m_writeNotifier.reset(new QSocketNotifier(fd, QSocketNotifier::Write));
+    info.m_writeNotifier->setEnabled(false);
+
+    connect(
+        info.m_readNotifier.get(), SIGNAL(activated(int)),
+        this, SLOT(readFromConnection(int)));
+    connect(
+        info.m_writeNotifier.get(), SIGNAL(activated(int)),
+        this, SLOT(writeToConnection(int)));
+
+    m_connections.insert(std::make_pair(fd, std::move(info)));
+}
+
+void Socket::closeConnection(int fd)
+{
+    auto iter = m_connections.find(fd);
+    if (iter == m_connections.end()) {
+        return;
+    }
+
+    auto streamId = iter->second.m_streamId;
+    for (auto* notifier : {&iter->second.m_readNotifier, &iter->second.m_writeNotifier}) {
+        (*notifier)->setEnabled(false);
+        notifier->release()->deleteLater();
+    }
+
+    m_connections.erase(iter);
+    ::close(fd);
+
+    if (m_mode == Mode::Server) {
+        reportStreamClosed(streamId);
+        return;
+    }
+
+    reportDisconnected();
+}
+
+bool Socket::flushConnection(int fd, ConnectionInfo& info)
+{
+    while (!info.m_pendingWrites.empty()) {
+        auto& data = info.m_pendingWrites.front()->m_data;
+        assert(info.m_pendingOffset < data.size());
+        auto result =
+            ::send(
+                fd,
+                &data[info.m_pendingOffset],
+                data.size() - info.m_pendingOffset,
+                MSG_NOSIGNAL | MSG_DONTWAIT);
+
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            if (wouldBlock(errno)) {
+                break;
+            }
+
+            reportError(tr("Failed to write to Unix domain socket: ") + lastErrorString());
+            return false;
+        }
+
+        auto written = static_cast<std::size_t>(result);
+        assert(written <= info.m_pendingBytes);
+        info.m_pendingBytes -= written;
+        info.m_pendingOffset += written;
+        if (info.m_pendingOffset < data.size()) {
+            continue;
+        }
+
+        info.m_pendingWrites.pop_front();
+        info.m_pendingOffset = 0U;
+    }
+
+    info.m_writeNotifier->setEnabled(!info.m_pendingWrites.empty());
+    return true;
+}
+
+void Socket::closeAll()
+{
+    for (auto& elem : m_connections) {
+        auto& info = elem.second;
+        for (auto* notifier : {&info.m_readNotifier, &info.m_writeNotifier}) {
+            (*notifier)->setEnabled(false);
+            notifier->release()->deleteLater();
+        }
+        ::close(elem.first);
+    }
+    m_connections.clear();
+
+    if (m_listenNotifier) {
+        m_listenNotifier->setEnabled(false);
+        m_listenNotifier.release()->deleteLater();
+    }
+
+    if (0 <= m_listenFd) {
+        ::close(m_listenFd);
+        m_listenFd = -1;
+
+        struct sockaddr_un addr;
+        if (fillAddress(m_listenPath, addr)) {
+            ::unlink(addr.sun_path);
+        }
+        m_listenPath.clear();
+    }
+}
+
+int Socket::socketType() const
+{
+    if (m_type == Type::SeqPacket) {
+        return SOCK_SEQPACKET;
+    }
+
+    return SOCK_STREAM;
+}
+
+}  // namespace unix_socket
+
+}  // namespace plugin
+
+}  // namespace comms_champion
@@ -0,0 +1,150 @@
+//
+// Copyright 2016 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#pragma once
+
+#include <memory>
+#include <deque>
+#include <unordered_map>
+
+#include "comms/CompileControl.h"
+
+CC_DISABLE_WARNINGS()
+#include <QtCore/QObject>
+#include <QtCore/QString>
+#include <QtCore/QSocketNotifier>
+CC_ENABLE_WARNINGS()
+
+#include "comms_champion/Socket.h"
+
+
+namespace comms_champion
+{
+
+namespace plugin
+{
+
+namespace unix_socket
+{
+
+class Socket : public QObject,
+               public comms_champion::Socket
+{
+    Q_OBJECT
+    using Base = comms_champion::Socket;
+
+public:
+    enum class Mode
+    {
+        Client,
+        Server,
+        NumOfValues
+    };
+
+    enum class Type
+    {
+        Stream,
+        SeqPacket,
+        NumOfValues
+    };
+
+    Socket();
+    ~Socket();
+
+    void setPath(const QString& value)
+    {
+        m_path = value;
+    }
+
+    const QString& getPath() const
+    {
+        return m_path;
+    }
+
+    void setMode(Mode value)
+    {
+        m_mode = value;
+    }
+
+    Mode getMode() const
+    {
+        return m_mode;
+    }
+
+    void setType(Type value)
+    {
+        m_type = value;
+    }
+
+    Type getType() const
+    {
+        return m_type;
+    }
+
+protected:
+    virtual bool socketConnectImpl() override;
+    virtual void socketDisconnectImpl() override;
+    virtual void sendDataImpl(DataInfoPtr dataPtr) override;
+    virtual unsigned connectionPropertiesImpl() const override;
+    virtual std::size_t pendingBytesImpl() const override;
+
+private slots:
+    void acceptConnections();
+    void readFromConnection(int fd);
+    void writeToConnection(int fd);
+
+private:
+    typedef std::unique_ptr<QSocketNotifier> NotifierPtr;
+    typedef std::deque<DataInfoPtr> PendingWritesList;
+
+    struct ConnectionInfo
+    {
+        DataInfo::StreamId m_streamId = DataInfo::DefaultStreamId;
+        NotifierPtr m_readNotifier;
+        NotifierPtr m_writeNotifier;
+        PendingWritesList m_pendingWrites;
+        std::size_t m_pendingOffset = 0U;
+        std::size_t m_pendingBytes = 0U;
+    };
+
+    typedef std::unordered_map<int, ConnectionInfo> ConnectionsMap;
+
+    bool listen();
+    bool connectToServer();
+    void addConnection(int fd, DataInfo::StreamId streamId);
+    void closeConnection(int fd);
+    bool flushConnection(int fd, ConnectionInfo& info);
+    void closeAll();
+    int socketType() const;
+
+    QString m_path;
+    QString m_listenPath;
+    Mode m_mode = Mode::Client;
+    Type m_type = Type::Stream;
+    int m_listenFd = -1;
+    NotifierPtr m_listenNotifier;
+    ConnectionsMap m_connections;
+    DataInfo::StreamId m_lastStreamId = DataInfo::DefaultStreamId;
+    DataInfo::DataSeq m_readBuf;
+};
+
+}  // namespace unix_socket
+
+}  // namespace plugin
+
+}  // namespace comms_champion
@@ -0,0 +1,76 @@
+//
+// Copyright 2016 (C). Alex Robenko. All rights reserved.
+//
+
+// This file is free software: you can redistribute it and/or modify
+// it under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU Lesser General Public License for more details.
+//
+// You should have received a copy of the GNU Lesser General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "SocketConfigWidget.h"
+
+namespace comms_champion
+{
+
+namespace plugin
+{
+
+namespace unix_socket
+{
+
+SocketConfigWidget::SocketConfigWidget(
+    Socket& socket,
+    QWidget* parentObj)
+  : Base(parentObj),
+    m_socket(socket)
+{
+    m_ui.setupUi(this);
+
+    m_ui.m_pathLineEdit->setText(m_socket.getPath());
+    m_ui.m_modeComboBox->setCurrentIndex(static_cast<int>(m_socket.getMode()));
+    m_ui.m_typeComboBox->setCurrentIndex(static_cast<int>(m_socket.getType()));
+
+    connect(
+        m_ui.m_pathLineEdit, SIGNAL(textChanged(const QString&)),
+        this, SLOT(pathValueChanged(const QString&)));
+
+    connect(
+        m_ui.m_modeComboBox, SIGNAL(currentIndexChanged(int)),
+        this, SLOT(modeIndexChanged(int)));
+
+    connect(
+        m_ui.m_typeComboBox, SIGNAL(currentIndexChanged(int)),
+        this, SLOT(typeIndexChanged(int)));
+}
+
+SocketConfigWidget::~SocketConfigWidget() = default;
+
+void SocketConfigWidget::pathValueChanged(const QString& value)
+{
+    m_socket.setPath(value);
+}
+
+void SocketConfigWidget::modeIndexChanged(int value)
+{
+    m_socket.setMode(static_cast<Socket::Mode>(value));
+}
+
+void SocketConfigWidget::typeIndexChanged(int value)
+{
+    m_socket.setType(static_cast<Socket::Type>(value));
+}
+
+}  // namespace unix_socket
+
+}  // namespace plugin
+
+}  // namespace comms_champion